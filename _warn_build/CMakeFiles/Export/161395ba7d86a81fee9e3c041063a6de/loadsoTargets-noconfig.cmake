@@ -0,0 +1,19 @@
+#----------------------------------------------------------------
+# Generated CMake target import file.
+#----------------------------------------------------------------
+
+# Commands may need to know the format version.
+set(CMAKE_IMPORT_FILE_VERSION 1)
+
+# Import target "loadso::loadso" for configuration ""
+set_property(TARGET loadso::loadso APPEND PROPERTY IMPORTED_CONFIGURATIONS NOCONFIG)
+set_target_properties(loadso::loadso PROPERTIES
+  IMPORTED_LINK_INTERFACE_LANGUAGES_NOCONFIG "CXX"
+  IMPORTED_LOCATION_NOCONFIG "${_IMPORT_PREFIX}/lib/libloadso.a"
+  )
+
+list(APPEND _cmake_import_check_targets loadso::loadso )
+list(APPEND _cmake_import_check_files_for_loadso::loadso "${_IMPORT_PREFIX}/lib/libloadso.a" )
+
+# Commands beyond this point should not need to know the version.
+set(CMAKE_IMPORT_FILE_VERSION)
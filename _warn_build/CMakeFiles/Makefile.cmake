@@ -0,0 +1,127 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "tests/dll/loadso_plugin_autogen/testdll_dll_functions.h"
+  "/root/repo/benchmarks/CMakeLists.txt"
+  "/root/repo/benchmarks/registry/CMakeLists.txt"
+  "/root/repo/cmake/plugin.cmake"
+  "/root/repo/loadsoConfig.cmake.in"
+  "/root/repo/tests/CMakeLists.txt"
+  "/root/repo/tests/bundle/CMakeLists.txt"
+  "/root/repo/tests/dll/CMakeLists.txt"
+  "/root/repo/tests/exe/CMakeLists.txt"
+  "/root/repo/tests/forkserver/CMakeLists.txt"
+  "/root/repo/tests/loadprofile/CMakeLists.txt"
+  "/root/repo/tests/metadata/CMakeLists.txt"
+  "/root/repo/tests/pluginhost/CMakeLists.txt"
+  "/root/repo/tests/pluginpool/CMakeLists.txt"
+  "/root/repo/tests/plugins/CMakeLists.txt"
+  "/root/repo/tests/plugins/interface.h"
+  "/root/repo/tests/plugins/resources/empty.txt"
+  "/root/repo/tests/plugins/resources/manifest.json"
+  "/root/repo/tests/plugins/resources/schema.json"
+  "/root/repo/tests/registry/CMakeLists.txt"
+  "/root/repo/tests/startup/CMakeLists.txt"
+  "/root/repo/tools/CMakeLists.txt"
+  "/root/repo/tools/analyze/CMakeLists.txt"
+  "/root/repo/tools/audit/CMakeLists.txt"
+  "/root/repo/tools/bundle/CMakeLists.txt"
+  "/root/repo/tools/scan/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/BasicConfigVersion-AnyNewerVersion.cmake.in"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakePackageConfigHelpers.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFile.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/GNUInstallDirs.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  "/usr/share/cmake-3.25/Modules/WriteBasicConfigVersionFile.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "loadsoConfigVersion.cmake"
+  "loadsoConfig.cmake"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/analyze/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/bundle/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/scan/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/audit/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/bundle/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/dll/dll_functions.h"
+  "tests/dll/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/exe/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/forkserver/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/loadprofile/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/metadata/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/plugins/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/pluginhost/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/pluginpool/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/registry/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tests/startup/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "benchmarks/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "benchmarks/registry/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/loadso.dir/DependInfo.cmake"
+  "tools/analyze/CMakeFiles/loadso-analyze.dir/DependInfo.cmake"
+  "tools/bundle/CMakeFiles/loadso-bundle.dir/DependInfo.cmake"
+  "tools/scan/CMakeFiles/loadso-scan.dir/DependInfo.cmake"
+  "tools/audit/CMakeFiles/loadso-audit.dir/DependInfo.cmake"
+  "tests/bundle/CMakeFiles/testbundle.dir/DependInfo.cmake"
+  "tests/dll/CMakeFiles/testdll.dir/DependInfo.cmake"
+  "tests/dll/CMakeFiles/testdllhuge.dir/DependInfo.cmake"
+  "tests/exe/CMakeFiles/testexe.dir/DependInfo.cmake"
+  "tests/forkserver/CMakeFiles/testforkserver.dir/DependInfo.cmake"
+  "tests/loadprofile/CMakeFiles/testloadprofile.dir/DependInfo.cmake"
+  "tests/metadata/CMakeFiles/testmetadata.dir/DependInfo.cmake"
+  "tests/plugins/CMakeFiles/plugin1.dir/DependInfo.cmake"
+  "tests/plugins/CMakeFiles/plugin2.dir/DependInfo.cmake"
+  "tests/plugins/CMakeFiles/loader.dir/DependInfo.cmake"
+  "tests/pluginhost/CMakeFiles/testpluginhost.dir/DependInfo.cmake"
+  "tests/pluginpool/CMakeFiles/testpluginpool.dir/DependInfo.cmake"
+  "tests/registry/CMakeFiles/testregistry.dir/DependInfo.cmake"
+  "tests/startup/CMakeFiles/teststartup.dir/DependInfo.cmake"
+  "benchmarks/registry/CMakeFiles/bench-registry.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,36 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/callprofiler.cpp" "CMakeFiles/loadso.dir/src/callprofiler.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/callprofiler.cpp.o.d"
+  "/root/repo/src/filedigest.cpp" "CMakeFiles/loadso.dir/src/filedigest.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/filedigest.cpp.o.d"
+  "/root/repo/src/forkserver.cpp" "CMakeFiles/loadso.dir/src/forkserver.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/forkserver.cpp.o.d"
+  "/root/repo/src/hugetext.cpp" "CMakeFiles/loadso.dir/src/hugetext.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/hugetext.cpp.o.d"
+  "/root/repo/src/iobatch.cpp" "CMakeFiles/loadso.dir/src/iobatch.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/iobatch.cpp.o.d"
+  "/root/repo/src/library.cpp" "CMakeFiles/loadso.dir/src/library.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/library.cpp.o.d"
+  "/root/repo/src/loadcostanalyzer.cpp" "CMakeFiles/loadso.dir/src/loadcostanalyzer.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/loadcostanalyzer.cpp.o.d"
+  "/root/repo/src/loadprofile.cpp" "CMakeFiles/loadso.dir/src/loadprofile.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/loadprofile.cpp.o.d"
+  "/root/repo/src/metadatareader.cpp" "CMakeFiles/loadso.dir/src/metadatareader.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/metadatareader.cpp.o.d"
+  "/root/repo/src/pluginbundle.cpp" "CMakeFiles/loadso.dir/src/pluginbundle.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/pluginbundle.cpp.o.d"
+  "/root/repo/src/pluginhost.cpp" "CMakeFiles/loadso.dir/src/pluginhost.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/pluginhost.cpp.o.d"
+  "/root/repo/src/pluginindex.cpp" "CMakeFiles/loadso.dir/src/pluginindex.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/pluginindex.cpp.o.d"
+  "/root/repo/src/pluginloader.cpp" "CMakeFiles/loadso.dir/src/pluginloader.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/pluginloader.cpp.o.d"
+  "/root/repo/src/pluginpool.cpp" "CMakeFiles/loadso.dir/src/pluginpool.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/pluginpool.cpp.o.d"
+  "/root/repo/src/pluginregistry.cpp" "CMakeFiles/loadso.dir/src/pluginregistry.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/pluginregistry.cpp.o.d"
+  "/root/repo/src/samplingprofiler.cpp" "CMakeFiles/loadso.dir/src/samplingprofiler.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/samplingprofiler.cpp.o.d"
+  "/root/repo/src/startupscheduler.cpp" "CMakeFiles/loadso.dir/src/startupscheduler.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/startupscheduler.cpp.o.d"
+  "/root/repo/src/system.cpp" "CMakeFiles/loadso.dir/src/system.cpp.o" "gcc" "CMakeFiles/loadso.dir/src/system.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,45 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/loadso.dir/src/callprofiler.cpp.o"
+  "CMakeFiles/loadso.dir/src/callprofiler.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/filedigest.cpp.o"
+  "CMakeFiles/loadso.dir/src/filedigest.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/forkserver.cpp.o"
+  "CMakeFiles/loadso.dir/src/forkserver.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/hugetext.cpp.o"
+  "CMakeFiles/loadso.dir/src/hugetext.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/iobatch.cpp.o"
+  "CMakeFiles/loadso.dir/src/iobatch.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/library.cpp.o"
+  "CMakeFiles/loadso.dir/src/library.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/loadcostanalyzer.cpp.o"
+  "CMakeFiles/loadso.dir/src/loadcostanalyzer.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/loadprofile.cpp.o"
+  "CMakeFiles/loadso.dir/src/loadprofile.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/metadatareader.cpp.o"
+  "CMakeFiles/loadso.dir/src/metadatareader.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/pluginbundle.cpp.o"
+  "CMakeFiles/loadso.dir/src/pluginbundle.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/pluginhost.cpp.o"
+  "CMakeFiles/loadso.dir/src/pluginhost.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/pluginindex.cpp.o"
+  "CMakeFiles/loadso.dir/src/pluginindex.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/pluginloader.cpp.o"
+  "CMakeFiles/loadso.dir/src/pluginloader.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/pluginpool.cpp.o"
+  "CMakeFiles/loadso.dir/src/pluginpool.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/pluginregistry.cpp.o"
+  "CMakeFiles/loadso.dir/src/pluginregistry.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/samplingprofiler.cpp.o"
+  "CMakeFiles/loadso.dir/src/samplingprofiler.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/startupscheduler.cpp.o"
+  "CMakeFiles/loadso.dir/src/startupscheduler.cpp.o.d"
+  "CMakeFiles/loadso.dir/src/system.cpp.o"
+  "CMakeFiles/loadso.dir/src/system.cpp.o.d"
+  "lib/libloadso.a"
+  "lib/libloadso.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loadso.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/bench-registry"
+  "../../bin/bench-registry.pdb"
+  "CMakeFiles/bench-registry.dir/main.cpp.o"
+  "CMakeFiles/bench-registry.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench-registry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
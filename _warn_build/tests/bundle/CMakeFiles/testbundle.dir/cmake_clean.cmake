@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testbundle"
+  "../../bin/testbundle.pdb"
+  "CMakeFiles/testbundle.dir/main.cpp.o"
+  "CMakeFiles/testbundle.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testbundle.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tests/dll/dll.cpp" "tests/dll/CMakeFiles/testdll.dir/dll.cpp.o" "gcc" "tests/dll/CMakeFiles/testdll.dir/dll.cpp.o.d"
+  "/root/repo/_warn_build/tests/dll/loadso_plugin_autogen/testdll_dll_functions.cpp" "tests/dll/CMakeFiles/testdll.dir/loadso_plugin_autogen/testdll_dll_functions.cpp.o" "gcc" "tests/dll/CMakeFiles/testdll.dir/loadso_plugin_autogen/testdll_dll_functions.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../lib/libtestdll.pdb"
+  "../../lib/libtestdll.so"
+  "CMakeFiles/testdll.dir/dll.cpp.o"
+  "CMakeFiles/testdll.dir/dll.cpp.o.d"
+  "CMakeFiles/testdll.dir/loadso_plugin_autogen/testdll_dll_functions.cpp.o"
+  "CMakeFiles/testdll.dir/loadso_plugin_autogen/testdll_dll_functions.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testdll.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
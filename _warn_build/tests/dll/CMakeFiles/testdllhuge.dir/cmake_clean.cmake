@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../lib/libtestdllhuge.pdb"
+  "../../lib/libtestdllhuge.so"
+  "CMakeFiles/testdllhuge.dir/dll.cpp.o"
+  "CMakeFiles/testdllhuge.dir/dll.cpp.o.d"
+  "CMakeFiles/testdllhuge.dir/padding.cpp.o"
+  "CMakeFiles/testdllhuge.dir/padding.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testdllhuge.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,27 @@
+// LoadSO Function Table
+
+#include "/root/repo/tests/dll/dll.h"
+
+struct loadso_function_table_dll {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int count;
+    unsigned int reserved;
+    unsigned long long hash;
+    void *functions[3];
+};
+
+extern "C" __attribute__((visibility("default"))) const loadso_function_table_dll loadso_functions_dll;
+
+const loadso_function_table_dll loadso_functions_dll = {
+    0x5446534C,
+    1,
+    3,
+    0,
+    0xe050e755400d6337ULL,
+    {
+        (void *) &add,
+        (void *) &scale,
+        (void *) &burn,
+    },
+};
@@ -0,0 +1,14 @@
+#ifndef LOADSO_FUNCTIONS_DLL_H
+#define LOADSO_FUNCTIONS_DLL_H
+
+#define LOADSO_FUNCTIONS_DLL_VERSION 1
+#define LOADSO_FUNCTIONS_DLL_COUNT 3
+#define LOADSO_FUNCTIONS_DLL_HASH 0xe050e755400d6337ULL
+
+enum {
+    LOADSO_FUNCTIONS_DLL_add,
+    LOADSO_FUNCTIONS_DLL_scale,
+    LOADSO_FUNCTIONS_DLL_burn,
+};
+
+#endif // LOADSO_FUNCTIONS_DLL_H
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testexe"
+  "../../bin/testexe.pdb"
+  "CMakeFiles/testexe.dir/main.cpp.o"
+  "CMakeFiles/testexe.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testexe.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
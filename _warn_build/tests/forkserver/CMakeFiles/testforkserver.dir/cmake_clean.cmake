@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testforkserver"
+  "../../bin/testforkserver.pdb"
+  "CMakeFiles/testforkserver.dir/main.cpp.o"
+  "CMakeFiles/testforkserver.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testforkserver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
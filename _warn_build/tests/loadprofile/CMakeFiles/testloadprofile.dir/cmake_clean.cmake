@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testloadprofile"
+  "../../bin/testloadprofile.pdb"
+  "CMakeFiles/testloadprofile.dir/main.cpp.o"
+  "CMakeFiles/testloadprofile.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testloadprofile.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
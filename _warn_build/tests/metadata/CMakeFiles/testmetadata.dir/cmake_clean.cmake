@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testmetadata"
+  "../../bin/testmetadata.pdb"
+  "CMakeFiles/testmetadata.dir/main.cpp.o"
+  "CMakeFiles/testmetadata.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testmetadata.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
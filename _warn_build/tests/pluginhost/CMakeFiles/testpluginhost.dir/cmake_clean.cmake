@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testpluginhost"
+  "../../bin/testpluginhost.pdb"
+  "CMakeFiles/testpluginhost.dir/main.cpp.o"
+  "CMakeFiles/testpluginhost.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testpluginhost.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
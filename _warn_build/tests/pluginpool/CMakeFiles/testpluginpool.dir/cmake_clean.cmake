@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testpluginpool"
+  "../../bin/testpluginpool.pdb"
+  "CMakeFiles/testpluginpool.dir/main.cpp.o"
+  "CMakeFiles/testpluginpool.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testpluginpool.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/loader"
+  "../../bin/loader.pdb"
+  "CMakeFiles/loader.dir/loader.cpp.o"
+  "CMakeFiles/loader.dir/loader.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/_warn_build/tests/plugins/loadso_plugin_autogen/plugin1_plugin_export.cpp" "tests/plugins/CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_export.cpp.o" "gcc" "tests/plugins/CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_export.cpp.o.d"
+  "/root/repo/_warn_build/tests/plugins/loadso_plugin_autogen/plugin1_plugin_resource.cpp" "tests/plugins/CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_resource.cpp.o" "gcc" "tests/plugins/CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_resource.cpp.o.d"
+  "/root/repo/tests/plugins/plugin1.cpp" "tests/plugins/CMakeFiles/plugin1.dir/plugin1.cpp.o" "gcc" "tests/plugins/CMakeFiles/plugin1.dir/plugin1.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../../lib/libplugin1.pdb"
+  "../../lib/libplugin1.so"
+  "CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_export.cpp.o"
+  "CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_export.cpp.o.d"
+  "CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_resource.cpp.o"
+  "CMakeFiles/plugin1.dir/loadso_plugin_autogen/plugin1_plugin_resource.cpp.o.d"
+  "CMakeFiles/plugin1.dir/plugin1.cpp.o"
+  "CMakeFiles/plugin1.dir/plugin1.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/plugin1.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
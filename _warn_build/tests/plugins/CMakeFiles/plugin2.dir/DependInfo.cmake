@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/_warn_build/tests/plugins/loadso_plugin_autogen/plugin2_plugin_resource.cpp" "tests/plugins/CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resource.cpp.o" "gcc" "tests/plugins/CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resource.cpp.o.d"
+  "/root/repo/_warn_build/tests/plugins/loadso_plugin_autogen/plugin2_plugin_resources.cpp" "tests/plugins/CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resources.cpp.o" "gcc" "tests/plugins/CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resources.cpp.o.d"
+  "/root/repo/tests/plugins/plugin2.cpp" "tests/plugins/CMakeFiles/plugin2.dir/plugin2.cpp.o" "gcc" "tests/plugins/CMakeFiles/plugin2.dir/plugin2.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../../lib/libplugin2.pdb"
+  "../../lib/libplugin2.so"
+  "CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resource.cpp.o"
+  "CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resource.cpp.o.d"
+  "CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resources.cpp.o"
+  "CMakeFiles/plugin2.dir/loadso_plugin_autogen/plugin2_plugin_resources.cpp.o.d"
+  "CMakeFiles/plugin2.dir/plugin2.cpp.o"
+  "CMakeFiles/plugin2.dir/plugin2.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/plugin2.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+#include <cstddef>
+
+__attribute__((section(".loadso_metadata"))) __attribute__((used))
+static constexpr unsigned char loadso_plugin_metadata_data[] = {
+  0x70, 0x6c, 0x75, 0x67, 0x69, 0x6e, 0x31, 0x2e, 0x74, 0x78, 0x74
+};
+
+extern "C" __attribute__((visibility("default"))) const unsigned char *loadso_plugin_metadata(size_t *size) {
+    *size = sizeof(loadso_plugin_metadata_data);
+    return loadso_plugin_metadata_data;
+}
@@ -0,0 +1,26 @@
+// LoadSO Plugin Source File
+
+
+__attribute__((section(".loadso_abi"))) __attribute__((used))
+static constexpr char loadso_plugin_abi[] = "LoadSO.Interface/a4fc91f9d819c776";
+
+__attribute__((section(".loadso_flags"))) __attribute__((used))
+static constexpr char loadso_plugin_flags_data[] = "cleanup";
+
+#include <cstddef>
+
+extern "C" __attribute__((visibility("default"))) const char *loadso_plugin_flags(size_t *size) {
+    *size = sizeof(loadso_plugin_flags_data);
+    return loadso_plugin_flags_data;
+}
+
+extern "C" __attribute__((visibility("default"))) LoadSO::Plugin *loadso_plugin_instance() {                        
+    static LoadSO::Plugin _instance;
+    return &_instance;
+}
+
+#include <atomic>
+
+extern "C" __attribute__((visibility("default"))) bool loadso_plugin_warmup(void *instance, const std::atomic<bool> *cancelled) {
+    return static_cast<LoadSO::Plugin *>(instance)->warmUp(*cancelled);
+}
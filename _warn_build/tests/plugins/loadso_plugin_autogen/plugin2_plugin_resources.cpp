@@ -0,0 +1,47 @@
+#include <cstddef>
+
+struct loadso_plugin_resources_table {
+    unsigned char index[88];
+    char names[28];
+    unsigned char padding0[12];
+    unsigned char data0[45];
+    unsigned char padding1[3];
+    unsigned char data1[163];
+    unsigned char padding2[13];
+};
+
+__attribute__((section(".loadso_resources"))) __attribute__((used)) __attribute__((aligned(16)))
+static constexpr loadso_plugin_resources_table loadso_plugin_resources_data = {
+    {0x4c, 0x53, 0x52, 0x43, 0x1, 0x0, 0x0, 0x0, 0x3, 0x0, 0x0, 0x0, 0x1c, 0x0, 0x0, 0x0, 0x58, 0x0, 0x0, 0x0, 0x8, 0x0, 0x0, 0x0, 0x80, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x2d, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x61, 0x0, 0x0, 0x0, 0xb, 0x0, 0x0, 0x0, 0xb0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0xa3, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x6d, 0x0, 0x0, 0x0, 0x5, 0x0, 0x0, 0x0, 0x60, 0x1, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, },
+    "manifest" "\0" "schema.json" "\0" "empty" "\0" ,
+    {},
+    {
+  0x7b, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x20, 0x22, 0x70, 0x6c,
+  0x75, 0x67, 0x69, 0x6e, 0x32, 0x22, 0x2c, 0x20, 0x22, 0x70, 0x65, 0x72,
+  0x6d, 0x69, 0x73, 0x73, 0x69, 0x6f, 0x6e, 0x73, 0x22, 0x3a, 0x20, 0x5b,
+  0x22, 0x72, 0x65, 0x61, 0x64, 0x22, 0x5d, 0x7d, 0x0a
+    },
+    {},
+    {
+  0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x22, 0x74, 0x79, 0x70, 0x65, 0x22,
+  0x3a, 0x20, 0x22, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x22, 0x2c, 0x0a,
+  0x20, 0x20, 0x20, 0x20, 0x22, 0x70, 0x72, 0x6f, 0x70, 0x65, 0x72, 0x74,
+  0x69, 0x65, 0x73, 0x22, 0x3a, 0x20, 0x7b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x22, 0x6b, 0x65, 0x79, 0x22, 0x3a, 0x20, 0x7b,
+  0x20, 0x22, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x22, 0x73, 0x74,
+  0x72, 0x69, 0x6e, 0x67, 0x22, 0x20, 0x7d, 0x2c, 0x0a, 0x20, 0x20, 0x20,
+  0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x70, 0x65, 0x72, 0x6d, 0x69, 0x73,
+  0x73, 0x69, 0x6f, 0x6e, 0x73, 0x22, 0x3a, 0x20, 0x7b, 0x20, 0x22, 0x74,
+  0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x22, 0x61, 0x72, 0x72, 0x61, 0x79,
+  0x22, 0x2c, 0x20, 0x22, 0x69, 0x74, 0x65, 0x6d, 0x73, 0x22, 0x3a, 0x20,
+  0x7b, 0x20, 0x22, 0x74, 0x79, 0x70, 0x65, 0x22, 0x3a, 0x20, 0x22, 0x73,
+  0x74, 0x72, 0x69, 0x6e, 0x67, 0x22, 0x20, 0x7d, 0x20, 0x7d, 0x0a, 0x20,
+  0x20, 0x20, 0x20, 0x7d, 0x0a, 0x7d, 0x0a
+    },
+    {},
+};
+
+extern "C" __attribute__((visibility("default"))) const unsigned char *loadso_plugin_resources(size_t *size) {
+    *size = sizeof(loadso_plugin_resources_data);
+    return reinterpret_cast<const unsigned char *>(&loadso_plugin_resources_data);
+}
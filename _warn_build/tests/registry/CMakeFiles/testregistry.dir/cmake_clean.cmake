@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/testregistry"
+  "../../bin/testregistry.pdb"
+  "CMakeFiles/testregistry.dir/main.cpp.o"
+  "CMakeFiles/testregistry.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/testregistry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
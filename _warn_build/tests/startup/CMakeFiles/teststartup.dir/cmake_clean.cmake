@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/teststartup"
+  "../../bin/teststartup.pdb"
+  "CMakeFiles/teststartup.dir/main.cpp.o"
+  "CMakeFiles/teststartup.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/teststartup.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/loadso-analyze"
+  "../../bin/loadso-analyze.pdb"
+  "CMakeFiles/loadso-analyze.dir/main.cpp.o"
+  "CMakeFiles/loadso-analyze.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loadso-analyze.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../lib/loadso-audit.pdb"
+  "../../lib/loadso-audit.so"
+  "CMakeFiles/loadso-audit.dir/audit.cpp.o"
+  "CMakeFiles/loadso-audit.dir/audit.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loadso-audit.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/loadso-bundle"
+  "../../bin/loadso-bundle.pdb"
+  "CMakeFiles/loadso-bundle.dir/main.cpp.o"
+  "CMakeFiles/loadso-bundle.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loadso-bundle.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../bin/loadso-scan"
+  "../../bin/loadso-scan.pdb"
+  "CMakeFiles/loadso-scan.dir/main.cpp.o"
+  "CMakeFiles/loadso-scan.dir/main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/loadso-scan.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <loadso/pluginregistry.h>
+
+using namespace LoadSO;
+
+// Baseline: the map every application writes by hand
+class SharedMutexRegistry {
+public:
+    bool add(const std::string &key, PluginLoader *plugin) {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        return _map.emplace(key, plugin).second;
+    }
+
+    PluginLoader *remove(const std::string &key) {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        auto it = _map.find(key);
+        if (it == _map.end()) {
+            return nullptr;
+        }
+        auto plugin = it->second;
+        _map.erase(it);
+        return plugin;
+    }
+
+    void *instance(const std::string &key) const {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto it = _map.find(key);
+        return it == _map.end() ? nullptr : it->second->instance();
+    }
+
+private:
+    mutable std::shared_mutex _mutex;
+    std::unordered_map<std::string, PluginLoader *> _map;
+};
+
+struct Options {
+    int maxThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+    int keys = 32;
+    double seconds = 0.5;
+    bool writer = false;
+};
+
+template <class Registry, class Lookup>
+static double run(Registry &registry, const std::vector<std::string> &keys, int threads,
+                  const Options &options, Lookup lookup) {
+    std::atomic<bool> start(false), stop(false);
+    std::atomic<long long> total(0);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            long long count = 0;
+            size_t i = size_t(t);
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int n = 0; n < 256; ++n) {
+                    lookup(registry, keys[i++ % keys.size()]);
+                }
+                count += 256;
+            }
+            total += count;
+        });
+    }
+
+    // Optional writer churning one key
+    PluginLoader churn;
+    std::thread writer;
+    if (options.writer) {
+        writer = std::thread([&]() {
+            while (!stop) {
+                registry.add("churn", &churn);
+                registry.remove("churn");
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    start = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop = true;
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (writer.joinable()) {
+        writer.join();
+    }
+    return double(total) / options.seconds;
+}
+
+static void usage() {
+    printf("Usage: bench-registry [-t <max threads>] [-k <keys>] [-s <seconds>] [--writer]\n");
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            options.maxThreads = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+            options.keys = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            options.seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--writer")) {
+            options.writer = true;
+        } else {
+            usage();
+            return strcmp(argv[i], "-h") && strcmp(argv[i], "--help") ? 1 : 0;
+        }
+    }
+
+    std::vector<PluginLoader> plugins(options.keys);
+    std::vector<std::string> keys;
+    PluginRegistry registry;
+    SharedMutexRegistry baseline;
+    for (int i = 0; i < options.keys; ++i) {
+        keys.push_back("org.loadso.plugin" + std::to_string(i));
+        registry.add(keys.back(), &plugins[i]);
+        baseline.add(keys.back(), &plugins[i]);
+    }
+
+    printf("%8s %18s %18s %8s\n", "threads", "registry (op/s)", "shared_mutex (op/s)", "ratio");
+    for (int threads = 1;; threads = std::min(threads * 2, options.maxThreads)) {
+        const double a = run(registry, keys, threads, options,
+                             [](const PluginRegistry &r, const std::string &key) {
+                                 PluginRegistry::ReadLock lock(r);
+                                 return lock.instance(key);
+                             });
+        const double b = run(baseline, keys, threads, options,
+                             [](const SharedMutexRegistry &r, const std::string &key) {
+                                 return r.instance(key);
+                             });
+        printf("%8d %18.0f %18.0f %8.2f\n", threads, a, b, b > 0 ? a / b : 0);
+        if (threads == options.maxThreads) {
+            break;
+        }
+    }
+    return 0;
+}
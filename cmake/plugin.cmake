@@ -2,17 +2,287 @@ if(NOT DEFINED LOADSO_PLUGIN_SECTION_NAME)
     set(LOADSO_PLUGIN_SECTION_NAME "loadso_metadata")
 endif()
 
+if(NOT DEFINED LOADSO_PLUGIN_ABI_SECTION_NAME)
+    set(LOADSO_PLUGIN_ABI_SECTION_NAME "loadso_abi")
+endif()
+
+if(NOT DEFINED LOADSO_PLUGIN_FLAGS_SECTION_NAME)
+    set(LOADSO_PLUGIN_FLAGS_SECTION_NAME "loadso_flags")
+endif()
+
+if(NOT DEFINED LOADSO_PLUGIN_RESOURCES_SECTION_NAME)
+    set(LOADSO_PLUGIN_RESOURCES_SECTION_NAME "loadso_resources")
+endif()
+
+#[[
+
+    Computes the ABI identifier of a plugin interface, "<name>/<hash>", where the hash covers
+    the version string and the content of the headers.
+
+    loadso_interface_id(<output variable> <interface name>
+        [VERSION <version>]
+        [HEADERS <files>...]
+    )
+
+]]#
+function(loadso_interface_id _out _name)
+    set(options)
+    set(oneValueArgs VERSION)
+    set(multiValueArgs HEADERS)
+    cmake_parse_arguments(FUNC "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+    set(_content "${_name}\n${FUNC_VERSION}\n")
+
+    foreach(_file ${FUNC_HEADERS})
+        get_filename_component(_file ${_file} ABSOLUTE)
+        file(READ ${_file} _file_content)
+        string(REPLACE "\r\n" "\n" _file_content "${_file_content}")
+        string(APPEND _content "${_file_content}")
+
+        # Reconfigure when the interface changes
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${_file})
+    endforeach()
+
+    string(SHA256 _hash "${_content}")
+    string(SUBSTRING ${_hash} 0 16 _hash)
+    set(${_out} "${_name}/${_hash}" PARENT_SCOPE)
+endfunction()
+
+# Embeds a string as a named resource, appending to _metadata_content of the caller
+macro(_loadso_embed_string _section _symbol _value)
+    if(WIN32)
+        set(_embed_rc ${_cache_dir}/${_name}_${_symbol}.rc)
+        file(WRITE ${_embed_rc} "${_section} RCDATA { \"${_value}\" }")
+        target_sources(${_target} PRIVATE ${_embed_rc})
+    else()
+        if(APPLE)
+            set(_embed_attribute "__attribute__((section(\"__TEXT,${_section}\"))) __attribute__((used))")
+        else()
+            set(_embed_attribute "__attribute__((section(\".${_section}\"))) __attribute__((used))")
+        endif()
+
+        string(APPEND _metadata_content "
+${_embed_attribute}
+static constexpr char ${_symbol}[] = \"${_value}\"\;
+")
+    endif()
+endmacro()
+
+# Formats an integer as little endian byte literals
+function(_loadso_le_bytes _out _value _width)
+    set(_bytes)
+
+    foreach(_i RANGE 1 ${_width})
+        math(EXPR _byte "${_value} & 255" OUTPUT_FORMAT HEXADECIMAL)
+        math(EXPR _value "${_value} >> 8")
+        string(APPEND _bytes "${_byte}, ")
+    endforeach()
+
+    set(${_out} "${_bytes}" PARENT_SCOPE)
+endfunction()
+
+# Embeds the resource table, appending to _metadata_content of the caller
+macro(_loadso_embed_resources)
+    list(LENGTH FUNC_RESOURCES _resource_args)
+    math(EXPR _resource_odd "${_resource_args} % 2")
+
+    if(_resource_odd)
+        message(FATAL_ERROR "loadso_export_plugin: RESOURCES takes pairs of name and file")
+    endif()
+
+    math(EXPR _resource_count "${_resource_args} / 2")
+    math(EXPR _resource_last "${_resource_count} - 1")
+    set(_resource_names)
+    set(_resource_files)
+
+    foreach(_i RANGE ${_resource_last})
+        math(EXPR _j "${_i} * 2")
+        list(GET FUNC_RESOURCES ${_j} _resource_name)
+        math(EXPR _j "${_j} + 1")
+        list(GET FUNC_RESOURCES ${_j} _resource_file)
+
+        if(NOT _resource_name MATCHES "^[A-Za-z0-9_./-]+$")
+            message(FATAL_ERROR "loadso_export_plugin: invalid resource name \"${_resource_name}\"")
+        endif()
+
+        if(_resource_name IN_LIST _resource_names)
+            message(FATAL_ERROR "loadso_export_plugin: duplicate resource \"${_resource_name}\"")
+        endif()
+
+        get_filename_component(_resource_file ${_resource_file} ABSOLUTE)
+        list(APPEND _resource_names ${_resource_name})
+        list(APPEND _resource_files ${_resource_file})
+
+        # Regenerate when a resource changes
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${_resource_file})
+    endforeach()
+
+    if(WIN32)
+        # An RCDATA listing the names, and one RCDATA per resource
+        string(REPLACE ";" "|" _resource_index "${_resource_names}")
+        set(_resource_rc_content "LOADSO_RESOURCES RCDATA { \"${_resource_index}\" }\n")
+
+        foreach(_i RANGE ${_resource_last})
+            list(GET _resource_files ${_i} _resource_file)
+            string(APPEND _resource_rc_content "LOADSO_RESOURCE_${_i} RCDATA \"${_resource_file}\"\n")
+        endforeach()
+
+        set(_resources_rc ${_cache_dir}/${_name}_plugin_resources.rc)
+        file(WRITE ${_resources_rc} ${_resource_rc_content})
+        target_sources(${_target} PRIVATE ${_resources_rc})
+    else()
+        if(APPLE)
+            set(_resources_attribute "__attribute__((section(\"__TEXT,${LOADSO_PLUGIN_RESOURCES_SECTION_NAME}\"))) __attribute__((used))")
+        else()
+            set(_resources_attribute "__attribute__((section(\".${LOADSO_PLUGIN_RESOURCES_SECTION_NAME}\"))) __attribute__((used))")
+        endif()
+
+        find_program(_xxd_command xxd)
+
+        if(NOT _xxd_command)
+            message(FATAL_ERROR "Command \"xxd\" not found")
+        endif()
+
+        # Layout read by MetadataReader::ReadResource(), offsets are from the table start:
+        #   header  { u32 magic, u32 version, u32 count, u32 names size }
+        #   entries { u32 name offset, u32 name size, u64 data offset, u64 data size }...
+        #   names, each terminated by 0
+        #   data, each aligned to 16 bytes
+        math(EXPR _names_start "16 + ${_resource_count} * 24")
+        set(_names_size 1)
+        set(_names_literal)
+
+        foreach(_resource_name ${_resource_names})
+            string(LENGTH ${_resource_name} _length)
+            math(EXPR _names_size "${_names_size} + ${_length} + 1")
+            string(APPEND _names_literal "\"${_resource_name}\" \"\\0\" ")
+        endforeach()
+
+        math(EXPR _offset "${_names_start} + ${_names_size}")
+        _loadso_le_bytes(_table_bytes 0x4352534C 4)
+        _loadso_le_bytes(_bytes 1 4)
+        string(APPEND _table_bytes ${_bytes})
+        _loadso_le_bytes(_bytes ${_resource_count} 4)
+        string(APPEND _table_bytes ${_bytes})
+        _loadso_le_bytes(_bytes ${_names_size} 4)
+        string(APPEND _table_bytes ${_bytes})
+
+        set(_fields "    unsigned char index[${_names_start}];\n    char names[${_names_size}];\n")
+        set(_name_offset ${_names_start})
+        set(_paddings)
+        set(_sizes)
+
+        foreach(_i RANGE ${_resource_last})
+            list(GET _resource_names ${_i} _resource_name)
+            list(GET _resource_files ${_i} _resource_file)
+            file(SIZE ${_resource_file} _size)
+            string(LENGTH ${_resource_name} _length)
+
+            math(EXPR _padding "(16 - ${_offset} % 16) % 16")
+            math(EXPR _offset "${_offset} + ${_padding}")
+
+            _loadso_le_bytes(_bytes ${_name_offset} 4)
+            string(APPEND _table_bytes ${_bytes})
+            _loadso_le_bytes(_bytes ${_length} 4)
+            string(APPEND _table_bytes ${_bytes})
+            _loadso_le_bytes(_bytes ${_offset} 8)
+            string(APPEND _table_bytes ${_bytes})
+            _loadso_le_bytes(_bytes ${_size} 8)
+            string(APPEND _table_bytes ${_bytes})
+
+            if(_padding GREATER 0)
+                string(APPEND _fields "    unsigned char padding${_i}[${_padding}];\n")
+            endif()
+
+            if(_size GREATER 0)
+                string(APPEND _fields "    unsigned char data${_i}[${_size}];\n")
+            endif()
+
+            list(APPEND _paddings ${_padding})
+            list(APPEND _sizes ${_size})
+            math(EXPR _name_offset "${_name_offset} + ${_length} + 1")
+            math(EXPR _offset "${_offset} + ${_size}")
+        endforeach()
+
+        set(_resources_cpp ${_cache_dir}/${_name}_plugin_resources.cpp)
+        file(WRITE ${_resources_cpp} "#include <cstddef>
+
+struct loadso_plugin_resources_table {
+${_fields}};
+
+${_resources_attribute} __attribute__((aligned(16)))
+static constexpr loadso_plugin_resources_table loadso_plugin_resources_data = {
+    {${_table_bytes}},
+    ${_names_literal},
+")
+
+        foreach(_i RANGE ${_resource_last})
+            list(GET _paddings ${_i} _padding)
+            list(GET _sizes ${_i} _size)
+            list(GET _resource_files ${_i} _resource_file)
+
+            if(_padding GREATER 0)
+                file(APPEND ${_resources_cpp} "    {},\n")
+            endif()
+
+            if(_size GREATER 0)
+                file(APPEND ${_resources_cpp} "    {\n")
+                execute_process(
+                    COMMAND bash -c "${_xxd_command} -i < ${_resource_file} >> ${_resources_cpp}" # APPEND
+                    COMMAND_ERROR_IS_FATAL ANY
+                    WORKING_DIRECTORY ${_cache_dir}
+                )
+                file(APPEND ${_resources_cpp} "    },\n")
+            endif()
+        endforeach()
+
+        file(APPEND ${_resources_cpp} "};
+
+extern \"C\" __attribute__((visibility(\"default\"))) const unsigned char *loadso_plugin_resources(size_t *size) {
+    *size = sizeof(loadso_plugin_resources_data);
+    return reinterpret_cast<const unsigned char *>(&loadso_plugin_resources_data);
+}
+")
+
+        target_sources(${_target} PRIVATE ${_resources_cpp})
+    endif()
+endmacro()
+
 #[[
 
     loadso_export_plugin(<target> <header/source file> <class name>
         [METADATA_FILE <file>]
+        [RESOURCES <name> <file> [<name> <file>...] ]
+        [INTERFACE <name>]
+        [INTERFACE_VERSION <version>]
+        [INTERFACE_HEADERS <files>...]
+        [CLEANUP_REQUIRED]
+        [PRIORITY <critical|normal|background>]
+        [WARMUP <member function>]
     )
 
+    RESOURCES embeds named files with an index, so that PluginLoader::resource() and
+    MetadataReader::ReadFileResource() fetch one of them without reading the others. Names may
+    contain letters, digits and "_./-".
+
+    INTERFACE embeds an ABI descriptor computed by loadso_interface_id(), which PluginLoader
+    checks against PluginLoader::setRequiredInterface() before loading the library.
+
+    CLEANUP_REQUIRED marks a plugin that must be unloaded properly even in fast exit mode, see
+    Library::SetFastExit().
+
+    PRIORITY tags the startup tier of the plugin, see StartupScheduler. Untagged plugins are normal.
+
+    WARMUP names a member function of the plugin class, declared as
+        bool <member function>(const std::atomic<bool> &cancelled);
+    which PluginLoader::warmUp() runs on a background thread after construction. It should return
+    soon after cancelled becomes true, and returns false if the warm-up failed.
+
 ]]#
 function(loadso_export_plugin _target _header _class_name)
-    set(options)
-    set(oneValueArgs)
-    set(multiValueArgs METADATA_FILE)
+    set(options CLEANUP_REQUIRED)
+    set(oneValueArgs INTERFACE INTERFACE_VERSION PRIORITY WARMUP)
+    set(multiValueArgs METADATA_FILE RESOURCES INTERFACE_HEADERS)
     cmake_parse_arguments(FUNC "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
 
     set(_name ${_target})
@@ -49,39 +319,79 @@ function(loadso_export_plugin _target _header _class_name)
                 message(FATAL_ERROR "Command \"xxd\" not found")
             endif()
 
-            find_program(_sed_command sed)
-
-            if(NOT _sed_command)
-                message(FATAL_ERROR "Command \"sed\" not found")
-            endif()
-
-            # Write binary data header
+            # Write binary data, with an accessor to read it from the loaded image
             set(_resource_cpp ${_cache_dir}/${_name}_plugin_resource.cpp)
-            file(WRITE ${_resource_cpp} "${_section_attribute}\n")
+            file(WRITE ${_resource_cpp} "#include <cstddef>
+
+${_section_attribute}
+static constexpr unsigned char loadso_plugin_metadata_data[] = {
+")
             execute_process(
-                COMMAND bash -c "${_xxd_command} -i ${_metadata_file} >> ${_resource_cpp}" # APPEND
+                COMMAND bash -c "${_xxd_command} -i < ${_metadata_file} >> ${_resource_cpp}" # APPEND
                 COMMAND_ERROR_IS_FATAL ANY
                 WORKING_DIRECTORY ${_cache_dir}
             )
+            file(APPEND ${_resource_cpp} "};
 
-            if(APPLE)
-                execute_process(
-                    COMMAND ${_sed_command} -i "" "s/unsigned/static constexpr unsigned/" ${_resource_cpp}
-                    COMMAND_ERROR_IS_FATAL ANY
-                    WORKING_DIRECTORY ${_cache_dir}
-                )
-            else()
-                execute_process(
-                    COMMAND ${_sed_command} -i "s/unsigned/static constexpr unsigned/" ${_resource_cpp}
-                    COMMAND_ERROR_IS_FATAL ANY
-                    WORKING_DIRECTORY ${_cache_dir}
-                )
-            endif()
+extern \"C\" ${_export_attribute} const unsigned char *loadso_plugin_metadata(size_t *size) {
+    *size = sizeof(loadso_plugin_metadata_data);
+    return loadso_plugin_metadata_data;
+}
+")
 
             target_sources(${_target} PRIVATE ${_resource_cpp})
         endif()
     endif()
 
+    if(FUNC_RESOURCES)
+        _loadso_embed_resources()
+    endif()
+
+    if(FUNC_INTERFACE)
+        loadso_interface_id(_interface_id ${FUNC_INTERFACE}
+            VERSION "${FUNC_INTERFACE_VERSION}"
+            HEADERS ${FUNC_INTERFACE_HEADERS}
+        )
+
+        _loadso_embed_string(${LOADSO_PLUGIN_ABI_SECTION_NAME} loadso_plugin_abi ${_interface_id})
+    endif()
+
+    set(_flags)
+
+    if(FUNC_CLEANUP_REQUIRED)
+        list(APPEND _flags "cleanup")
+    endif()
+
+    if(FUNC_PRIORITY)
+        if(NOT FUNC_PRIORITY MATCHES "^(critical|normal|background)$")
+            message(FATAL_ERROR "loadso_export_plugin: invalid PRIORITY \"${FUNC_PRIORITY}\"")
+        endif()
+
+        list(APPEND _flags "priority=${FUNC_PRIORITY}")
+    endif()
+
+    if(_flags)
+        string(REPLACE ";" " " _flags "${_flags}")
+        _loadso_embed_string(${LOADSO_PLUGIN_FLAGS_SECTION_NAME} loadso_plugin_flags_data "${_flags}")
+    endif()
+
+    # Accessor to the flags of the loaded image, so that PluginLoader doesn't read the file
+    if(NOT WIN32)
+        if(_flags)
+            set(_flags_return "*size = sizeof(loadso_plugin_flags_data)\;\n    return loadso_plugin_flags_data\;")
+        else()
+            set(_flags_return "*size = 0\;\n    return \"\"\;")
+        endif()
+
+        string(APPEND _metadata_content "
+#include <cstddef>
+
+extern \"C\" ${_export_attribute} const char *loadso_plugin_flags(size_t *size) {
+    ${_flags_return}
+}
+")
+    endif()
+
     set(_plugin_cpp ${_cache_dir}/${_name}_plugin_export.cpp)
 
     if(${_header} MATCHES ".+\\.(h|hh|hpp|hxx)$")
@@ -107,5 +417,148 @@ extern \"C\" ${_export_attribute} ${_class_name} *loadso_plugin_instance() {
 }
 ")
 
+    if(FUNC_WARMUP)
+        if(NOT FUNC_WARMUP MATCHES "^[A-Za-z_][A-Za-z0-9_]*$")
+            message(FATAL_ERROR "loadso_export_plugin: invalid WARMUP \"${FUNC_WARMUP}\"")
+        endif()
+
+        string(APPEND _metadata_content "
+#include <atomic>
+
+extern \"C\" ${_export_attribute} bool loadso_plugin_warmup(void *instance, const std::atomic<bool> *cancelled) {
+    return static_cast<${_class_name} *>(instance)->${FUNC_WARMUP}(*cancelled)\;
+}
+")
+    endif()
+
     file(WRITE ${_plugin_cpp} ${_metadata_content})
 endfunction()
+
+#[[
+
+    Generates one exported table of function pointers, so that a host fetches all the entry
+    points of a plugin with a single lookup through Library::functionTable().
+
+    loadso_export_functions(<target> <table name>
+        FUNCTIONS <names>...
+        [VERSION <version>]
+        [HEADERS <files>...]
+        [OUTPUT_HEADER <file>]
+        [HIDDEN]
+    )
+
+    HEADERS declare the functions, without it they are declared as extern "C" void <name>(void).
+
+    OUTPUT_HEADER writes a header for the host with the table version, the hash of the function
+    list and an enumerator of the index of each function:
+        LOADSO_FUNCTIONS_<TABLE>_VERSION, LOADSO_FUNCTIONS_<TABLE>_COUNT,
+        LOADSO_FUNCTIONS_<TABLE>_HASH, LOADSO_FUNCTIONS_<TABLE>_<function>
+
+    HIDDEN removes the functions from the dynamic symbol table (unless they are declared with an
+    explicit visibility), so that the table costs relative relocations instead of symbol lookups.
+
+]]#
+function(loadso_export_functions _target _table)
+    set(options HIDDEN)
+    set(oneValueArgs VERSION OUTPUT_HEADER)
+    set(multiValueArgs FUNCTIONS HEADERS)
+    cmake_parse_arguments(FUNC "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+    if(NOT FUNC_FUNCTIONS)
+        message(FATAL_ERROR "loadso_export_functions: no FUNCTIONS given")
+    endif()
+
+    if(NOT FUNC_VERSION)
+        set(FUNC_VERSION 1)
+    endif()
+
+    list(LENGTH FUNC_FUNCTIONS _count)
+    string(REPLACE ";" "\n" _names "${FUNC_FUNCTIONS}")
+    string(SHA256 _hash "${_names}")
+    string(SUBSTRING ${_hash} 0 16 _hash)
+    string(TOUPPER ${_table} _table_upper)
+
+    if(WIN32)
+        set(_export_attribute "__declspec(dllexport)")
+    else()
+        set(_export_attribute "__attribute__((visibility(\"default\")))")
+    endif()
+
+    set(_content "// LoadSO Function Table\n\n")
+
+    if(FUNC_HIDDEN AND NOT WIN32)
+        string(APPEND _content "#pragma GCC visibility push(hidden)\n")
+    endif()
+
+    if(FUNC_HEADERS)
+        foreach(_file ${FUNC_HEADERS})
+            get_filename_component(_file ${_file} ABSOLUTE)
+            string(APPEND _content "#include \"${_file}\"\n")
+        endforeach()
+    else()
+        foreach(_func ${FUNC_FUNCTIONS})
+            string(APPEND _content "extern \"C\" void ${_func}(void);\n")
+        endforeach()
+    endif()
+
+    if(FUNC_HIDDEN AND NOT WIN32)
+        string(APPEND _content "#pragma GCC visibility pop\n")
+    endif()
+
+    set(_entries)
+
+    foreach(_func ${FUNC_FUNCTIONS})
+        string(APPEND _entries "        (void *) &${_func},\n")
+    endforeach()
+
+    # Layout read by Library::functionTable()
+    string(APPEND _content "
+struct loadso_function_table_${_table} {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int count;
+    unsigned int reserved;
+    unsigned long long hash;
+    void *functions[${_count}];
+};
+
+extern \"C\" ${_export_attribute} const loadso_function_table_${_table} loadso_functions_${_table};
+
+const loadso_function_table_${_table} loadso_functions_${_table} = {
+    0x5446534C,
+    ${FUNC_VERSION},
+    ${_count},
+    0,
+    0x${_hash}ULL,
+    {
+${_entries}    },
+};
+")
+
+    set(_cache_dir ${CMAKE_CURRENT_BINARY_DIR}/loadso_plugin_autogen)
+    file(MAKE_DIRECTORY ${_cache_dir})
+
+    set(_table_cpp ${_cache_dir}/${_target}_${_table}_functions.cpp)
+    file(WRITE ${_table_cpp} "${_content}")
+    target_sources(${_target} PRIVATE ${_table_cpp})
+
+    if(FUNC_OUTPUT_HEADER)
+        set(_guard "LOADSO_FUNCTIONS_${_table_upper}_H")
+        set(_header_content "#ifndef ${_guard}\n#define ${_guard}\n\n")
+        string(APPEND _header_content "#define LOADSO_FUNCTIONS_${_table_upper}_VERSION ${FUNC_VERSION}\n")
+        string(APPEND _header_content "#define LOADSO_FUNCTIONS_${_table_upper}_COUNT ${_count}\n")
+        string(APPEND _header_content "#define LOADSO_FUNCTIONS_${_table_upper}_HASH 0x${_hash}ULL\n\n")
+        string(APPEND _header_content "enum {\n")
+
+        foreach(_func ${FUNC_FUNCTIONS})
+            string(APPEND _header_content "    LOADSO_FUNCTIONS_${_table_upper}_${_func},\n")
+        endforeach()
+
+        string(APPEND _header_content "};\n\n#endif // ${_guard}\n")
+
+        # Only touch the header when it changes
+        set(_header_tmp ${_cache_dir}/${_target}_${_table}_functions.h)
+        file(WRITE ${_header_tmp} "${_header_content}")
+        configure_file(${_header_tmp} ${FUNC_OUTPUT_HEADER} COPYONLY)
+    endif()
+endfunction()
@@ -0,0 +1,69 @@
+#ifndef LOADSO_CALLPROFILER_H
+#define LOADSO_CALLPROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <loadso/loadso_global.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Call counts and latencies of the exports of libraries opened with
+     *        \c Library::ProfileCallsHint.
+     *
+     * Such a library hands out a trampoline instead of the function address from resolve(). The
+     * trampoline records the call on a thread local shadow stack, calls the function and counts
+     * the elapsed time in thread local counters, so no plugin needs rebuilding. Times include
+     * nested calls. Supported on x86-64 Linux, elsewhere the hint is ignored.
+     *
+     * The caller's return address is kept on the shadow stack, so exceptions must not propagate
+     * out of a profiled function; \c longjmp over one is tolerated.
+     */
+    class LOADSO_EXPORT CallProfiler {
+    public:
+        static constexpr const int Buckets = 32;
+
+        struct Export {
+            std::string library; // Library path, UTF-8 encoded
+            std::string name;
+            uint64_t calls = 0;
+            uint64_t totalNs = 0;
+            uint64_t maxNs = 0;
+            uint64_t histogram[Buckets] = {}; // Bucket i counts latencies in [2^i, 2^(i+1)) ns
+
+            /**
+             * @brief Returns the upper bound of the histogram bucket holding the quantile \c q.
+             */
+            uint64_t percentileNs(double q) const;
+        };
+
+        static bool IsSupported();
+
+        /**
+         * @brief Pauses or resumes recording, profiled functions are called directly while
+         *        paused. Enabled by default.
+         */
+        static void SetEnabled(bool on);
+        static bool IsEnabled();
+
+        /**
+         * @brief Returns the exports called since the last Reset(), summed over all threads.
+         */
+        static std::vector<Export> Snapshot();
+
+        /**
+         * @brief Discards the counters, each thread clears its own on its next call.
+         */
+        static void Reset();
+
+        /**
+         * @brief Formats a snapshot as a table per library, exports ordered by total time.
+         */
+        static std::string Report();
+    };
+
+}
+
+#endif // LOADSO_CALLPROFILER_H
@@ -0,0 +1,42 @@
+#ifndef LOADSO_FILEDIGEST_H
+#define LOADSO_FILEDIGEST_H
+
+#include <string>
+
+#include <loadso/loadso_global.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Content digests of plugin files, formatted as \c "xxh64:<16 hex digits>".
+     *
+     * XXH64 runs at memory bandwidth, so verifying a plugin costs far less than loading it. It
+     * detects corrupted, replaced or mismatched files; it is not a signature.
+     */
+    class LOADSO_EXPORT FileDigest {
+    public:
+        static std::string Hash(const void *data, size_t size);
+
+        /**
+         * @brief Hashes a file. Digests are cached by device, inode, modification time and size,
+         *        so that hashing a file again is a single \c stat until it changes.
+         */
+        static bool HashFile(const PathString &path, std::string *digest);
+
+#ifdef LOADSO_STD_FILESYSTEM
+        static inline bool HashFile2(const std::filesystem::path &path, std::string *digest);
+#endif
+
+        static void ClearCache();
+        static size_t CacheSize();
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline bool FileDigest::HashFile2(const std::filesystem::path &path, std::string *digest) {
+        return HashFile(path, digest);
+    }
+#endif
+
+}
+
+#endif // LOADSO_FILEDIGEST_H
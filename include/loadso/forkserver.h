@@ -0,0 +1,108 @@
+#ifndef LOADSO_FORKSERVER_H
+#define LOADSO_FORKSERVER_H
+
+#include <functional>
+#include <vector>
+
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Zygote process that loads and warms a set of plugins once, then forks workers on
+     *        demand. Workers inherit the mapped, relocated and constructed plugins copy-on-write.
+     *
+     * Only available on Unix, start() fails on Windows.
+     */
+    class LOADSO_EXPORT ForkServer {
+    public:
+        ForkServer();
+        ~ForkServer();
+
+        ForkServer(ForkServer &&other) noexcept;
+        ForkServer &operator=(ForkServer &&other) noexcept;
+
+    public:
+        /**
+         * @brief Worker entry, called in the forked worker, the return value is its exit code.
+         */
+        using WorkerMain = std::function<int(ForkServer &server, const std::string &arg)>;
+
+        /**
+         * @brief Called in the zygote after a plugin is loaded, to touch whatever should be
+         *        shared by the workers.
+         */
+        using WarmUp = std::function<void(PluginLoader &plugin)>;
+
+        /**
+         * @brief Adds a plugin to preload, resolving all symbols by default so that no lazy
+         *        binding happens in the workers.
+         */
+        void addPlugin(const PathString &path, int hints = Library::ResolveAllSymbolsHint);
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline void addPlugin2(const std::filesystem::path &path,
+                               int hints = Library::ResolveAllSymbolsHint);
+#endif
+
+        void setWorkerMain(const WorkerMain &main);
+        void setWarmUp(const WarmUp &warmUp);
+
+        /**
+         * @brief Forks the zygote and waits until it has preloaded all plugins. Call it before
+         *        the host starts other threads, only the calling thread survives the fork.
+         */
+        bool start();
+
+        /**
+         * @brief Stops the zygote, running workers are not affected.
+         */
+        void stop();
+
+        bool isRunning() const;
+
+        /**
+         * @brief Asks the zygote to fork a worker running the worker entry with the argument.
+         *        spawn() and wait() may be called from several threads, requests are served one
+         *        at a time.
+         *
+         * @return Worker process id, or -1 if failed
+         */
+        int spawn(const std::string &arg = {});
+
+        /**
+         * @brief Waits for a worker to exit, workers are children of the zygote so they can't
+         *        be waited for directly. The zygote reaps workers as they exit and keeps their
+         *        status until it is waited for, so every spawned worker should be waited for.
+         *
+         * @return Raw wait status as returned by waitpid(), or -1 if failed
+         */
+        int wait(int pid);
+
+        /**
+         * @brief Returns the preloaded plugins, only meaningful inside a worker.
+         */
+        std::vector<PluginLoader> &plugins();
+
+        /**
+         * @brief Returns the preloaded plugin of a path, or \c nullptr, only meaningful inside a
+         *        worker.
+         */
+        PluginLoader *plugin(const PathString &path);
+
+        std::string lastError() const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline void ForkServer::addPlugin2(const std::filesystem::path &path, int hints) {
+        addPlugin(path, hints);
+    }
+#endif
+
+}
+
+#endif // LOADSO_FORKSERVER_H
@@ -1,14 +1,84 @@
 #ifndef LOADSO_LIBRARY_H
 #define LOADSO_LIBRARY_H
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <loadso/loadso_global.h>
 
+#ifdef LOADSO_STD_FILESYSTEM
+#  include <string_view>
+#endif
+
 namespace LoadSO {
 
     class PluginLoader;
 
+    /**
+     * @brief Symbol name with a precomputed FNV-1a hash, used as a key of the resolved symbol
+     *        cache. Constructing one from a string literal computes the hash at compile time.
+     *        From a character array, the name ends at its first terminating 0.
+     */
+    class SymbolName {
+    public:
+        template <size_t N>
+        constexpr SymbolName(const char (&name)[N])
+            : _data(name), _size(length(name, N)), _hash(hash(name, length(name, N))),
+              _terminated(length(name, N) < N) {
+        }
+
+        SymbolName(const char *data, size_t size)
+            : _data(data), _size(size), _hash(hash(data, size)), _terminated(false) {
+        }
+
+#ifdef LOADSO_STD_FILESYSTEM
+        explicit SymbolName(std::string_view name) : SymbolName(name.data(), name.size()) {
+        }
+#endif
+
+        constexpr const char *data() const {
+            return _data;
+        }
+
+        constexpr size_t size() const {
+            return _size;
+        }
+
+        constexpr uint64_t hashValue() const {
+            return _hash;
+        }
+
+        /**
+         * @brief Returns \c true if the data is known to be followed by a terminating 0.
+         */
+        constexpr bool isNullTerminated() const {
+            return _terminated;
+        }
+
+        /**
+         * @brief Returns the length of a string up to \c size characters.
+         */
+        static constexpr size_t length(const char *data, size_t size) {
+            return size == 0 || *data == '\0' ? 0 : 1 + length(data + 1, size - 1);
+        }
+
+        static constexpr uint64_t hash(const char *data, size_t size,
+                                       uint64_t seed = 14695981039346656037ULL) {
+            return size == 0 ? seed
+                             : hash(data + 1, size - 1,
+                                    (seed ^ static_cast<unsigned char>(*data)) * 1099511628211ULL);
+        }
+
+    protected:
+        const char *_data;
+        size_t _size;
+        uint64_t _hash;
+        bool _terminated;
+    };
+
     class LOADSO_EXPORT Library {
     public:
         Library();
@@ -26,7 +96,23 @@ namespace LoadSO {
             ExportExternalSymbolsHint = 0x02,
             LoadArchiveMemberHint = 0x04, // Unused
             PreventUnloadHint = 0x08,
-            DeepBindHint = 0x10
+            DeepBindHint = 0x10,
+            HugePageTextHint = 0x20, // Linux only, remap the code onto transparent huge pages
+            ProfileCallsHint = 0x40, // x86-64 Linux only, count exported calls, see CallProfiler
+            IsolatedNamespaceHint = 0x80, // glibc only, load a private copy, see PluginPool
+        };
+
+        /**
+         * @brief Error code of the last failed operation, captured at the moment of failure.
+         */
+        enum ErrorCode {
+            NoError = 0,
+            NotOpenError,
+            OpenError,
+            CloseError,
+            SymbolNotFoundError,
+            IncompatibleError,
+            IntegrityError,
         };
 
         /**
@@ -42,11 +128,50 @@ namespace LoadSO {
         inline bool open2(const std::filesystem::path &path, int hints = 0);
 #endif
 
+        /**
+         * @brief Loads a library from a file image in memory, so that it needs not exist on
+         *        disk. The image is copied to a sealed \c memfd which is loaded through
+         *        \c /proc/self/fd, path() then returns that path. Only supported on Linux.
+         *
+         * @param data Library file image
+         * @param size Image size
+         * @param hints Loading hints
+         * @param name Name of the memfd, shown in \c /proc/self/maps
+         */
+        bool openFromMemory(const void *data, size_t size, int hints = 0,
+                            const char *name = nullptr);
+
+        /**
+         * @brief Sets the digests the file may have, see FileDigest. If the list is not empty,
+         *        open() hashes the file before loading it and fails with \c IntegrityError unless
+         *        the digest is listed.
+         */
+        void setAllowedDigests(const std::vector<std::string> &digests);
+        const std::vector<std::string> &allowedDigests() const;
+
         /**
          * @brief Frees the library and returns \c true if successful.
          */
         bool close();
 
+        /**
+         * @brief Enables the process wide fast exit mode. In this mode a destroyed Library or
+         *        PluginLoader leaves its library loaded unless cleanup is required, sparing a
+         *        \c dlclose per library when a process with many plugins shuts down. close() and
+         *        PluginLoader::unload() still unload. Note that \c exit() runs the finalizers of
+         *        every loaded library anyway, end the process with \c quick_exit() or \c _exit()
+         *        to skip them as well.
+         */
+        static void SetFastExit(bool on);
+        static bool IsFastExit();
+
+        /**
+         * @brief Marks the library as needing to be unloaded on destruction even in fast exit
+         *        mode, e.g. because its finalizers flush data.
+         */
+        void setCleanupRequired(bool required);
+        bool isCleanupRequired() const;
+
         /**
          * @brief Returns \c true if the library is loaded.
          */
@@ -61,6 +186,14 @@ namespace LoadSO {
         inline std::filesystem::path path2() const;
 #endif
 
+        /**
+         * @brief Returns the bytes of code moved onto huge page backed memory by
+         *        \c HugePageTextHint, \c 0 if the hint was not given or nothing could be moved.
+         *        Only the 2 MiB aligned part of the code segments is moved; a library that was
+         *        already loaded, or transparent huge pages being disabled, leaves it untouched.
+         */
+        size_t hugePageTextSize() const;
+
         /**
          * @brief Returns the ibrary handle.
          */
@@ -68,14 +201,60 @@ namespace LoadSO {
 
         /**
          * @brief Returns the address of the exported symbol by name, the library
-         *        should be loaded first.
+         *        should be loaded first. With \c ProfileCallsHint, functions are returned as
+         *        trampolines recording their calls, see CallProfiler.
          *
          * @param name Function name
          */
         EntryHandle resolve(const char *name) const;
 
         /**
-         * @brief Returns the system's last error.
+         * @brief Resolves a symbol whose name is not necessarily null terminated. Names shorter
+         *        than 256 bytes are copied to a stack buffer, so no allocation happens.
+         */
+        EntryHandle resolve(const char *name, size_t size) const;
+
+        /**
+         * @brief Resolves a symbol by a precomputed name, results including failures are cached
+         *        so that repeated probes of optional symbols don't reach the system loader again.
+         */
+        EntryHandle resolve(const SymbolName &name) const;
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline EntryHandle resolve(std::string_view name) const;
+#endif
+
+        /**
+         * @brief Fetches a table generated by \c loadso_export_functions() with a single symbol
+         *        lookup. Fails with \c IncompatibleError if the table has another version or
+         *        fewer than \c count functions, or if \c hash is not \c 0 and differs from the
+         *        hash of the table's function list.
+         *
+         * @param name Table name
+         * @param version Table version the caller was built against
+         * @param count Number of functions the caller uses
+         * @param hash \c LOADSO_FUNCTIONS_<TABLE>_HASH of the generated header, or \c 0
+         * @return Function addresses in the order of the \c FUNCTIONS list, valid while the
+         *         library is loaded
+         */
+        const EntryHandle *functionTable(const char *name, uint32_t version, size_t count,
+                                         uint64_t hash = 0) const;
+
+        /**
+         * @brief Returns the error code of the last failed operation.
+         */
+        ErrorCode errorCode() const;
+
+        /**
+         * @brief Returns the native error code of the last failed operation, the value of
+         *        \c GetLastError() on Windows and \c 0 on Unix.
+         */
+        uint32_t nativeErrorCode() const;
+
+        /**
+         * @brief Returns the last error, the message is formatted from the error captured at the
+         *        moment of failure. Like \c dlerror(), the details are kept per thread, a failure
+         *        on another thread only yields a generic message.
          *
          * @param nativeLanguage Whether to use native language, only works on Windows
          * @return Last error message if an operation fails, UTF-8 encoded
@@ -97,6 +276,10 @@ namespace LoadSO {
     inline std::filesystem::path Library::path2() const {
         return path();
     }
+
+    inline EntryHandle Library::resolve(std::string_view name) const {
+        return resolve(name.data(), name.size());
+    }
 #endif
 
 }
@@ -0,0 +1,67 @@
+#ifndef LOADSO_LOADCOSTANALYZER_H
+#define LOADSO_LOADCOSTANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <loadso/loadso_global.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Static estimation of the load time cost of an ELF plugin, from its dynamic
+     *        relocations, initializers and dynamic flags, without loading it.
+     */
+    class LOADSO_EXPORT LoadCostAnalyzer {
+    public:
+        struct Report {
+            uint64_t relocations = 0;         // All dynamic relocations, including PLT
+            uint64_t relativeRelocations = 0; // Base address adjustments, no symbol lookup
+            uint64_t symbolicRelocations = 0; // Relocations that need a symbol lookup
+            uint64_t globalScopeRelocations = 0; // ...against undefined or interposable symbols
+            uint64_t pltRelocations = 0;
+            uint64_t constructors = 0; // DT_INIT and .init_array entries
+            uint64_t destructors = 0;  // DT_FINI and .fini_array entries
+            uint64_t exportedSymbols = 0;
+            uint64_t neededLibraries = 0;
+
+            bool bindNow = false; // DF_BIND_NOW, DF_1_NOW or DT_BIND_NOW
+            bool symbolic = false; // DF_SYMBOLIC or DT_SYMBOLIC
+            bool textRelocations = false; // DF_TEXTREL or DT_TEXTREL
+
+            /**
+             * @brief Weighted cost score, a global scope lookup weighs as much as 20 relative
+             *        relocations, a constructor as much as 1000. Lazy PLT relocations are only
+             *        paid at startup if the plugin is bound eagerly.
+             */
+            uint64_t score(bool eagerBinding = true) const;
+        };
+
+        /**
+         * @brief Analyzes an ELF image, returns \c false if the data is not a valid ELF file.
+         */
+        static bool Analyze(const void *data, size_t size, Report *report);
+        static bool AnalyzeFile(const PathString &path, Report *report);
+
+#ifdef LOADSO_STD_FILESYSTEM
+        static inline bool AnalyzeFile2(const std::filesystem::path &path, Report *report);
+#endif
+
+        /**
+         * @brief Returns the indexes of the reports sorted by descending score.
+         */
+        static std::vector<size_t> Rank(const std::vector<Report> &reports,
+                                        bool eagerBinding = true);
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline bool LoadCostAnalyzer::AnalyzeFile2(const std::filesystem::path &path,
+                                               Report *report) {
+        return AnalyzeFile(path, report);
+    }
+#endif
+
+}
+
+#endif // LOADSO_LOADCOSTANALYZER_H
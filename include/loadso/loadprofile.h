@@ -0,0 +1,139 @@
+#ifndef LOADSO_LOADPROFILE_H
+#define LOADSO_LOADPROFILE_H
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Which libraries a process loaded and used during its startup, and when, so that
+     *        the next start can prepare for them.
+     *
+     * While recording, every library opened through Library or PluginLoader is logged with its
+     * load time. The symbols resolved through the public resolve functions are logged too, and
+     * so is the first PluginLoader::instance() request. A library counts as used once any of
+     * these happens. Only events within the window after StartRecording() are kept. Outside of
+     * recording, the hooks cost one relaxed atomic load.
+     *
+     * On the next start, prefetch() reads the recorded files ahead. preload() loads the used
+     * plugins in parallel, in the order they were first used. Plugins used during startup bind
+     * eagerly, off the critical path. Plugins loaded but never used bind lazily.
+     */
+    class LOADSO_EXPORT LoadProfile {
+    public:
+        LoadProfile();
+        ~LoadProfile();
+
+        LoadProfile(LoadProfile &&other) noexcept;
+        LoadProfile &operator=(LoadProfile &&other) noexcept;
+
+    public:
+        static constexpr const uint64_t Unused = ~0ULL;
+
+        struct Entry {
+            std::string path;            // Absolute library path, UTF-8 encoded
+            uint64_t openedUs = 0;       // Since the recording started
+            uint64_t firstUseUs = Unused;
+            uint64_t loadUs = 0;         // Time spent in open()
+            std::vector<std::string> symbols; // In the order of first use
+
+            bool isUsed() const {
+                return firstUseUs != Unused;
+            }
+        };
+
+        /**
+         * @brief Starts recording for the given window, fails if already recording.
+         */
+        static bool StartRecording(std::chrono::milliseconds window);
+        static void StopRecording();
+
+        /**
+         * @brief Returns \c true while recording and the window has not passed.
+         */
+        static bool IsRecording();
+
+        /**
+         * @brief Returns what was recorded so far, may be called during or after recording.
+         */
+        static LoadProfile Recorded();
+
+        /**
+         * @brief Loads a profile file, returns \c false if the file is missing or malformed.
+         */
+        bool load(const PathString &path);
+
+        /**
+         * @brief Saves the profile file.
+         */
+        bool save(const PathString &path) const;
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline bool load2(const std::filesystem::path &path);
+        inline bool save2(const std::filesystem::path &path) const;
+#endif
+
+        bool fromData(const void *data, size_t size);
+        std::string toData() const;
+
+        /**
+         * @brief Returns the entries in the order the libraries were opened.
+         */
+        const std::vector<Entry> &entries() const;
+
+        /**
+         * @brief Returns the entry of a library path, relative paths are evaluated against the
+         *        executable directory like Library::open() does. Returns \c nullptr if absent.
+         */
+        const Entry *find(const PathString &path) const;
+
+        /**
+         * @brief Returns the load hints for a library. \c ResolveAllSymbolsHint is added if the
+         *        library was used during startup, and removed if it was loaded but never used.
+         *        Libraries missing from the profile keep the given hints.
+         */
+        int hints(const PathString &path, int hints = 0) const;
+
+        /**
+         * @brief Asks the system to read the recorded files into the page cache in the
+         *        background, in the order they were opened. Unix only.
+         *
+         * @return Number of files prefetched
+         */
+        size_t prefetch() const;
+
+        /**
+         * @brief Loads the plugins that were used during startup, in parallel and in the order
+         *        of first use, with hints(). Plugins missing from the profile, unused or already
+         *        loaded are skipped.
+         *
+         * @param threads Number of worker threads, \c 0 for the hardware concurrency
+         * @return Number of plugins loaded
+         */
+        size_t preload(const std::vector<PluginLoader *> &plugins, int hints = 0,
+                       int threads = 0) const;
+
+        std::string report() const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline bool LoadProfile::load2(const std::filesystem::path &path) {
+        return load(path);
+    }
+
+    inline bool LoadProfile::save2(const std::filesystem::path &path) const {
+        return save(path);
+    }
+#endif
+
+}
+
+#endif // LOADSO_LOADPROFILE_H
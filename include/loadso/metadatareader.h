@@ -0,0 +1,156 @@
+#ifndef LOADSO_METADATAREADER_H
+#define LOADSO_METADATAREADER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <loadso/loadso_global.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Host independent reader of plugin metadata, ELF, Mach-O and PE files are parsed
+     *        byte by byte so that plugins of any target can be inspected on any host.
+     */
+    class LOADSO_EXPORT MetadataReader {
+    public:
+        enum Format {
+            UnknownFormat,
+            ElfFormat,
+            MachOFormat,
+            PeFormat,
+        };
+
+        /**
+         * @brief Default resource name, \c .loadso_metadata section on ELF,
+         *        \c __TEXT,loadso_metadata section on Mach-O and \c LOADSO_METADATA RCDATA
+         *        resource on PE.
+         */
+        static constexpr const char *DefaultName = "loadso_metadata";
+
+        /**
+         * @brief Name of the resource table written by the \c RESOURCES option of
+         *        \c loadso_export_plugin(). On ELF and Mach-O it is one section holding an index
+         *        followed by the resources. On PE it is an RCDATA listing the names, with each
+         *        resource in an RCDATA of its own.
+         */
+        static constexpr const char *ResourcesName = "loadso_resources";
+
+        /**
+         * @brief Everything the readers extract from a plugin file in one pass.
+         */
+        struct FileInfo {
+            Format format = UnknownFormat;
+            std::string metadata;
+            std::vector<std::string> exports;      // Exported symbol names, as passed to dlsym
+            std::vector<std::string> dependencies; // Names of the libraries the file needs
+        };
+
+        /**
+         * @brief I/O backend of the batched file readers.
+         */
+        enum IoBackend {
+            AutoBackend,    // io_uring when the kernel allows it, pread otherwise
+            IoUringBackend, // Requests a ring, falls back to pread if it cannot be set up
+            PreadBackend,
+        };
+
+        /**
+         * @brief Detects the binary format from the leading bytes of a file.
+         */
+        static Format DetectFormat(const void *data, size_t size);
+
+        /**
+         * @brief Reads a named resource from a file image of a specific format.
+         *
+         * @param data File content
+         * @param size File size
+         * @param out Resource content
+         * @param name Resource name, defaults to \c DefaultName
+         */
+        static bool ReadFromELF(const void *data, size_t size, std::string *out,
+                                const char *name = DefaultName);
+        static bool ReadFromMachO(const void *data, size_t size, std::string *out,
+                                  const char *name = DefaultName);
+        static bool ReadFromPE(const void *data, size_t size, std::string *out,
+                               const char *name = DefaultName);
+
+        /**
+         * @brief Reads a named resource from a file image of any supported format.
+         */
+        static bool Read(const void *data, size_t size, std::string *out,
+                         const char *name = DefaultName);
+
+        /**
+         * @brief Reads a named resource from a file, only the headers and the resource itself
+         *        are read from disk.
+         */
+        static bool ReadFile(const PathString &path, std::string *out,
+                             const char *name = DefaultName);
+
+        /**
+         * @brief Reads one resource of the resource table by name. From a file, only the
+         *        headers, the index and that resource are read.
+         */
+        static bool ReadResource(const void *data, size_t size, const char *resource,
+                                 std::string *out);
+        static bool ReadFileResource(const PathString &path, const char *resource,
+                                     std::string *out);
+
+        /**
+         * @brief Lists the names in the resource table, in the order they were given.
+         */
+        static bool ReadResourceNames(const void *data, size_t size,
+                                      std::vector<std::string> *names);
+        static bool ReadFileResourceNames(const PathString &path,
+                                          std::vector<std::string> *names);
+
+        /**
+         * @brief Reads the named resource, exported symbols and dependencies of a file image,
+         *        returns \c false if the format is unknown or the headers are broken. A missing
+         *        resource is not an error and leaves \c metadata empty.
+         */
+        static bool ReadInfo(const void *data, size_t size, FileInfo *info,
+                             const char *name = DefaultName);
+        static bool ReadFileInfo(const PathString &path, FileInfo *info,
+                                 const char *name = DefaultName);
+
+        /**
+         * @brief Reads the info of many files at once. The reads the parsers depend on are
+         *        issued in rounds across all files, each round as one batch, so that the
+         *        latency of slow storage is paid per round rather than per read and per file.
+         *
+         * @param paths Files to read
+         * @param infos Info of each file, cleared where reading failed
+         * @param succeeded Whether each file was read successfully, may be \c nullptr
+         * @param name Resource name, defaults to \c DefaultName
+         * @param backend I/O backend, Windows always reads the files one by one
+         * @return Number of files read successfully
+         */
+        static size_t ReadFilesInfo(const std::vector<PathString> &paths,
+                                    std::vector<FileInfo> *infos,
+                                    std::vector<bool> *succeeded = nullptr,
+                                    const char *name = DefaultName,
+                                    IoBackend backend = AutoBackend);
+
+        /**
+         * @brief Returns the backend \c AutoBackend resolves to in this process.
+         */
+        static IoBackend DefaultIoBackend();
+
+#ifdef LOADSO_STD_FILESYSTEM
+        static inline bool ReadFile2(const std::filesystem::path &path, std::string *out,
+                                     const char *name = DefaultName);
+#endif
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline bool MetadataReader::ReadFile2(const std::filesystem::path &path, std::string *out,
+                                          const char *name) {
+        return ReadFile(path, out, name);
+    }
+#endif
+
+}
+
+#endif // LOADSO_METADATAREADER_H
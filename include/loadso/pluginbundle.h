@@ -0,0 +1,81 @@
+#ifndef LOADSO_PLUGINBUNDLE_H
+#define LOADSO_PLUGINBUNDLE_H
+
+#include <memory>
+#include <vector>
+
+#include <loadso/pluginindex.h>
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Single file archive of plugins and their index. Opening a bundle maps the file and
+     *        reads the index once; plugins are then loaded from the mapping or extracted on
+     *        demand, without touching a directory per plugin.
+     */
+    class LOADSO_EXPORT PluginBundle {
+    public:
+        PluginBundle();
+        ~PluginBundle();
+
+        PluginBundle(PluginBundle &&other) noexcept;
+        PluginBundle &operator=(PluginBundle &&other) noexcept;
+
+    public:
+        struct Member {
+            std::string name; // Name in the bundle, UTF-8 encoded
+            PathString path;  // File to pack
+        };
+
+        /**
+         * @brief Writes a bundle of files, indexing the metadata, exported symbols, dependencies
+         *        and digest of each. Files that are not binaries are packed with an unknown format.
+         *        Fails on duplicate member names. The output is replaced only when the whole
+         *        bundle was written.
+         *
+         * @param name Metadata resource name, defaults to \c MetadataReader::DefaultName
+         */
+        static bool Pack(const PathString &output, const std::vector<Member> &members,
+                         const char *name = MetadataReader::DefaultName);
+
+        bool open(const PathString &path);
+        void close();
+        bool isOpen() const;
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline bool open2(const std::filesystem::path &path);
+#endif
+
+        /**
+         * @brief Returns the index of the bundle, whose entry paths are the member names.
+         */
+        const PluginIndex &index() const;
+
+        /**
+         * @brief Returns the content of a member, which stays valid until the bundle is closed.
+         */
+        bool data(const std::string &name, const void **data, size_t *size) const;
+
+        bool extract(const std::string &name, const PathString &path) const;
+
+        /**
+         * @brief Loads a member with PluginLoader::loadFromMemory(). On platforms without memory
+         *        loading the member is extracted to the temporary directory and loaded from there.
+         */
+        bool load(const std::string &name, PluginLoader *loader, int hints) const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline bool PluginBundle::open2(const std::filesystem::path &path) {
+        return open(path);
+    }
+#endif
+
+}
+
+#endif // LOADSO_PLUGINBUNDLE_H
@@ -0,0 +1,176 @@
+#ifndef LOADSO_PLUGINHOST_H
+#define LOADSO_PLUGINHOST_H
+
+#include <chrono>
+#include <functional>
+
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Loads a plugin in a forked helper process and calls it through shared memory, so
+     *        that a crashing or hanging plugin can't take the host down.
+     *
+     * Requests and replies travel through two single producer, single consumer rings in a shared
+     * mapping. The handler reads a request and writes its reply in place, and a side that finds
+     * work waiting never enters the kernel, it only sleeps on a futex after spinning briefly. A
+     * helper that dies or exceeds the call timeout is reaped and, within the restart limit,
+     * forked again before the failed call returns.
+     *
+     * Helpers are forked by a single threaded zygote that start() forks from the host, so a
+     * restart never forks the host itself. The zygote exits when the host does, and the helper
+     * with it, no matter which host thread called start().
+     *
+     * Only available on Linux, start() fails elsewhere.
+     */
+    class LOADSO_EXPORT PluginHost {
+    public:
+        explicit PluginHost(const PathString &path = {},
+                            int hints = Library::ResolveAllSymbolsHint);
+        ~PluginHost();
+
+        PluginHost(PluginHost &&other) noexcept;
+        PluginHost &operator=(PluginHost &&other) noexcept;
+
+    public:
+        /**
+         * @brief A request as seen by the handler, both buffers point into the shared rings.
+         */
+        struct Call {
+            uint32_t method;
+            const void *data;
+            size_t size;
+            void *reply;
+            size_t capacity;
+            size_t replySize; // Set by the handler, 0 by default
+        };
+
+        /**
+         * @brief Serves a request in the helper process with the loaded plugin, the return value
+         *        is handed to the caller as the status.
+         */
+        using Handler = std::function<int32_t(PluginLoader &plugin, Call &call)>;
+
+        PathString path() const;
+        void setPath(const PathString &path);
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline std::filesystem::path path2() const;
+        inline void setPath2(const std::filesystem::path &path);
+#endif
+
+        int hints() const;
+        void setHints(int hints);
+
+        void setHandler(const Handler &handler);
+
+        /**
+         * @brief Sets the size of each ring, rounded up to a power of two, 1 MiB by default. A
+         *        request or reply may take at most half of it. Takes effect on start().
+         */
+        void setRingSize(size_t size);
+        size_t ringSize() const;
+
+        /**
+         * @brief Returns the largest request or reply payload.
+         */
+        size_t maxMessageSize() const;
+
+        /**
+         * @brief Sets how long a call may take before the helper is killed, \c 0 to wait forever.
+         */
+        void setCallTimeout(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Sets how many times a crashed helper is restarted, \c -1 for no limit. The
+         *        default is 3.
+         */
+        void setMaxRestarts(int count);
+
+        /**
+         * @brief Forks the zygote and the helper and waits until the plugin is loaded. Call it
+         *        before the host starts other threads, a lock held by another thread at the fork
+         *        stays held in the helper. The path, hints and handler take effect here.
+         */
+        bool start();
+
+        /**
+         * @brief Asks the helper to exit and kills it if it doesn't within a short grace period,
+         *        then stops the zygote.
+         */
+        void stop();
+
+        bool isRunning() const;
+
+        /**
+         * @brief Returns the process id of the helper, or -1.
+         */
+        int pid() const;
+
+        /**
+         * @brief Returns how many times the helper has been restarted after a crash.
+         */
+        int restarts() const;
+
+        /**
+         * @brief Sends a request and waits for the reply, both are copied, see reserve() for the
+         *        in place variant. Calls from several threads are serialized. Fails if the helper
+         *        crashes or times out, the helper is restarted before returning unless the
+         *        restart limit is reached.
+         *
+         * @param reply Receives the reply payload, may be \c nullptr
+         * @param status Receives the return value of the handler, may be \c nullptr
+         */
+        bool call(uint32_t method, const void *data, size_t size, std::string *reply = nullptr,
+                  int32_t *status = nullptr);
+
+        /**
+         * @brief Reserves room for a request of at most \c size bytes in the request ring, so that
+         *        it is built in place instead of copied by call(). Other requests wait until the
+         *        same thread calls callReserved() or cancelReserved().
+         *
+         * @return Where to write the request, or \c nullptr if failed
+         */
+        void *reserve(size_t size);
+
+        /**
+         * @brief Sends the reserved request with its final size and waits for the reply, which is
+         *        read in place. The reply points into the shared ring and stays valid until the
+         *        next request, the helper can still write to it so copy what must not change.
+         */
+        bool callReserved(uint32_t method, size_t size, const void **reply = nullptr,
+                          size_t *replySize = nullptr, int32_t *status = nullptr);
+
+        /**
+         * @brief Drops the reserved request without sending it.
+         */
+        void cancelReserved();
+
+        /**
+         * @brief Queues a request without waiting for it to be served, its reply is discarded.
+         *        Requests are served in order, so a later call() observes the effects of all
+         *        posted ones. Blocks only while the ring is full.
+         */
+        bool post(uint32_t method, const void *data, size_t size);
+
+        std::string lastError() const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline std::filesystem::path PluginHost::path2() const {
+        return path();
+    }
+
+    inline void PluginHost::setPath2(const std::filesystem::path &path) {
+        setPath(path);
+    }
+#endif
+
+}
+
+#endif // LOADSO_PLUGINHOST_H
@@ -0,0 +1,73 @@
+#ifndef LOADSO_PLUGININDEX_H
+#define LOADSO_PLUGININDEX_H
+
+#include <memory>
+
+#include <loadso/metadatareader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Prebuilt index of plugin files, produced at package time (e.g. by loadso-scan) so
+     *        that processes can find plugins and their metadata without scanning them.
+     */
+    class LOADSO_EXPORT PluginIndex {
+    public:
+        PluginIndex();
+        ~PluginIndex();
+
+        PluginIndex(PluginIndex &&other) noexcept;
+        PluginIndex &operator=(PluginIndex &&other) noexcept;
+
+    public:
+        struct Entry {
+            std::string path; // UTF-8 encoded
+            MetadataReader::FileInfo info;
+            std::string digest; // FileDigest of the file, empty if not recorded
+        };
+
+        /**
+         * @brief Loads an index file, returns \c false if the file is missing or malformed.
+         */
+        bool load(const PathString &path);
+
+        /**
+         * @brief Saves the index file.
+         */
+        bool save(const PathString &path) const;
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline bool load2(const std::filesystem::path &path);
+        inline bool save2(const std::filesystem::path &path) const;
+#endif
+
+        bool fromData(const void *data, size_t size);
+        std::string toData() const;
+
+        const std::vector<Entry> &entries() const;
+        void addEntry(Entry entry);
+        void clear();
+
+        /**
+         * @brief Returns the entry of a path, or \c nullptr if absent.
+         */
+        const Entry *find(const std::string &path) const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline bool PluginIndex::load2(const std::filesystem::path &path) {
+        return load(path);
+    }
+
+    inline bool PluginIndex::save2(const std::filesystem::path &path) const {
+        return save(path);
+    }
+#endif
+
+}
+
+#endif // LOADSO_PLUGININDEX_H
@@ -1,6 +1,9 @@
 #ifndef LOADSO_PLUGINLOADER_H
 #define LOADSO_PLUGINLOADER_H
 
+#include <chrono>
+#include <vector>
+
 #include <loadso/library.h>
 
 namespace LoadSO {
@@ -15,20 +18,173 @@ namespace LoadSO {
 
     public:
         /**
-         * @brief Returns the plugin instance.
+         * @brief Plugin specific load hints, combined with Library::LoadHint.
+         */
+        enum LoadHint {
+            DeferConstructionHint = 0x100, // Load the library without creating the instance
+            WarmUpHint = 0x200,            // Start warmUp() once the instance is constructed
+        };
+
+        /**
+         * @brief Returns the plugin instance, \c nullptr if not constructed yet.
          *
          * @return Instance handle
          */
         void *instance() const;
 
         /**
-         * @brief Returns the meta data for this plugin.
+         * @brief Creates the plugin instance if the plugin was loaded with
+         *        \c DeferConstructionHint, may be called from any thread.
+         */
+        bool construct();
+
+        bool isConstructed() const;
+
+        /**
+         * @brief Returns the time spent in the instance entry, i.e. the plugin's constructor.
+         */
+        std::chrono::nanoseconds constructionTime() const;
+
+        /**
+         * @brief Constructs the instances of loaded plugins in parallel.
+         *
+         * @param plugins Plugins loaded with \c DeferConstructionHint
+         * @param threads Number of worker threads, \c 0 for the hardware concurrency
+         * @return Number of plugins constructed successfully
+         */
+        static size_t ConstructAll(const std::vector<PluginLoader *> &plugins, int threads = 0);
+
+        enum WarmUpState {
+            NoWarmUp,
+            WarmingUp,
+            WarmedUp,
+            WarmUpFailed,
+            WarmUpCancelled,
+        };
+
+        /**
+         * @brief Runs the warm-up entry emitted by \c loadso_export_plugin(WARMUP) on a
+         *        background thread, so that the plugin fills its caches and binds its symbols
+         *        before the first request. Fails if the instance is not constructed or the plugin
+         *        has no warm-up entry. A warm-up already running is left alone.
+         *
+         * With \c WarmUpHint, load() or construct() starts it, and plugins without the entry
+         * are loaded as usual.
+         */
+        bool warmUp();
+
+        /**
+         * @brief Sets the cancellation token passed to the warm-up entry and waits for it to
+         *        return. unload() and the destructor do this too.
+         */
+        void cancelWarmUp();
+
+        /**
+         * @brief Waits for the warm-up to finish, returns \c true if it succeeded.
+         */
+        bool waitForWarmUp();
+        bool waitForWarmUp(std::chrono::milliseconds timeout);
+
+        WarmUpState warmUpState() const;
+
+        /**
+         * @brief Returns the time spent in the warm-up entry, \c 0 until it finishes.
+         */
+        std::chrono::nanoseconds warmUpTime() const;
+
+        /**
+         * @brief Returns the meta data for this plugin, taken from the mapped image if the plugin
+         *        is loaded and read from the file otherwise.
          *
          * @return Metadata byte array
          */
         const std::string &metaData() const;
 
+        /**
+         * @brief Returns the metadata of the loaded plugin as a view into its mapped image, valid
+         *        until the plugin is unloaded. Nothing is copied and the file is not read, so it
+         *        works after the file on disk was replaced. Fails if the plugin is not loaded or
+         *        was built without the accessor emitted by \c loadso_export_plugin().
+         */
+        bool metaDataView(const char **data, size_t *size) const;
+
+        /**
+         * @brief Returns a resource embedded with the \c RESOURCES option of
+         *        \c loadso_export_plugin(). It is copied from the mapped image if the plugin is
+         *        loaded. Otherwise only the index and this resource are read from the file.
+         */
+        bool resource(const char *name, std::string *out) const;
+
+        /**
+         * @brief Returns a resource as a view into the mapped image, valid until the plugin is
+         *        unloaded. Fails if the plugin is not loaded.
+         */
+        bool resourceView(const char *name, const char **data, size_t *size) const;
+
+        /**
+         * @brief Returns the names of the embedded resources, in the order they were given.
+         */
+        std::vector<std::string> resourceNames() const;
+
+        /**
+         * @brief Sets the interface identifier the plugin must be built against, as computed by
+         *        \c loadso_interface_id() in CMake. load() rejects a plugin whose embedded ABI
+         *        descriptor differs before opening the library. An empty identifier disables the
+         *        check.
+         */
+        void setRequiredInterface(const std::string &interfaceId);
+        const std::string &requiredInterface() const;
+
+        /**
+         * @brief Returns the ABI descriptor embedded by \c loadso_export_plugin(INTERFACE), read
+         *        from the file without loading it.
+         */
+        const std::string &interfaceId() const;
+
+        /**
+         * @brief Returns \c true if no interface is required or the plugin matches it.
+         */
+        bool isCompatible() const;
+
+        /**
+         * @brief Sets the digests the plugin file may have, checked by load() before the library
+         *        is opened, see Library::setAllowedDigests().
+         */
+        void setAllowedDigests(const std::vector<std::string> &digests);
+        const std::vector<std::string> &allowedDigests() const;
+
+        /**
+         * @brief Marks the plugin as needing to be unloaded in fast exit mode, see
+         *        Library::SetFastExit(). Plugins exported with \c CLEANUP_REQUIRED are marked by
+         *        their embedded flags.
+         */
+        void setCleanupRequired(bool required);
+        bool isCleanupRequired() const;
+
+        /**
+         * @brief Startup tier of a plugin, see StartupScheduler.
+         */
+        enum Priority {
+            CriticalPriority,   // Needed before the host serves, loaded on the calling thread
+            NormalPriority,     // Loaded by background workers once the host is ready
+            BackgroundPriority, // Loaded by background workers after the normal ones
+        };
+
+        /**
+         * @brief Returns the priority set by setPriority(), or else the one embedded by
+         *        \c loadso_export_plugin(PRIORITY), \c NormalPriority if none.
+         */
+        Priority priority() const;
+        void setPriority(Priority priority);
+
         bool load(int hints);
+
+        /**
+         * @brief Loads the plugin from a file image in memory, see Library::openFromMemory().
+         *        The metadata, interface and flags are read from the image, and path() returns
+         *        the \c /proc/self/fd path of the loaded image.
+         */
+        bool loadFromMemory(const void *data, size_t size, int hints, const char *name = nullptr);
         bool unload();
         bool isLoaded() const;
 
@@ -40,6 +196,7 @@ namespace LoadSO {
         inline void setPath2(const std::filesystem::path &path);
 #endif
 
+        Library::ErrorCode errorCode() const;
         std::string lastError(bool nativeLanguage = false) const;
 
     public:
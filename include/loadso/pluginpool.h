@@ -0,0 +1,150 @@
+#ifndef LOADSO_PLUGINPOOL_H
+#define LOADSO_PLUGINPOOL_H
+
+#include <vector>
+
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Independent copies of one plugin, each loaded into a linker namespace of its own
+     *        with \c Library::IsolatedNamespaceHint, for plugins with global mutable state that
+     *        are not reentrant. Workers acquire a copy for exclusive use and release it when
+     *        done, so such a plugin serves as many threads in parallel as there are copies.
+     *
+     * Every copy also loads its own copies of the plugin's dependencies, the C++ runtime
+     * included, so objects must not cross copies. glibc provides 16 namespaces per process,
+     * one of which is the default, so at most 15 copies exist in the process at a time.
+     * Only available with glibc, load() fails elsewhere.
+     */
+    class LOADSO_EXPORT PluginPool {
+    public:
+        explicit PluginPool(const PathString &path = {});
+
+        /**
+         * @brief Fails pending and later acquire() calls, then waits until every lease is
+         *        released before unloading, so it must not run on a thread holding a lease.
+         */
+        ~PluginPool();
+
+    public:
+        /**
+         * @brief Exclusive use of a copy, released on destruction.
+         */
+        class LOADSO_EXPORT Lease {
+        public:
+            Lease() = default;
+            ~Lease();
+
+            Lease(Lease &&other) noexcept;
+            Lease &operator=(Lease &&other) noexcept;
+
+            bool isValid() const {
+                return _plugin != nullptr;
+            }
+
+            PluginLoader *plugin() const {
+                return _plugin;
+            }
+
+            void *instance() const {
+                return _plugin ? _plugin->instance() : nullptr;
+            }
+
+            /**
+             * @brief Returns the index of the copy, or \c -1.
+             */
+            int index() const {
+                return _index;
+            }
+
+            void release();
+
+        private:
+            PluginPool *_pool = nullptr;
+            PluginLoader *_plugin = nullptr;
+            int _index = -1;
+
+            Lease(PluginPool *pool, int index);
+
+            Lease(const Lease &) = delete;
+            Lease &operator=(const Lease &) = delete;
+
+            friend class PluginPool;
+        };
+
+        PathString path() const;
+        void setPath(const PathString &path);
+
+#ifdef LOADSO_STD_FILESYSTEM
+        inline std::filesystem::path path2() const;
+        inline void setPath2(const std::filesystem::path &path);
+#endif
+
+        /**
+         * @brief Sets the interface identifier every copy must be built against, see
+         *        PluginLoader::setRequiredInterface().
+         */
+        void setRequiredInterface(const std::string &interfaceId);
+
+        /**
+         * @brief Loads \c count copies, fails and unloads them all if any copy fails.
+         *        \c Library::IsolatedNamespaceHint is added to the hints.
+         */
+        bool load(size_t count, int hints = 0);
+
+        /**
+         * @brief Unloads all copies, none may be leased.
+         */
+        bool unload();
+
+        bool isLoaded() const;
+
+        size_t size() const;
+
+        /**
+         * @brief Returns a copy by index, bypassing the leases.
+         */
+        PluginLoader &at(size_t index);
+
+        /**
+         * @brief Waits until a copy is free and leases it. The copy released last is handed out
+         *        first, it is the most likely to be warm in the caches. The returned lease is
+         *        invalid if the pool isn't loaded or is being destroyed.
+         */
+        Lease acquire();
+
+        /**
+         * @brief Leases a free copy, the returned lease is invalid if all copies are in use.
+         */
+        Lease tryAcquire();
+
+        /**
+         * @brief Returns the number of copies not leased.
+         */
+        size_t available() const;
+
+        std::string lastError() const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+
+        PluginPool(const PluginPool &) = delete;
+        PluginPool &operator=(const PluginPool &) = delete;
+    };
+
+#ifdef LOADSO_STD_FILESYSTEM
+    inline std::filesystem::path PluginPool::path2() const {
+        return path();
+    }
+
+    inline void PluginPool::setPath2(const std::filesystem::path &path) {
+        setPath(path);
+    }
+#endif
+
+}
+
+#endif // LOADSO_PLUGINPOOL_H
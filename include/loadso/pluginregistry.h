@@ -0,0 +1,79 @@
+#ifndef LOADSO_PLUGINREGISTRY_H
+#define LOADSO_PLUGINREGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Thread-safe table of plugins by key, optimized for many concurrent readers.
+     *
+     * Readers take a ReadLock, which costs two atomic increments on a per-thread shard and
+     * never waits or allocates. Writers publish a new immutable table and then wait for the
+     * readers of the previous one, so when add() or remove() returns no reader can observe
+     * the old state and a removed plugin may be unloaded. A thread holding a ReadLock must not
+     * call add(), remove() or clear(), they would wait for that lock forever.
+     */
+    class LOADSO_EXPORT PluginRegistry {
+    public:
+        PluginRegistry();
+        ~PluginRegistry();
+
+    public:
+        class LOADSO_EXPORT ReadLock {
+        public:
+            explicit ReadLock(const PluginRegistry &registry);
+            ~ReadLock();
+
+            /**
+             * @brief Returns the plugin of a key, or \c nullptr if absent. The pointer stays
+             *        valid as long as the lock is held.
+             */
+            PluginLoader *find(const char *key, size_t size) const;
+            PluginLoader *find(const std::string &key) const;
+
+            /**
+             * @brief Returns the instance of the plugin of a key, or \c nullptr.
+             */
+            void *instance(const std::string &key) const;
+
+            size_t size() const;
+
+        private:
+            const PluginRegistry &_registry;
+            const void *_table;
+            size_t _shard;
+            int _index;
+
+            ReadLock(const ReadLock &) = delete;
+            ReadLock &operator=(const ReadLock &) = delete;
+        };
+
+        /**
+         * @brief Registers a plugin, returns \c false if the key is already taken.
+         */
+        bool add(const std::string &key, PluginLoader *plugin);
+
+        /**
+         * @brief Unregisters a plugin, returns the plugin or \c nullptr if absent.
+         */
+        PluginLoader *remove(const std::string &key);
+
+        void clear();
+
+        std::vector<std::string> keys() const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+
+        PluginRegistry(const PluginRegistry &) = delete;
+        PluginRegistry &operator=(const PluginRegistry &) = delete;
+    };
+
+}
+
+#endif // LOADSO_PLUGINREGISTRY_H
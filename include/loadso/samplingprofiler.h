@@ -0,0 +1,56 @@
+#ifndef LOADSO_SAMPLINGPROFILER_H
+#define LOADSO_SAMPLINGPROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <loadso/loadso_global.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Process wide CPU sampler attributing time to the loaded libraries.
+     *
+     * A \c SIGPROF timer interrupts whichever thread is using the CPU, the handler looks up the
+     * interrupted program counter in a sorted index of the executable segments of all loaded
+     * objects and counts a sample for the owner. The index is built with \c dl_iterate_phdr and
+     * rebuilt only when the set of loaded objects changes, so the handler takes no lock and
+     * calls no function. Supported on Linux (x86, x86-64, AArch64).
+     */
+    class LOADSO_EXPORT SamplingProfiler {
+    public:
+        struct Module {
+            std::string path; // Object path, UTF-8 encoded, empty for code outside any object
+            uint64_t samples = 0;
+        };
+
+        /**
+         * @brief Starts sampling at a frequency in Hz of CPU time. Fails if unsupported, already
+         *        running, or the process already has a \c SIGPROF handler.
+         */
+        static bool Start(int frequency = 1000);
+        static void Stop();
+        static bool IsRunning();
+
+        /**
+         * @brief Rebuilds the index if objects were loaded or unloaded since it was built. Library
+         *        calls this itself; code loading objects by other means may call it.
+         */
+        static void Refresh();
+
+        /**
+         * @brief Returns the objects sampled since the last Reset(), most sampled first.
+         */
+        static std::vector<Module> Snapshot();
+        static void Reset();
+
+        /**
+         * @brief Formats a snapshot as the CPU share of each object.
+         */
+        static std::string Report();
+    };
+
+}
+
+#endif // LOADSO_SAMPLINGPROFILER_H
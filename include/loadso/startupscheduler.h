@@ -0,0 +1,98 @@
+#ifndef LOADSO_STARTUPSCHEDULER_H
+#define LOADSO_STARTUPSCHEDULER_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <loadso/pluginloader.h>
+
+namespace LoadSO {
+
+    /**
+     * @brief Loads a plugin set in tiers, so that a host can serve as soon as its critical
+     *        plugins are loaded.
+     *
+     * Critical plugins are loaded on the calling thread by loadCritical(). Once the host calls
+     * ready(), worker threads load the normal plugins and then the background ones. Each load is
+     * timed against the budget of the plugin, plugins over budget are reported.
+     */
+    class LOADSO_EXPORT StartupScheduler {
+    public:
+        StartupScheduler();
+        ~StartupScheduler();
+
+    public:
+        struct Result {
+            PluginLoader *plugin = nullptr;
+            PluginLoader::Priority priority = PluginLoader::NormalPriority;
+            bool finished = false;
+            bool loaded = false;
+            std::chrono::nanoseconds loadTime{0};
+            std::chrono::nanoseconds budget{0}; // 0 for no budget
+
+            bool isOverBudget() const {
+                return budget.count() > 0 && loadTime > budget;
+            }
+        };
+
+        /**
+         * @brief Adds a plugin, tiered by PluginLoader::priority(). Fails once ready() was called.
+         *
+         * @param hints Load hints passed to PluginLoader::load()
+         * @param budget Load time budget of this plugin, \c 0 for the budget of its priority
+         */
+        bool addPlugin(PluginLoader *plugin, int hints = 0,
+                       std::chrono::nanoseconds budget = std::chrono::nanoseconds(0));
+
+        void setBudget(PluginLoader::Priority priority, std::chrono::nanoseconds budget);
+        std::chrono::nanoseconds budget(PluginLoader::Priority priority) const;
+
+        /**
+         * @brief Sets the number of worker threads, \c 0 for the hardware concurrency.
+         */
+        void setThreads(int threads);
+
+        /**
+         * @brief Sets a function called on the loading thread for each plugin over budget.
+         */
+        void setOverBudgetHandler(const std::function<void(const Result &)> &handler);
+
+        /**
+         * @brief Loads the critical plugins on the calling thread in the order they were added,
+         *        returns \c true if all of them loaded.
+         */
+        bool loadCritical();
+
+        /**
+         * @brief Starts loading the other plugins in the background, loading the critical ones
+         *        first if loadCritical() was not called.
+         */
+        void ready();
+
+        /**
+         * @brief Waits until all plugins finished loading, returns \c true if all of them loaded.
+         */
+        bool wait();
+        bool isFinished() const;
+
+        std::vector<Result> results() const;
+        std::vector<Result> overBudget() const;
+
+        /**
+         * @brief Formats the load times of the finished plugins by tier.
+         */
+        std::string report() const;
+
+    protected:
+        class Impl;
+        std::unique_ptr<Impl> _impl;
+
+        StartupScheduler(const StartupScheduler &) = delete;
+        StartupScheduler &operator=(const StartupScheduler &) = delete;
+    };
+
+}
+
+#endif // LOADSO_STARTUPSCHEDULER_H
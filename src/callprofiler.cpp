@@ -0,0 +1,456 @@
+#include "callprofiler.h"
+#include "callprofiler_p.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "system.h"
+
+#ifdef LOADSO_CALL_PROFILER
+#  include <dlfcn.h>
+#  include <link.h>
+#endif
+
+#define LOADSO_PROFILE_SLOTS 4096
+
+#define _LOADSO_PROFILE_STR(s) #s
+#define LOADSO_PROFILE_STR(s)  _LOADSO_PROFILE_STR(s)
+
+namespace LoadSO {
+
+#ifdef LOADSO_CALL_PROFILER
+
+    // Every trampoline is 16 bytes: it loads its slot number and jumps to the common part, which
+    // saves the argument registers, asks loadso_profile_enter() for the target and whether to
+    // time the call, then calls the target in place of the caller (whose return address is kept
+    // on the shadow stack) and hands the result back through loadso_profile_leave().
+    asm(R"(
+    .pushsection .text
+    .p2align 4
+    .type loadso_profile_common, @function
+loadso_profile_common:
+    sub $200, %rsp
+    mov %rdi, 0(%rsp)
+    mov %rsi, 8(%rsp)
+    mov %rdx, 16(%rsp)
+    mov %rcx, 24(%rsp)
+    mov %r8, 32(%rsp)
+    mov %r9, 40(%rsp)
+    mov %rax, 48(%rsp)
+    movaps %xmm0, 64(%rsp)
+    movaps %xmm1, 80(%rsp)
+    movaps %xmm2, 96(%rsp)
+    movaps %xmm3, 112(%rsp)
+    movaps %xmm4, 128(%rsp)
+    movaps %xmm5, 144(%rsp)
+    movaps %xmm6, 160(%rsp)
+    movaps %xmm7, 176(%rsp)
+    mov %r11d, %edi
+    lea 200(%rsp), %rsi
+    call loadso_profile_enter
+    mov %rax, %r11
+    mov %rdx, %r10
+    mov 0(%rsp), %rdi
+    mov 8(%rsp), %rsi
+    mov 16(%rsp), %rdx
+    mov 24(%rsp), %rcx
+    mov 32(%rsp), %r8
+    mov 40(%rsp), %r9
+    mov 48(%rsp), %rax
+    movaps 64(%rsp), %xmm0
+    movaps 80(%rsp), %xmm1
+    movaps 96(%rsp), %xmm2
+    movaps 112(%rsp), %xmm3
+    movaps 128(%rsp), %xmm4
+    movaps 144(%rsp), %xmm5
+    movaps 160(%rsp), %xmm6
+    movaps 176(%rsp), %xmm7
+    add $200, %rsp
+    test %r10, %r10
+    jz 1f
+    add $8, %rsp
+    call *%r11
+    sub $48, %rsp
+    mov %rax, 0(%rsp)
+    mov %rdx, 8(%rsp)
+    movaps %xmm0, 16(%rsp)
+    movaps %xmm1, 32(%rsp)
+    lea 40(%rsp), %rdi
+    call loadso_profile_leave
+    mov %rax, %r11
+    mov 0(%rsp), %rax
+    mov 8(%rsp), %rdx
+    movaps 16(%rsp), %xmm0
+    movaps 32(%rsp), %xmm1
+    add $48, %rsp
+1:
+    jmp *%r11
+    .size loadso_profile_common, .-loadso_profile_common
+
+    .p2align 4
+    .globl loadso_profile_stubs
+    .hidden loadso_profile_stubs
+loadso_profile_stubs:
+    .set slot, 0
+    .rept )" LOADSO_PROFILE_STR(LOADSO_PROFILE_SLOTS) R"(
+    .p2align 4
+    endbr64
+    movl $slot, %r11d
+    jmp loadso_profile_common
+    .set slot, slot + 1
+    .endr
+    .popsection
+)");
+
+    extern "C" const char loadso_profile_stubs[];
+
+    static constexpr const size_t MaxSlots = LOADSO_PROFILE_SLOTS;
+    static constexpr const size_t StubSize = 16;
+    static constexpr const size_t ChunkSlots = 64;
+    static constexpr const int MaxDepth = 256;
+
+    struct SlotCounters {
+        // Written by the owning thread only, atomic so that snapshots may read them
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxNs;
+        std::atomic<uint64_t> histogram[CallProfiler::Buckets];
+    };
+
+    struct ThreadCounters {
+        std::atomic<bool> inUse{true};
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<SlotCounters *> chunks[MaxSlots / ChunkSlots] = {};
+        ThreadCounters *next = nullptr;
+    };
+
+    struct ShadowStack {
+        struct Frame {
+            uintptr_t sp; // Where the caller's return address was
+            uintptr_t ret;
+            uint64_t start;
+            uint32_t slot;
+        };
+        Frame frames[MaxDepth];
+        int depth = 0;
+        ThreadCounters *counters = nullptr;
+    };
+
+    struct SlotInfo {
+        std::string library;
+        std::string name;
+    };
+
+    static std::atomic<void *> g_Targets[MaxSlots];
+    static std::atomic<bool> g_Enabled(true);
+    static std::atomic<uint64_t> g_Epoch(1);
+
+    // Counters outlive their threads and are handed to new threads, never freed
+    static std::atomic<ThreadCounters *> g_Threads(nullptr);
+
+    static std::mutex g_SlotsMutex;
+    static std::unordered_map<std::string, uint32_t> g_Slots;
+    static std::vector<SlotInfo> g_SlotInfos;
+
+    static thread_local ShadowStack *t_Stack = nullptr;
+
+    struct StackGuard {
+        ~StackGuard() {
+            if (t_Stack) {
+                t_Stack->counters->inUse.store(false, std::memory_order_release);
+                delete t_Stack;
+                t_Stack = nullptr;
+            }
+        }
+    };
+
+    static inline uint64_t nowNs() {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count());
+    }
+
+    static ThreadCounters *acquireCounters() {
+        for (auto tc = g_Threads.load(std::memory_order_acquire); tc; tc = tc->next) {
+            bool expected = false;
+            if (tc->inUse.compare_exchange_strong(expected, true)) {
+                return tc;
+            }
+        }
+        auto tc = new ThreadCounters();
+        tc->next = g_Threads.load(std::memory_order_relaxed);
+        while (!g_Threads.compare_exchange_weak(tc->next, tc, std::memory_order_release)) {
+        }
+        return tc;
+    }
+
+    static ShadowStack *threadStack() {
+        if (!t_Stack) {
+            static thread_local StackGuard guard;
+            (void) guard;
+            t_Stack = new ShadowStack();
+            t_Stack->counters = acquireCounters();
+        }
+        return t_Stack;
+    }
+
+    static inline void bump(std::atomic<uint64_t> &counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta,
+                      std::memory_order_relaxed);
+    }
+
+    static void record(ThreadCounters *tc, uint32_t slot, uint64_t ns) {
+        const uint64_t epoch = g_Epoch.load(std::memory_order_relaxed);
+        if (tc->epoch.load(std::memory_order_relaxed) != epoch) {
+            for (auto &chunk : tc->chunks) {
+                auto counters = chunk.load(std::memory_order_relaxed);
+                for (size_t i = 0; counters && i < ChunkSlots; ++i) {
+                    auto &c = counters[i];
+                    c.calls.store(0, std::memory_order_relaxed);
+                    c.totalNs.store(0, std::memory_order_relaxed);
+                    c.maxNs.store(0, std::memory_order_relaxed);
+                    for (auto &bucket : c.histogram) {
+                        bucket.store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+            tc->epoch.store(epoch, std::memory_order_release);
+        }
+
+        auto &chunk = tc->chunks[slot / ChunkSlots];
+        auto counters = chunk.load(std::memory_order_relaxed);
+        if (!counters) {
+            counters = new SlotCounters[ChunkSlots]();
+            chunk.store(counters, std::memory_order_release);
+        }
+        auto &c = counters[slot % ChunkSlots];
+        bump(c.calls, 1);
+        bump(c.totalNs, ns);
+        if (ns > c.maxNs.load(std::memory_order_relaxed)) {
+            c.maxNs.store(ns, std::memory_order_relaxed);
+        }
+        int bucket = ns ? 63 - __builtin_clzll(ns) : 0;
+        bump(c.histogram[std::min(bucket, CallProfiler::Buckets - 1)], 1);
+    }
+
+    struct EnterResult {
+        void *target;
+        uintptr_t timed;
+    };
+
+    extern "C" __attribute__((visibility("hidden"), used)) EnterResult
+        loadso_profile_enter(uint32_t slot, uintptr_t *retp) {
+        auto target = g_Targets[slot].load(std::memory_order_acquire);
+        if (!g_Enabled.load(std::memory_order_relaxed)) {
+            return {target, 0};
+        }
+        auto stack = threadStack();
+
+        // Frames at or below the caller's were abandoned by a longjmp
+        const auto sp = reinterpret_cast<uintptr_t>(retp);
+        while (stack->depth > 0 && stack->frames[stack->depth - 1].sp <= sp) {
+            stack->depth--;
+        }
+        if (stack->depth == MaxDepth) {
+            return {target, 0};
+        }
+        stack->frames[stack->depth++] = {sp, *retp, nowNs(), slot};
+        return {target, 1};
+    }
+
+    extern "C" __attribute__((visibility("hidden"), used)) uintptr_t
+        loadso_profile_leave(uintptr_t sp) {
+        const uint64_t end = nowNs();
+        auto stack = t_Stack;
+        while (stack->depth > 0 && stack->frames[stack->depth - 1].sp < sp) {
+            stack->depth--;
+        }
+        if (stack->depth == 0 || stack->frames[stack->depth - 1].sp != sp) {
+            fprintf(stderr, "loadso: profiled call returned through a lost frame\n");
+            abort();
+        }
+        const auto &frame = stack->frames[--stack->depth];
+        record(stack->counters, frame.slot, end - frame.start);
+        return frame.ret;
+    }
+
+#endif
+
+    namespace CallProfilerPrivate {
+
+        void *wrap(void *addr, const PathString &library, const char *name, size_t size) {
+#ifdef LOADSO_CALL_PROFILER
+            if (!addr) {
+                return addr;
+            }
+
+            // Data symbols must be handed out as they are
+            Dl_info info;
+            void *extra = nullptr;
+            if (!dladdr1(addr, &info, &extra, RTLD_DL_SYMENT) || !extra ||
+                info.dli_saddr != addr ||
+                ELF64_ST_TYPE(static_cast<const ElfW(Sym) *>(extra)->st_info) != STT_FUNC) {
+                return addr;
+            }
+
+            const auto libraryName = System::MultiFromPathString(library);
+            std::string key = libraryName;
+            key.push_back('\0');
+            key.append(name, size);
+            key.push_back('\0');
+            key.append(reinterpret_cast<const char *>(&addr), sizeof(addr));
+
+            std::lock_guard<std::mutex> lock(g_SlotsMutex);
+            auto it = g_Slots.find(key);
+            if (it == g_Slots.end()) {
+                if (g_SlotInfos.size() == MaxSlots) {
+                    return addr;
+                }
+                const auto slot = uint32_t(g_SlotInfos.size());
+                g_SlotInfos.push_back({libraryName, std::string(name, size)});
+                g_Targets[slot].store(addr, std::memory_order_release);
+                it = g_Slots.emplace(std::move(key), slot).first;
+            }
+            return const_cast<char *>(loadso_profile_stubs) + it->second * StubSize;
+#else
+            (void) library;
+            (void) name;
+            (void) size;
+            return addr;
+#endif
+        }
+
+    }
+
+    uint64_t CallProfiler::Export::percentileNs(double q) const {
+        const double rank = q * double(calls);
+        uint64_t seen = 0;
+        for (int i = 0; i < Buckets; ++i) {
+            seen += histogram[i];
+            if (seen > 0 && double(seen) >= rank) {
+                return std::min(maxNs, (uint64_t(2) << i) - 1);
+            }
+        }
+        return maxNs;
+    }
+
+    bool CallProfiler::IsSupported() {
+#ifdef LOADSO_CALL_PROFILER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void CallProfiler::SetEnabled(bool on) {
+#ifdef LOADSO_CALL_PROFILER
+        g_Enabled = on;
+#else
+        (void) on;
+#endif
+    }
+
+    bool CallProfiler::IsEnabled() {
+#ifdef LOADSO_CALL_PROFILER
+        return g_Enabled;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<CallProfiler::Export> CallProfiler::Snapshot() {
+        std::vector<Export> res;
+#ifdef LOADSO_CALL_PROFILER
+        std::vector<SlotInfo> infos;
+        {
+            std::lock_guard<std::mutex> lock(g_SlotsMutex);
+            infos = g_SlotInfos;
+        }
+
+        // A library reopened at another address has several slots per export
+        std::map<std::pair<std::string, std::string>, Export> exports;
+        const uint64_t epoch = g_Epoch.load(std::memory_order_relaxed);
+        for (auto tc = g_Threads.load(std::memory_order_acquire); tc; tc = tc->next) {
+            if (tc->epoch.load(std::memory_order_acquire) != epoch) {
+                continue;
+            }
+            for (size_t slot = 0; slot < infos.size(); ++slot) {
+                auto counters = tc->chunks[slot / ChunkSlots].load(std::memory_order_acquire);
+                if (!counters) {
+                    continue;
+                }
+                const auto &c = counters[slot % ChunkSlots];
+                const uint64_t calls = c.calls.load(std::memory_order_relaxed);
+                if (calls == 0) {
+                    continue;
+                }
+                auto &exp = exports[{infos[slot].library, infos[slot].name}];
+                exp.calls += calls;
+                exp.totalNs += c.totalNs.load(std::memory_order_relaxed);
+                exp.maxNs = std::max(exp.maxNs, c.maxNs.load(std::memory_order_relaxed));
+                for (int i = 0; i < Buckets; ++i) {
+                    exp.histogram[i] += c.histogram[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        for (auto &item : exports) {
+            item.second.library = item.first.first;
+            item.second.name = item.first.second;
+            res.push_back(std::move(item.second));
+        }
+#endif
+        return res;
+    }
+
+    void CallProfiler::Reset() {
+#ifdef LOADSO_CALL_PROFILER
+        g_Epoch.fetch_add(1);
+#endif
+    }
+
+    std::string CallProfiler::Report() {
+        auto exports = Snapshot();
+
+        std::map<std::string, std::vector<const Export *>> libraries;
+        for (const auto &exp : exports) {
+            libraries[exp.library].push_back(&exp);
+        }
+
+        std::string res;
+        char buf[512];
+        for (auto &item : libraries) {
+            auto &list = item.second;
+            std::sort(list.begin(), list.end(), [](const Export *a, const Export *b) {
+                return a->totalNs > b->totalNs;
+            });
+            uint64_t calls = 0, totalNs = 0;
+            for (auto exp : list) {
+                calls += exp->calls;
+                totalNs += exp->totalNs;
+            }
+            snprintf(buf, sizeof(buf), "%s: %llu calls, %.3f ms\n", item.first.data(),
+                     (unsigned long long) calls, double(totalNs) / 1e6);
+            res += buf;
+            snprintf(buf, sizeof(buf), "  %12s %12s %10s %10s %10s %10s  %s\n", "calls",
+                     "total ms", "mean us", "p50 us", "p99 us", "max us", "export");
+            res += buf;
+            for (auto exp : list) {
+                snprintf(buf, sizeof(buf), "  %12llu %12.3f %10.3f %10.3f %10.3f %10.3f  %s\n",
+                         (unsigned long long) exp->calls, double(exp->totalNs) / 1e6,
+                         double(exp->totalNs) / double(exp->calls) / 1e3,
+                         double(exp->percentileNs(0.5)) / 1e3,
+                         double(exp->percentileNs(0.99)) / 1e3, double(exp->maxNs) / 1e3,
+                         exp->name.data());
+                res += buf;
+            }
+        }
+        return res;
+    }
+
+}
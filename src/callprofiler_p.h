@@ -0,0 +1,25 @@
+#ifndef CALLPROFILER_P_H
+#define CALLPROFILER_P_H
+
+#include "callprofiler.h"
+
+#if defined(__linux__) && defined(__x86_64__)
+#  define LOADSO_CALL_PROFILER
+#endif
+
+namespace LoadSO {
+
+    namespace CallProfilerPrivate {
+
+        /**
+         * @brief Returns the trampoline of a function exported by a library, the same one for
+         *        the same function. Returns \c addr itself if it is not a function or profiling
+         *        is unsupported or out of trampolines.
+         */
+        void *wrap(void *addr, const PathString &library, const char *name, size_t size);
+
+    }
+
+}
+
+#endif // CALLPROFILER_P_H
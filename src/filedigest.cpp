@@ -0,0 +1,276 @@
+#include "filedigest.h"
+#include "filedigest_p.h"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace LoadSO {
+
+    namespace FileDigestPrivate {
+
+        static const uint64_t P1 = 11400714785074694791ULL;
+        static const uint64_t P2 = 14029467366897019727ULL;
+        static const uint64_t P3 = 1609587929392839161ULL;
+        static const uint64_t P4 = 9650029242287828579ULL;
+        static const uint64_t P5 = 2870177450012600261ULL;
+
+        static inline uint64_t rotl(uint64_t x, int r) {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        static inline uint64_t read64(const unsigned char *p) {
+            uint64_t val;
+            memcpy(&val, p, 8);
+            return val;
+        }
+
+        static inline uint32_t read32(const unsigned char *p) {
+            uint32_t val;
+            memcpy(&val, p, 4);
+            return val;
+        }
+
+        static inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+            acc += input * P2;
+            return rotl(acc, 31) * P1;
+        }
+
+        static inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+            acc ^= xxhRound(0, val);
+            return acc * P1 + P4;
+        }
+
+        uint64_t xxh64(const void *data, size_t size, uint64_t seed) {
+            // Little endian hosts only, which covers every platform the library targets
+            auto p = static_cast<const unsigned char *>(data);
+            const auto end = p + size;
+            uint64_t h;
+
+            if (size >= 32) {
+                // Four independent lanes keep the multipliers of the CPU busy
+                uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+                const auto limit = end - 32;
+                do {
+                    v1 = xxhRound(v1, read64(p));
+                    v2 = xxhRound(v2, read64(p + 8));
+                    v3 = xxhRound(v3, read64(p + 16));
+                    v4 = xxhRound(v4, read64(p + 24));
+                    p += 32;
+                } while (p <= limit);
+
+                h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+                h = mergeRound(h, v1);
+                h = mergeRound(h, v2);
+                h = mergeRound(h, v3);
+                h = mergeRound(h, v4);
+            } else {
+                h = seed + P5;
+            }
+            h += size;
+
+            for (; p + 8 <= end; p += 8) {
+                h ^= xxhRound(0, read64(p));
+                h = rotl(h, 27) * P1 + P4;
+            }
+            if (p + 4 <= end) {
+                h ^= uint64_t(read32(p)) * P1;
+                h = rotl(h, 23) * P2 + P3;
+                p += 4;
+            }
+            for (; p < end; ++p) {
+                h ^= *p * P5;
+                h = rotl(h, 11) * P1;
+            }
+
+            h ^= h >> 33;
+            h *= P2;
+            h ^= h >> 29;
+            h *= P3;
+            h ^= h >> 32;
+            return h;
+        }
+
+        static std::string formatDigest(uint64_t hash) {
+            static const char hex[] = "0123456789abcdef";
+            std::string res = "xxh64:";
+            for (int i = 60; i >= 0; i -= 4) {
+                res.push_back(hex[(hash >> i) & 0xF]);
+            }
+            return res;
+        }
+
+        struct FileKeyHash {
+            size_t operator()(const FileKey &key) const {
+                return size_t(key.inode * P1 ^ key.device ^ uint64_t(key.mtime) * P2 ^ key.size);
+            }
+        };
+
+        static std::mutex g_CacheMutex;
+        static std::unordered_map<FileKey, std::string, FileKeyHash> g_Cache;
+
+#ifdef _WIN32
+        static void winFileKey(HANDLE hFile, FileKey *key, bool *ok) {
+            BY_HANDLE_FILE_INFORMATION info;
+            *ok = ::GetFileInformationByHandle(hFile, &info) != FALSE;
+            if (!*ok) {
+                return;
+            }
+            key->device = info.dwVolumeSerialNumber;
+            key->inode = uint64_t(info.nFileIndexHigh) << 32 | info.nFileIndexLow;
+            key->mtime = int64_t(uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32 |
+                                 info.ftLastWriteTime.dwLowDateTime);
+            key->size = uint64_t(info.nFileSizeHigh) << 32 | info.nFileSizeLow;
+        }
+#else
+        static void unixFileKey(const struct stat &st, FileKey *key) {
+            key->device = uint64_t(st.st_dev);
+            key->inode = uint64_t(st.st_ino);
+#  ifdef __APPLE__
+            key->mtime = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#  else
+            key->mtime = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#  endif
+            key->size = uint64_t(st.st_size);
+        }
+#endif
+
+        bool statFile(const PathString &path, FileKey *key) {
+#ifdef _WIN32
+            HANDLE hFile = ::CreateFileW(path.data(), 0,
+                                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                         nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (hFile == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+            bool ok;
+            winFileKey(hFile, key, &ok);
+            ::CloseHandle(hFile);
+            return ok;
+#else
+            struct stat st;
+            if (::stat(path.data(), &st) != 0) {
+                return false;
+            }
+            unixFileKey(st, key);
+            return true;
+#endif
+        }
+
+        bool hashFile(const PathString &path, std::string *digest, FileKey *key) {
+            // Key and content come from the same open file, so they describe one version
+#ifdef _WIN32
+            HANDLE hFile = ::CreateFileW(path.data(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (hFile == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+            bool ok;
+            winFileKey(hFile, key, &ok);
+            if (!ok) {
+                ::CloseHandle(hFile);
+                return false;
+            }
+#else
+            int fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                return false;
+            }
+            unixFileKey(st, key);
+#endif
+
+            {
+                std::lock_guard<std::mutex> lock(g_CacheMutex);
+                auto it = g_Cache.find(*key);
+                if (it != g_Cache.end()) {
+#ifdef _WIN32
+                    ::CloseHandle(hFile);
+#else
+                    ::close(fd);
+#endif
+                    *digest = it->second;
+                    return true;
+                }
+            }
+
+            uint64_t hash = xxh64(nullptr, 0);
+            bool ok = true;
+            if (key->size > 0) {
+#ifdef _WIN32
+                HANDLE hMapping =
+                    ::CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                const void *view =
+                    hMapping ? ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                if (view) {
+                    hash = xxh64(view, size_t(key->size));
+                    ::UnmapViewOfFile(view);
+                } else {
+                    ok = false;
+                }
+                if (hMapping) {
+                    ::CloseHandle(hMapping);
+                }
+#else
+                void *view = ::mmap(nullptr, size_t(key->size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view != MAP_FAILED) {
+                    ::madvise(view, size_t(key->size), MADV_SEQUENTIAL);
+                    hash = xxh64(view, size_t(key->size));
+                    ::munmap(view, size_t(key->size));
+                } else {
+                    ok = false;
+                }
+#endif
+            }
+#ifdef _WIN32
+            ::CloseHandle(hFile);
+#else
+            ::close(fd);
+#endif
+            if (!ok) {
+                return false;
+            }
+
+            *digest = formatDigest(hash);
+            std::lock_guard<std::mutex> lock(g_CacheMutex);
+            g_Cache[*key] = *digest;
+            return true;
+        }
+
+    }
+
+    using namespace FileDigestPrivate;
+
+    std::string FileDigest::Hash(const void *data, size_t size) {
+        return formatDigest(xxh64(data, size));
+    }
+
+    bool FileDigest::HashFile(const PathString &path, std::string *digest) {
+        FileKey key;
+        return hashFile(path, digest, &key);
+    }
+
+    void FileDigest::ClearCache() {
+        std::lock_guard<std::mutex> lock(g_CacheMutex);
+        g_Cache.clear();
+    }
+
+    size_t FileDigest::CacheSize() {
+        std::lock_guard<std::mutex> lock(g_CacheMutex);
+        return g_Cache.size();
+    }
+
+}
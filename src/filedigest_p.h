@@ -0,0 +1,44 @@
+#ifndef FILEDIGEST_P_H
+#define FILEDIGEST_P_H
+
+#include <cstdint>
+
+#include "filedigest.h"
+
+namespace LoadSO {
+
+    namespace FileDigestPrivate {
+
+        /**
+         * @brief Identity of a file version, a changed file gets a new key.
+         */
+        struct FileKey {
+            uint64_t device = 0;
+            uint64_t inode = 0;
+            int64_t mtime = 0;
+            uint64_t size = 0;
+
+            bool operator==(const FileKey &other) const {
+                return device == other.device && inode == other.inode &&
+                       mtime == other.mtime && size == other.size;
+            }
+
+            bool operator!=(const FileKey &other) const {
+                return !(*this == other);
+            }
+        };
+
+        uint64_t xxh64(const void *data, size_t size, uint64_t seed = 0);
+
+        bool statFile(const PathString &path, FileKey *key);
+
+        /**
+         * @brief Hashes a file and returns the key of the version hashed.
+         */
+        bool hashFile(const PathString &path, std::string *digest, FileKey *key);
+
+    }
+
+}
+
+#endif // FILEDIGEST_P_H
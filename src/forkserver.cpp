@@ -0,0 +1,361 @@
+#include "forkserver.h"
+#include "forkserver_p.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#ifndef _WIN32
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <signal.h>
+#  include <sys/socket.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+#include "system.h"
+
+namespace LoadSO {
+
+#ifndef _WIN32
+
+    static bool writeAll(int fd, const void *buf, size_t size) {
+        auto p = static_cast<const char *>(buf);
+        while (size > 0) {
+            auto n = ::write(fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+
+    static bool readAll(int fd, void *buf, size_t size) {
+        auto p = static_cast<char *>(buf);
+        while (size > 0) {
+            auto n = ::read(fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+
+    // Write end of the zygote's self-pipe, SIGCHLD wakes the request loop through it
+    static int g_ReapFd = -1;
+
+    static void onChildExit(int) {
+        const int savedErrno = errno;
+        std::ignore = ::write(g_ReapFd, "", 1);
+        errno = savedErrno;
+    }
+
+    // Message: int32 value, uint32 size, size bytes
+    static bool writeMessage(int fd, int32_t value, const std::string &data) {
+        uint32_t size = static_cast<uint32_t>(data.size());
+        return writeAll(fd, &value, sizeof(value)) && writeAll(fd, &size, sizeof(size)) &&
+               writeAll(fd, data.data(), data.size());
+    }
+
+    static bool readMessage(int fd, int32_t *value, std::string *data) {
+        uint32_t size;
+        if (!readAll(fd, value, sizeof(*value)) || !readAll(fd, &size, sizeof(size))) {
+            return false;
+        }
+        data->resize(size);
+        return size == 0 || readAll(fd, &(*data)[0], size);
+    }
+
+#endif
+
+    ForkServer::Impl::~Impl() {
+        stop();
+    }
+
+    void ForkServer::Impl::stop() {
+#ifndef _WIN32
+        if (fd < 0) {
+            return;
+        }
+
+        // The zygote exits when the socket is closed
+        ::close(fd);
+        fd = -1;
+        if (zygotePid > 0) {
+            while (::waitpid(zygotePid, nullptr, 0) < 0 && errno == EINTR) {
+            }
+            zygotePid = -1;
+        }
+#endif
+    }
+
+    void ForkServer::Impl::zygoteMain(ForkServer &server) {
+#ifndef _WIN32
+        // Preload and warm up
+        for (const auto &item : pluginList) {
+            PluginLoader loader(item.path);
+            std::ignore = loader.metaData();
+            if (!loader.load(item.hints)) {
+                writeMessage(fd, 0,
+                             System::MultiFromPathString(item.path) + ": " + loader.lastError());
+                std::_Exit(1);
+            }
+            if (warmUp) {
+                warmUp(loader);
+            }
+            plugins.push_back(std::move(loader));
+        }
+        if (!writeMessage(fd, 1, {})) {
+            std::_Exit(1);
+        }
+
+        // Reap workers as soon as they exit, their status is kept until it is waited for
+        int reapPipe[2];
+        if (::pipe(reapPipe) != 0) {
+            std::_Exit(1);
+        }
+        for (int pipeFd : reapPipe) {
+            ::fcntl(pipeFd, F_SETFD, FD_CLOEXEC);
+            ::fcntl(pipeFd, F_SETFL, O_NONBLOCK);
+        }
+        g_ReapFd = reapPipe[1];
+        struct sigaction action = {};
+        action.sa_handler = onChildExit;
+        action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+        ::sigaction(SIGCHLD, &action, nullptr);
+
+        std::map<int, int> exited;
+        auto reapAll = [&exited]() {
+            int status;
+            int pid;
+            while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+                exited[pid] = status;
+            }
+        };
+
+        // Serve requests until the parent closes the socket
+        int32_t value;
+        std::string data;
+        struct pollfd fds[2] = {
+            {fd,          POLLIN, 0},
+            {reapPipe[0], POLLIN, 0},
+        };
+        for (;;) {
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (fds[1].revents) {
+                char buf[64];
+                while (::read(reapPipe[0], buf, sizeof(buf)) > 0) {
+                }
+                reapAll();
+            }
+            if (!fds[0].revents) {
+                continue;
+            }
+            if (!readMessage(fd, &value, &data)) {
+                break;
+            }
+            reapAll();
+
+            int status;
+            int pid;
+
+            if (data.empty()) {
+                // Wait request
+                auto it = exited.find(value);
+                if (it != exited.end()) {
+                    status = it->second;
+                    exited.erase(it);
+                } else {
+                    while ((pid = ::waitpid(value, &status, 0)) < 0 && errno == EINTR) {
+                    }
+                    if (pid < 0) {
+                        status = -1;
+                    }
+                }
+                writeAll(fd, &status, sizeof(status));
+                continue;
+            }
+
+            // Spawn request, the argument is prefixed by one byte to tell it from a wait
+            ::fflush(nullptr);
+            pid = ::fork();
+            if (pid == 0) {
+                ::signal(SIGCHLD, SIG_DFL);
+                ::close(reapPipe[0]);
+                ::close(reapPipe[1]);
+                ::close(fd);
+                fd = -1;
+                int ret = workerMain ? workerMain(server, data.substr(1)) : 0;
+
+                // Skip the destructors inherited from the zygote and the host
+                ::fflush(nullptr);
+                std::_Exit(ret);
+            }
+            int32_t reply = pid;
+            writeAll(fd, &reply, sizeof(reply));
+        }
+#endif
+        std::_Exit(0);
+    }
+
+    bool ForkServer::Impl::request(char cmd, int32_t arg, const std::string &data,
+                                   int32_t *result) {
+#ifdef _WIN32
+        return false;
+#else
+        // Replies are matched to requests by order, so one request at a time
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0) {
+            error = "fork server is not running";
+            return false;
+        }
+        if (!writeMessage(fd, arg, cmd == 'S' ? cmd + data : std::string()) ||
+            !readAll(fd, result, sizeof(*result))) {
+            error = "fork server connection lost";
+            stop();
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    ForkServer::ForkServer() : _impl(new Impl()) {
+    }
+
+    ForkServer::~ForkServer() = default;
+
+    ForkServer::ForkServer(ForkServer &&other) noexcept {
+        std::swap(_impl, other._impl);
+    }
+
+    ForkServer &ForkServer::operator=(ForkServer &&other) noexcept {
+        if (this == &other)
+            return *this;
+        std::swap(_impl, other._impl);
+        return *this;
+    }
+
+    void ForkServer::addPlugin(const PathString &path, int hints) {
+        _impl->pluginList.push_back({path, hints});
+    }
+
+    void ForkServer::setWorkerMain(const WorkerMain &main) {
+        _impl->workerMain = main;
+    }
+
+    void ForkServer::setWarmUp(const WarmUp &warmUp) {
+        _impl->warmUp = warmUp;
+    }
+
+    bool ForkServer::start() {
+#ifdef _WIN32
+        _impl->error = "fork server is not supported on Windows";
+        return false;
+#else
+        if (_impl->fd >= 0) {
+            return true;
+        }
+
+        int sv[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+            _impl->error = strerror(errno);
+            return false;
+        }
+        ::fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+
+        // Don't let the zygote flush what the host has buffered
+        ::fflush(nullptr);
+        auto pid = ::fork();
+        if (pid < 0) {
+            _impl->error = strerror(errno);
+            ::close(sv[0]);
+            ::close(sv[1]);
+            return false;
+        }
+        if (pid == 0) {
+            ::close(sv[0]);
+            _impl->fd = sv[1];
+            _impl->zygoteMain(*this);
+        }
+
+        ::close(sv[1]);
+        _impl->fd = sv[0];
+        _impl->zygotePid = pid;
+
+        // Wait for preloading
+        int32_t ok;
+        std::string message;
+        if (!readMessage(_impl->fd, &ok, &message) || !ok) {
+            _impl->error = message.empty() ? "zygote exited unexpectedly" : message;
+            _impl->stop();
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    void ForkServer::stop() {
+        _impl->stop();
+    }
+
+    bool ForkServer::isRunning() const {
+        return _impl->fd >= 0 && _impl->zygotePid > 0;
+    }
+
+    int ForkServer::spawn(const std::string &arg) {
+        int32_t pid;
+        if (!_impl->request('S', 0, arg, &pid)) {
+            return -1;
+        }
+        if (pid < 0) {
+            _impl->error = "fork failed";
+        }
+        return pid;
+    }
+
+    int ForkServer::wait(int pid) {
+        int32_t status;
+        if (!_impl->request('W', pid, {}, &status)) {
+            return -1;
+        }
+        return status;
+    }
+
+    std::vector<PluginLoader> &ForkServer::plugins() {
+        return _impl->plugins;
+    }
+
+    PluginLoader *ForkServer::plugin(const PathString &path) {
+        for (auto &loader : _impl->plugins) {
+            if (loader.path() == path) {
+                return &loader;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string ForkServer::lastError() const {
+        return _impl->error;
+    }
+
+}
@@ -0,0 +1,39 @@
+#ifndef FORKSERVER_P_H
+#define FORKSERVER_P_H
+
+#include <mutex>
+
+#include "forkserver.h"
+
+namespace LoadSO {
+
+    class ForkServer::Impl {
+    public:
+        struct Plugin {
+            PathString path;
+            int hints;
+        };
+        std::vector<Plugin> pluginList;
+        std::vector<PluginLoader> plugins;
+
+        WorkerMain workerMain;
+        WarmUp warmUp;
+
+        int zygotePid = -1;
+        int fd = -1; // Socket to the zygote, or to the parent inside the zygote
+        std::string error;
+
+        std::mutex mutex; // Serializes requests
+
+        ~Impl();
+
+        void stop();
+
+        [[noreturn]] void zygoteMain(ForkServer &server);
+
+        bool request(char cmd, int32_t arg, const std::string &data, int32_t *result);
+    };
+
+}
+
+#endif // FORKSERVER_P_H
@@ -0,0 +1,126 @@
+#include "hugetext_p.h"
+
+#ifdef __linux__
+#  include <cstdint>
+#  include <cstring>
+#  include <fstream>
+#  include <string>
+#  include <vector>
+
+#  include <dlfcn.h>
+#  include <link.h>
+#  include <sys/mman.h>
+#endif
+
+namespace LoadSO {
+
+    namespace HugeTextPrivate {
+
+#ifdef __linux__
+        static const uintptr_t HugePageSize = uintptr_t(2) << 20;
+
+        static uintptr_t alignUp(uintptr_t addr) {
+            return (addr + HugePageSize - 1) & ~(HugePageSize - 1);
+        }
+
+        static uintptr_t alignDown(uintptr_t addr) {
+            return addr & ~(HugePageSize - 1);
+        }
+
+        static bool hugePagesEnabled() {
+            std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+            std::string mode;
+            std::getline(file, mode);
+            return !mode.empty() && mode.find("[never]") == std::string::npos;
+        }
+
+        struct Segment {
+            uintptr_t begin;
+            uintptr_t end;
+        };
+
+        struct SearchContext {
+            const link_map *map;
+            std::vector<Segment> segments;
+        };
+
+        static int findTextSegments(dl_phdr_info *info, size_t size, void *data) {
+            (void) size;
+            auto ctx = static_cast<SearchContext *>(data);
+            if (info->dlpi_addr != ctx->map->l_addr || !info->dlpi_name ||
+                strcmp(info->dlpi_name, ctx->map->l_name) != 0) {
+                return 0;
+            }
+            for (int i = 0; i < info->dlpi_phnum; ++i) {
+                const auto &phdr = info->dlpi_phdr[i];
+                // Execute-only segments cannot be copied
+                if (phdr.p_type == PT_LOAD && (phdr.p_flags & PF_X) && (phdr.p_flags & PF_R)) {
+                    const uintptr_t begin = info->dlpi_addr + phdr.p_vaddr;
+                    ctx->segments.push_back({begin, begin + phdr.p_memsz});
+                }
+            }
+            return 1;
+        }
+
+        static bool remapRange(uintptr_t begin, size_t len) {
+            // Build the copy in an aligned anonymous area, then move it over the text in one
+            // mremap, so that the code never disappears for threads running it
+            const size_t reserved = len + HugePageSize;
+            void *raw = mmap(nullptr, reserved, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (raw == MAP_FAILED) {
+                return false;
+            }
+            const uintptr_t rawBegin = reinterpret_cast<uintptr_t>(raw);
+            const uintptr_t aligned = alignUp(rawBegin);
+            if (aligned > rawBegin) {
+                munmap(raw, aligned - rawBegin);
+            }
+            if (rawBegin + reserved > aligned + len) {
+                munmap(reinterpret_cast<void *>(aligned + len), rawBegin + reserved - aligned - len);
+            }
+
+            auto copy = reinterpret_cast<void *>(aligned);
+            madvise(copy, len, MADV_HUGEPAGE);
+            memcpy(copy, reinterpret_cast<const void *>(begin), len);
+            if (mprotect(copy, len, PROT_READ | PROT_EXEC) != 0 ||
+                mremap(copy, len, len, MREMAP_MAYMOVE | MREMAP_FIXED,
+                       reinterpret_cast<void *>(begin)) == MAP_FAILED) {
+                munmap(copy, len);
+                return false;
+            }
+            return true;
+        }
+#endif
+
+        size_t remapText(void *handle) {
+#ifdef __linux__
+            link_map *map = nullptr;
+            if (!hugePagesEnabled() || dlinfo(handle, RTLD_DI_LINKMAP, &map) != 0 || !map) {
+                return 0;
+            }
+
+            SearchContext ctx;
+            ctx.map = map;
+            dl_iterate_phdr(findTextSegments, &ctx);
+
+            // Only whole huge pages inside a segment can be remapped, the unaligned head and tail
+            // stay on the file mapping
+            size_t total = 0;
+            for (const auto &segment : ctx.segments) {
+                const uintptr_t begin = alignUp(segment.begin);
+                const uintptr_t end = alignDown(segment.end);
+                if (end > begin && remapRange(begin, end - begin)) {
+                    total += end - begin;
+                }
+            }
+            return total;
+#else
+            (void) handle;
+            return 0;
+#endif
+        }
+
+    }
+
+}
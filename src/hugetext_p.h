@@ -0,0 +1,23 @@
+#ifndef HUGETEXT_P_H
+#define HUGETEXT_P_H
+
+#include <cstddef>
+
+namespace LoadSO {
+
+    namespace HugeTextPrivate {
+
+        /**
+         * @brief Moves the 2 MiB aligned part of the executable segments of a loaded library
+         *        onto anonymous memory that may be backed by transparent huge pages.
+         *
+         * @return Bytes remapped, \c 0 if nothing could be remapped, in which case the library
+         *         is left untouched
+         */
+        size_t remapText(void *handle);
+
+    }
+
+}
+
+#endif // HUGETEXT_P_H
@@ -0,0 +1,263 @@
+#include "iobatch_p.h"
+
+#ifndef _WIN32
+#  include <algorithm>
+#  include <cerrno>
+#  include <cstring>
+
+#  include <unistd.h>
+
+#  ifdef __linux__
+#    include <linux/io_uring.h>
+#    include <sched.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <sys/uio.h>
+#  endif
+#endif
+
+namespace LoadSO {
+
+#ifndef _WIN32
+    static void preadRequest(IoBatch::Request &req) {
+        size_t done = 0;
+        while (done < req.size) {
+            auto n = ::pread(req.fd, static_cast<char *>(req.buf) + done, req.size - done,
+                             static_cast<off_t>(req.offset + done));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                req.result = -errno;
+                return;
+            }
+            if (n == 0) {
+                break;
+            }
+            done += size_t(n);
+        }
+        req.result = static_cast<long long>(done);
+    }
+
+    class PreadBatch : public IoBatch {
+    public:
+        MetadataReader::IoBackend backend() const override {
+            return MetadataReader::PreadBackend;
+        }
+
+        void run(std::vector<Request> &requests) override {
+            for (auto &req : requests) {
+                preadRequest(req);
+            }
+        }
+    };
+
+#  if defined(__linux__) && defined(__NR_io_uring_setup)
+    /**
+     * @brief Minimal io_uring driver on the raw system calls, so that no liburing is needed.
+     */
+    class UringBatch : public IoBatch {
+    public:
+        ~UringBatch() override {
+            if (_sqes != MAP_FAILED) {
+                munmap(_sqes, _sqesSize);
+            }
+            if (_cqRing != MAP_FAILED && _cqRing != _sqRing) {
+                munmap(_cqRing, _cqRingSize);
+            }
+            if (_sqRing != MAP_FAILED) {
+                munmap(_sqRing, _sqRingSize);
+            }
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+        }
+
+        bool init(unsigned entries) {
+            io_uring_params params;
+            memset(&params, 0, sizeof(params));
+            _fd = int(syscall(__NR_io_uring_setup, entries, &params));
+            if (_fd < 0) {
+                return false;
+            }
+            _entries = params.sq_entries;
+
+            _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (singleMap) {
+                _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+            }
+
+            _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+            if (_sqRing == MAP_FAILED) {
+                return false;
+            }
+            _cqRing = singleMap ? _sqRing
+                                : mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+            if (_cqRing == MAP_FAILED) {
+                return false;
+            }
+            _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            _sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         _fd, IORING_OFF_SQES);
+            if (_sqes == MAP_FAILED) {
+                return false;
+            }
+
+            auto sq = static_cast<char *>(_sqRing);
+            _sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+            _sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            _sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            _sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+            auto cq = static_cast<char *>(_cqRing);
+            _cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            _cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            _cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            _cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        MetadataReader::IoBackend backend() const override {
+            return MetadataReader::IoUringBackend;
+        }
+
+        void run(std::vector<Request> &requests) override {
+            std::vector<iovec> iovecs(requests.size());
+            size_t next = 0, completed = 0;
+            unsigned inFlight = 0, unsubmitted = 0;
+
+            // Reads never submitted keep this and are redone with pread
+            for (auto &req : requests) {
+                req.result = -ECANCELED;
+            }
+
+            auto reap = [&]() {
+                unsigned cqHead = *_cqHead;
+                const unsigned cqTail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+                const unsigned count = cqTail - cqHead;
+                for (; cqHead != cqTail; ++cqHead) {
+                    const auto &cqe = _cqes[cqHead & _cqMask];
+                    if (cqe.user_data < requests.size()) {
+                        requests[size_t(cqe.user_data)].result = cqe.res;
+                    }
+                    completed++;
+                    inFlight--;
+                }
+                __atomic_store_n(_cqHead, cqHead, __ATOMIC_RELEASE);
+                return count;
+            };
+
+            while (completed < requests.size()) {
+                // Queue as many reads as the ring holds
+                unsigned tail = *_sqTail;
+                const unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+                while (next < requests.size() && inFlight < _entries &&
+                       tail - head < _entries) {
+                    auto &req = requests[next];
+                    iovecs[next].iov_base = req.buf;
+                    iovecs[next].iov_len = req.size;
+
+                    const unsigned index = tail & _sqMask;
+                    auto sqe = static_cast<io_uring_sqe *>(_sqes) + index;
+                    memset(sqe, 0, sizeof(*sqe));
+                    sqe->opcode = IORING_OP_READV;
+                    sqe->fd = req.fd;
+                    sqe->off = req.offset;
+                    sqe->addr = reinterpret_cast<uint64_t>(&iovecs[next]);
+                    sqe->len = 1;
+                    sqe->user_data = next;
+                    _sqArray[index] = index;
+
+                    tail++;
+                    next++;
+                    inFlight++;
+                    unsubmitted++;
+                }
+                __atomic_store_n(_sqTail, tail, __ATOMIC_RELEASE);
+
+                auto ret = syscall(__NR_io_uring_enter, _fd, unsubmitted, 1,
+                                   IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (ret < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EBUSY) {
+                        // Take back the reads the kernel has not consumed, without SQPOLL it
+                        // only reads the ring inside io_uring_enter()
+                        const unsigned consumed = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+                        __atomic_store_n(_sqTail, consumed, __ATOMIC_RELEASE);
+                        inFlight -= unsubmitted;
+                        unsubmitted = 0;
+                        break;
+                    }
+                    // Short of resources, free completion slots and try again
+                    if (reap() == 0) {
+                        sched_yield();
+                    }
+                    continue;
+                }
+                unsubmitted -= unsigned(ret);
+                reap();
+            }
+
+            // The kernel writes into the buffers and the iovecs until every submitted read
+            // completes, and stale completions would be taken for the next batch's
+            while (inFlight > 0) {
+                if (reap() == 0 &&
+                    syscall(__NR_io_uring_enter, _fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr,
+                            0) < 0) {
+                    sched_yield();
+                }
+            }
+
+            // Failed or short reads (e.g. READV unsupported or interrupted) are redone with pread
+            for (auto &req : requests) {
+                if (req.result < 0 || size_t(req.result) < req.size) {
+                    preadRequest(req);
+                }
+            }
+        }
+
+    private:
+        int _fd = -1;
+        unsigned _entries = 0;
+
+        void *_sqRing = MAP_FAILED;
+        void *_cqRing = MAP_FAILED;
+        void *_sqes = MAP_FAILED;
+        size_t _sqRingSize = 0;
+        size_t _cqRingSize = 0;
+        size_t _sqesSize = 0;
+
+        unsigned *_sqHead = nullptr;
+        unsigned *_sqTail = nullptr;
+        unsigned *_sqArray = nullptr;
+        unsigned _sqMask = 0;
+
+        unsigned *_cqHead = nullptr;
+        unsigned *_cqTail = nullptr;
+        io_uring_cqe *_cqes = nullptr;
+        unsigned _cqMask = 0;
+    };
+#  endif
+
+    std::unique_ptr<IoBatch> IoBatch::create(MetadataReader::IoBackend backend) {
+#  if defined(__linux__) && defined(__NR_io_uring_setup)
+        if (backend != MetadataReader::PreadBackend) {
+            std::unique_ptr<UringBatch> uring(new UringBatch());
+            if (uring->init(256)) {
+                return std::unique_ptr<IoBatch>(uring.release());
+            }
+        }
+#  else
+        (void) backend;
+#  endif
+        return std::unique_ptr<IoBatch>(new PreadBatch());
+    }
+#endif
+
+}
@@ -0,0 +1,42 @@
+#ifndef IOBATCH_P_H
+#define IOBATCH_P_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "metadatareader.h"
+
+namespace LoadSO {
+
+#ifndef _WIN32
+    /**
+     * @brief Executes a set of independent positional reads, all in flight at once when the
+     *        backend allows it.
+     */
+    class IoBatch {
+    public:
+        struct Request {
+            int fd;
+            uint64_t offset;
+            void *buf;
+            size_t size;
+            long long result; // Bytes read or -errno
+        };
+
+        virtual ~IoBatch() = default;
+
+        virtual MetadataReader::IoBackend backend() const = 0;
+        virtual void run(std::vector<Request> &requests) = 0;
+
+        /**
+         * @brief Creates a backend, \c AutoBackend tries io_uring first and falls back to
+         *        \c pread.
+         */
+        static std::unique_ptr<IoBatch> create(MetadataReader::IoBackend backend);
+    };
+#endif
+
+}
+
+#endif // IOBATCH_P_H
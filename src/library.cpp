@@ -1,8 +1,17 @@
 #include "library.h"
 #include "library_p.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <tuple>
 
+#include "callprofiler_p.h"
+#include "hugetext_p.h"
+#include "loadprofile_p.h"
+#include "samplingprofiler_p.h"
 #include "system.h"
 
 #ifdef _WIN32
@@ -13,8 +22,22 @@
 #  include <dlfcn.h>
 #  include <limits.h>
 #  include <string.h>
+#  ifdef __linux__
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <linux/memfd.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#  endif
+#endif
+
+#if defined(__GLIBC__) && defined(LM_ID_NEWLM)
+#  define LOADSO_DLMOPEN
 #endif
 
+#define LOADSO_FUNCTION_TABLE_PREFIX "loadso_functions_"
+#define LOADSO_FUNCTION_TABLE_MAGIC  0x5446534C // "LSFT"
+
 namespace LoadSO {
 
 #ifdef _WIN32
@@ -50,7 +73,13 @@ namespace LoadSO {
 
 #endif
 
+    static std::atomic<bool> g_FastExit(false);
+
     Library::Impl::~Impl() {
+        if (g_FastExit && !cleanupRequired) {
+            // Leave the library to the OS
+            return;
+        }
         std::ignore = close();
     }
 
@@ -80,34 +109,179 @@ namespace LoadSO {
 #endif
     }
 
-    PathString Library::Impl::sysErrorMessage(bool nativeLanguage) {
+#ifndef _WIN32
+    // Every isolated load creates a linker namespace of its own, with its own copy of the
+    // library, its dependencies and their global state
+    void *Library::Impl::loadLibrary(const char *path, int hints) {
+#  ifdef LOADSO_DLMOPEN
+        if (hints & IsolatedNamespaceHint) {
+            return dlmopen(LM_ID_NEWLM, path, nativeLoadHints(hints));
+        }
+#  endif
+        return dlopen(path, nativeLoadHints(hints));
+    }
+#endif
+
+    bool Library::Impl::checkHints(int hints) const {
+#ifndef LOADSO_DLMOPEN
+        if (hints & IsolatedNamespaceHint) {
+#  ifdef _WIN32
+            setError(OpenError, "linker namespaces are not supported on this platform",
+                     ERROR_NOT_SUPPORTED);
+#  else
+            setError(OpenError, "linker namespaces are not supported on this platform");
+#  endif
+            return false;
+        }
+#else
+        (void) hints;
+#endif
+        return true;
+    }
+
+    Library::Impl::ThreadError &Library::Impl::threadError() {
+        static thread_local ThreadError error;
+        return error;
+    }
+
+    void Library::Impl::setError(int code, const char *text, uint32_t nativeCode) const {
+        errorCode.store(code, std::memory_order_relaxed);
+        auto &error = threadError();
+        error.owner = this;
+        error.code = code;
+        error.nativeCode = nativeCode;
+        if (!text) {
+            error.text[0] = '\0';
+            return;
+        }
+        auto len = std::min(strlen(text), sizeof(error.text) - 1);
+        memcpy(error.text, text, len);
+        error.text[len] = '\0';
+    }
+
+    uint32_t Library::Impl::nativeErrorCode() const {
+        const auto &error = threadError();
+        return error.owner == this && error.code == errorCode ? error.nativeCode : 0;
+    }
+
+    void Library::Impl::captureSysError(int code) const {
+#ifdef _WIN32
+        setError(code, nullptr, ::GetLastError());
+#else
+        // Take the message now, dlerror() is overwritten by the next dl* call of this thread
+        setError(code, dlerror());
+#endif
+    }
+
+    PathString Library::Impl::errorMessage(bool nativeLanguage) const {
+        const int code = errorCode;
+        const auto &error = threadError();
+        if (code != NoError && code != NotOpenError &&
+            (error.owner != this || error.code != code)) {
+            // Failed on another thread, whose text stays there
+            static const char *const messages[] = {
+                "", "", "failed to load library", "failed to unload library",
+                "undefined symbol", "plugin interface mismatch", "integrity check failed",
+            };
+            return System::MultiToPathString(messages[code]);
+        }
+
+        switch (code) {
+            case NoError:
+                return {};
+            case NotOpenError:
+                return LOADSO_STR("library is not loaded");
+            case IncompatibleError:
+            case IntegrityError:
+                return System::MultiToPathString(error.text);
+            default:
+                break;
+        }
 #ifdef _WIN32
-        return winErrorMessage(::GetLastError(), nativeLanguage);
+        return winErrorMessage(error.nativeCode, nativeLanguage);
 #else
-        auto err = dlerror();
-        if (err) {
-            return err;
+        (void) nativeLanguage;
+        if (code == SymbolNotFoundError) {
+            return path + ": undefined symbol: " + error.text;
         }
-        return {};
+        return error.text;
 #endif
     }
 
-    bool Library::Impl::open(int hints) {
-        PathString absPath;
+    bool Library::Impl::verify(const PathString &absPath, FileDigestPrivate::FileKey *key) const {
+        std::string digest;
+        if (!FileDigestPrivate::hashFile(absPath, &digest, key)) {
+            setError(IntegrityError, "failed to hash the library file");
+            return false;
+        }
+        if (std::find(allowedDigests.begin(), allowedDigests.end(), digest) ==
+            allowedDigests.end()) {
+            setError(IntegrityError, ("digest " + digest + " is not allowed").data());
+            return false;
+        }
+        return true;
+    }
+
+    PathString Library::Impl::absolutePath(const PathString &path) {
         if (System::IsRelativePath(path)) {
-            absPath = System::ApplicationDirectory() + PathSeparator + path;
-        } else {
-            absPath = path;
+            return System::ApplicationDirectory() + PathSeparator + path;
+        }
+        return path;
+    }
+
+    bool Library::Impl::open(int hints) {
+        const PathString absPath = absolutePath(path);
+
+        if (!checkHints(hints)) {
+            return false;
+        }
+
+        FileDigestPrivate::FileKey verifiedKey;
+        if (!allowedDigests.empty() && !verify(absPath, &verifiedKey)) {
+            return false;
         }
 
+#ifndef _WIN32
+        // A library loaded elsewhere may be running its code, leave its mappings alone. An
+        // isolated copy is always fresh.
+        bool moveText = false;
+        if ((hints & HugePageTextHint) && (hints & IsolatedNamespaceHint)) {
+            moveText = true;
+        } else if (hints & HugePageTextHint) {
+            auto loaded = dlopen(absPath.data(), RTLD_LAZY | RTLD_NOLOAD);
+            if (loaded) {
+                dlclose(loaded);
+            } else {
+                moveText = true;
+            }
+        }
+#endif
+
+        const bool record = LoadProfilePrivate::isRecording();
+        const auto loadStart = record ? std::chrono::steady_clock::now()
+                                      : std::chrono::steady_clock::time_point();
         auto handle =
 #ifdef _WIN32
             ::LoadLibraryW(absPath.data())
 #else
-            dlopen(absPath.data(), Impl::nativeLoadHints(hints))
+            loadLibrary(absPath.data(), hints)
 #endif
             ;
         if (!handle) {
+            captureSysError(OpenError);
+            return false;
+        }
+
+        // The file must not have been replaced between hashing and loading
+        FileDigestPrivate::FileKey loadedKey;
+        if (!allowedDigests.empty() &&
+            (!FileDigestPrivate::statFile(absPath, &loadedKey) || loadedKey != verifiedKey)) {
+#ifdef _WIN32
+            ::FreeLibrary(reinterpret_cast<HMODULE>(handle));
+#else
+            dlclose(handle);
+#endif
+            setError(IntegrityError, "library file changed while loading");
             return false;
         }
 
@@ -121,8 +295,89 @@ namespace LoadSO {
         }
 #endif
 
+#ifndef _WIN32
+        hugePageTextSize = moveText ? HugeTextPrivate::remapText(handle) : 0;
+#endif
+
+        hDll = handle;
+        profileCalls = (hints & ProfileCallsHint) != 0;
+        SamplingProfilerPrivate::librariesChanged();
+        if (record) {
+            LoadProfilePrivate::recordOpen(absPath, std::chrono::steady_clock::now() - loadStart);
+        }
+        return true;
+    }
+
+    bool Library::Impl::openMemory(const void *data, size_t size, const char *name, int hints) {
+        if (!checkHints(hints)) {
+            return false;
+        }
+
+        if (!allowedDigests.empty()) {
+            const auto digest = FileDigest::Hash(data, size);
+            if (std::find(allowedDigests.begin(), allowedDigests.end(), digest) ==
+                allowedDigests.end()) {
+                setError(IntegrityError, ("digest " + digest + " is not allowed").data());
+                return false;
+            }
+        }
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+        int fd = int(syscall(SYS_memfd_create, name && *name ? name : "loadso",
+                             MFD_CLOEXEC | MFD_ALLOW_SEALING));
+        if (fd < 0) {
+            setError(OpenError, strerror(errno));
+            return false;
+        }
+        auto p = static_cast<const char *>(data);
+        for (size_t written = 0; written < size;) {
+            auto n = ::write(fd, p + written, size - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                setError(OpenError, strerror(n < 0 ? errno : EIO));
+                ::close(fd);
+                return false;
+            }
+            written += size_t(n);
+        }
+#  ifdef F_ADD_SEALS
+        // Nobody may alter the image once it is loaded
+        std::ignore =
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#  endif
+
+        // The descriptor stays open while the library is loaded: glibc identifies libraries by
+        // name, a reused descriptor number would alias another image
+        const std::string fdPath = "/proc/self/fd/" + std::to_string(fd);
+        auto handle = loadLibrary(fdPath.data(), hints);
+        if (!handle) {
+            captureSysError(OpenError);
+            ::close(fd);
+            return false;
+        }
+
+        // A fresh image cannot be loaded elsewhere
+        hugePageTextSize = (hints & HugePageTextHint) ? HugeTextPrivate::remapText(handle) : 0;
+
         hDll = handle;
+        profileCalls = (hints & ProfileCallsHint) != 0;
+        memoryFd = fd;
+        path = fdPath;
+        SamplingProfilerPrivate::librariesChanged();
         return true;
+#else
+        (void) name;
+        (void) hints;
+#  ifdef _WIN32
+        setError(OpenError, "loading from memory is not supported on this platform",
+                 ERROR_NOT_SUPPORTED);
+#  else
+        setError(OpenError, "loading from memory is not supported on this platform");
+#  endif
+        return false;
+#endif
     }
 
     bool Library::Impl::close() {
@@ -137,15 +392,29 @@ namespace LoadSO {
             (dlclose(hDll) == 0)
 #endif
         ) {
+            captureSysError(CloseError);
             return false;
         }
 
         hDll = nullptr;
+        hugePageTextSize = 0;
+        profileCalls = false;
+#ifdef __linux__
+        if (memoryFd >= 0) {
+            ::close(memoryFd);
+            memoryFd = -1;
+        }
+#endif
+        SamplingProfilerPrivate::librariesChanged();
+
+        std::lock_guard<std::mutex> lock(symbolCacheMutex);
+        symbolCache.clear();
         return true;
     }
 
     void *Library::Impl::resolve(const char *name) const {
         if (!hDll) {
+            setError(NotOpenError);
             return nullptr;
         }
 
@@ -156,9 +425,108 @@ namespace LoadSO {
             dlsym(hDll, name)
 #endif
             ;
+        if (!addr) {
+#ifdef _WIN32
+            setError(SymbolNotFoundError, name, ::GetLastError());
+#else
+            // Clear the thread's dlerror state, the message is formatted on request
+            std::ignore = dlerror();
+            setError(SymbolNotFoundError, name);
+#endif
+        }
         return reinterpret_cast<void *>(addr);
     }
 
+    void *Library::Impl::resolve(const char *name, size_t size) const {
+        char buf[256];
+        if (size < sizeof(buf)) {
+            memcpy(buf, name, size);
+            buf[size] = '\0';
+            return resolve(buf);
+        }
+        return resolve(std::string(name, size).data());
+    }
+
+    void *Library::Impl::resolve(const SymbolName &name) const {
+        if (!hDll) {
+            setError(NotOpenError);
+            return nullptr;
+        }
+
+        auto sameName = [&name](const std::string &cached) {
+            return cached.size() == name.size() &&
+                   memcmp(cached.data(), name.data(), name.size()) == 0;
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(symbolCacheMutex);
+            auto it = symbolCache.find(name.hashValue());
+            if (it != symbolCache.end() && sameName(it->second.name)) {
+                auto addr = it->second.addr;
+                if (!addr) {
+#ifdef _WIN32
+                    setError(SymbolNotFoundError, it->second.name.data(), ERROR_PROC_NOT_FOUND);
+#else
+                    setError(SymbolNotFoundError, it->second.name.data());
+#endif
+                }
+                return addr;
+            }
+        }
+
+        auto addr = name.isNullTerminated() ? resolve(name.data())
+                                            : resolve(name.data(), name.size());
+
+        std::lock_guard<std::mutex> lock(symbolCacheMutex);
+        if (symbolCache.find(name.hashValue()) == symbolCache.end()) {
+            symbolCache.emplace(name.hashValue(),
+                                SymbolCacheEntry{std::string(name.data(), name.size()), addr});
+        }
+        return addr;
+    }
+
+    void *Library::Impl::profiled(void *addr, const char *name, size_t size) const {
+        if (!profileCalls) {
+            return addr;
+        }
+        return CallProfilerPrivate::wrap(addr, path, name, size);
+    }
+
+    // Header of the tables written by loadso_export_functions(), followed by the functions
+    struct FunctionTableHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        uint32_t reserved;
+        uint64_t hash;
+    };
+
+    void *const *Library::Impl::functionTable(const char *name, uint32_t version, size_t count,
+                                              uint64_t hash) const {
+        const std::string symbol = LOADSO_FUNCTION_TABLE_PREFIX + std::string(name);
+        auto header = static_cast<const FunctionTableHeader *>(resolve(symbol.data()));
+        if (!header) {
+            return nullptr;
+        }
+
+        char buf[256];
+        if (header->magic != LOADSO_FUNCTION_TABLE_MAGIC) {
+            snprintf(buf, sizeof(buf), "%s is not a function table", symbol.data());
+        } else if (header->version != version) {
+            snprintf(buf, sizeof(buf), "function table %s has version %u, expected %u", name,
+                     unsigned(header->version), unsigned(version));
+        } else if (header->count < count) {
+            snprintf(buf, sizeof(buf), "function table %s has %u functions, expected %zu", name,
+                     unsigned(header->count), count);
+        } else if (hash != 0 && header->hash != hash) {
+            snprintf(buf, sizeof(buf), "function table %s has another function list", name);
+        } else {
+            return reinterpret_cast<void *const *>(header + 1);
+        }
+        setError(IncompatibleError, buf);
+        return nullptr;
+    }
+
     Library::Library() : _impl(new Impl()) {
     }
 
@@ -184,6 +552,26 @@ namespace LoadSO {
         return false;
     }
 
+    void Library::setAllowedDigests(const std::vector<std::string> &digests) {
+        _impl->allowedDigests = digests;
+    }
+
+    const std::vector<std::string> &Library::allowedDigests() const {
+        return _impl->allowedDigests;
+    }
+
+    bool Library::openFromMemory(const void *data, size_t size, int hints, const char *name) {
+        // The handle and the descriptor of a loaded library would be overwritten
+        if (!_impl->close()) {
+            return false;
+        }
+        if (_impl->openMemory(data, size, name, hints)) {
+            return true;
+        }
+        _impl->path.clear();
+        return false;
+    }
+
     bool Library::close() {
         if (_impl->close()) {
             _impl->path.clear();
@@ -192,6 +580,22 @@ namespace LoadSO {
         return false;
     }
 
+    void Library::SetFastExit(bool on) {
+        g_FastExit = on;
+    }
+
+    bool Library::IsFastExit() {
+        return g_FastExit;
+    }
+
+    void Library::setCleanupRequired(bool required) {
+        _impl->cleanupRequired = required;
+    }
+
+    bool Library::isCleanupRequired() const {
+        return _impl->cleanupRequired;
+    }
+
     bool Library::isOpen() const {
         return _impl->hDll != nullptr;
     }
@@ -200,16 +604,61 @@ namespace LoadSO {
         return _impl->path;
     }
 
+    size_t Library::hugePageTextSize() const {
+        return _impl->hugePageTextSize;
+    }
+
     LibraryHandle Library::handle() const {
         return _impl->hDll;
     }
 
     EntryHandle Library::resolve(const char *name) const {
-        return _impl->resolve(name);
+        auto addr = _impl->resolve(name);
+
+        // Probing optional symbols is common, measure the name only when someone listens
+        const bool recording = LoadProfilePrivate::isRecording();
+        if (!recording && !_impl->profileCalls) {
+            return addr;
+        }
+        const size_t size = strlen(name);
+        if (recording) {
+            LoadProfilePrivate::recordUse(_impl->path, name, size);
+        }
+        return _impl->profiled(addr, name, size);
+    }
+
+    EntryHandle Library::resolve(const char *name, size_t size) const {
+        if (LoadProfilePrivate::isRecording()) {
+            LoadProfilePrivate::recordUse(_impl->path, name, size);
+        }
+        return _impl->profiled(_impl->resolve(name, size), name, size);
+    }
+
+    EntryHandle Library::resolve(const SymbolName &name) const {
+        if (LoadProfilePrivate::isRecording()) {
+            LoadProfilePrivate::recordUse(_impl->path, name.data(), name.size());
+        }
+        return _impl->profiled(_impl->resolve(name), name.data(), name.size());
+    }
+
+    const EntryHandle *Library::functionTable(const char *name, uint32_t version, size_t count,
+                                              uint64_t hash) const {
+        if (LoadProfilePrivate::isRecording()) {
+            LoadProfilePrivate::recordUse(_impl->path, name, strlen(name));
+        }
+        return _impl->functionTable(name, version, count, hash);
+    }
+
+    Library::ErrorCode Library::errorCode() const {
+        return static_cast<ErrorCode>(_impl->errorCode.load());
+    }
+
+    uint32_t Library::nativeErrorCode() const {
+        return _impl->nativeErrorCode();
     }
 
     std::string Library::lastError(bool nativeLanguage) const {
-        return System::MultiFromPathString(_impl->sysErrorMessage(nativeLanguage));
+        return System::MultiFromPathString(_impl->errorMessage(nativeLanguage));
     }
 
 }
\ No newline at end of file
@@ -1,23 +1,73 @@
 #ifndef LIBRARY_P_H
 #define LIBRARY_P_H
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
 #include <loadso/library.h>
 
+#include "filedigest_p.h"
+
 namespace LoadSO {
 
     class Library::Impl {
     public:
         void *hDll = nullptr;
         PathString path;
+        std::vector<std::string> allowedDigests;
+        size_t hugePageTextSize = 0;
+        bool cleanupRequired = false;
+        bool profileCalls = false;
+        int memoryFd = -1; // memfd backing a library loaded from memory
+
+        // Code of the last failure. Its native code and text are kept per thread like
+        // dlerror(), so that concurrent resolves don't race on them, and formatted on request.
+        mutable std::atomic<int> errorCode{NoError};
+
+        struct ThreadError {
+            const Impl *owner = nullptr;
+            int code = NoError;
+            uint32_t nativeCode = 0;
+            char text[256] = {};
+        };
+        static ThreadError &threadError();
+
+        struct SymbolCacheEntry {
+            std::string name;
+            void *addr;
+        };
+        mutable std::mutex symbolCacheMutex;
+        mutable std::unordered_map<uint64_t, SymbolCacheEntry> symbolCache;
 
         virtual ~Impl();
 
         static int nativeLoadHints(int loadHints);
-        static PathString sysErrorMessage(bool nativeLanguage);
 
+        // Relative paths are evaluated against the executable directory
+        static PathString absolutePath(const PathString &path);
+#ifndef _WIN32
+        static void *loadLibrary(const char *path, int hints);
+#endif
+
+        // Fails with OpenError if a hint can't be honored on this platform
+        bool checkHints(int hints) const;
+
+        void setError(int code, const char *text = nullptr, uint32_t nativeCode = 0) const;
+        void captureSysError(int code) const;
+        PathString errorMessage(bool nativeLanguage) const;
+        uint32_t nativeErrorCode() const;
+
+        bool verify(const PathString &absPath, FileDigestPrivate::FileKey *key) const;
         bool open(int hints = 0);
+        bool openMemory(const void *data, size_t size, const char *name, int hints);
         bool close();
         void *resolve(const char *name) const;
+        void *resolve(const char *name, size_t size) const;
+        void *resolve(const SymbolName &name) const;
+        void *profiled(void *addr, const char *name, size_t size) const;
+        void *const *functionTable(const char *name, uint32_t version, size_t count,
+                                   uint64_t hash) const;
     };
 
 }
@@ -0,0 +1,225 @@
+#include "loadcostanalyzer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "metadatareader_p.h"
+
+namespace LoadSO {
+
+    using namespace MetadataReaderPrivate;
+
+    static constexpr const uint32_t ELF_SHT_RELA = 4;
+    static constexpr const uint32_t ELF_SHT_DYNAMIC = 6;
+    static constexpr const uint32_t ELF_SHT_REL = 9;
+    static constexpr const uint32_t ELF_SHT_DYNSYM = 11;
+    static constexpr const uint32_t ELF_SHT_RELR = 19;
+    static constexpr const uint64_t ELF_SHF_ALLOC = 0x2;
+
+    static constexpr const uint64_t ELF_DT_NEEDED = 1;
+    static constexpr const uint64_t ELF_DT_INIT = 12;
+    static constexpr const uint64_t ELF_DT_FINI = 13;
+    static constexpr const uint64_t ELF_DT_SYMBOLIC = 16;
+    static constexpr const uint64_t ELF_DT_TEXTREL = 22;
+    static constexpr const uint64_t ELF_DT_BIND_NOW = 24;
+    static constexpr const uint64_t ELF_DT_INIT_ARRAYSZ = 27;
+    static constexpr const uint64_t ELF_DT_FINI_ARRAYSZ = 28;
+    static constexpr const uint64_t ELF_DT_FLAGS = 30;
+    static constexpr const uint64_t ELF_DT_FLAGS_1 = 0x6FFFFFFB;
+
+    static constexpr const uint64_t ELF_DF_SYMBOLIC = 0x2;
+    static constexpr const uint64_t ELF_DF_TEXTREL = 0x4;
+    static constexpr const uint64_t ELF_DF_BIND_NOW = 0x8;
+    static constexpr const uint64_t ELF_DF_1_NOW = 0x1;
+
+    static bool endsWith(const std::string &s, const char *suffix) {
+        const size_t n = strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    static bool analyzeELF(DataSource &src, LoadCostAnalyzer::Report *report) {
+        ElfInfo info;
+        if (!parseELF(src, &info)) {
+            return false;
+        }
+        const bool be = info.bigEndian;
+        const size_t word = info.is64 ? 8 : 4;
+        *report = {};
+
+        // Dynamic section
+        for (const auto &sec : info.sections) {
+            if (sec.type != ELF_SHT_DYNAMIC) {
+                continue;
+            }
+            std::string data;
+            if (!src.readString(sec.offset, sec.size, &data)) {
+                return false;
+            }
+            auto p = reinterpret_cast<const unsigned char *>(data.data());
+            for (size_t off = 0; off + 2 * word <= data.size(); off += 2 * word) {
+                const uint64_t tag = info.is64 ? get64(p + off, be) : get32(p + off, be);
+                const uint64_t val = info.is64 ? get64(p + off + 8, be) : get32(p + off + 4, be);
+                if (tag == 0) {
+                    break;
+                }
+                switch (tag) {
+                    case ELF_DT_NEEDED:
+                        report->neededLibraries++;
+                        break;
+                    case ELF_DT_INIT:
+                        report->constructors++;
+                        break;
+                    case ELF_DT_FINI:
+                        report->destructors++;
+                        break;
+                    case ELF_DT_INIT_ARRAYSZ:
+                        report->constructors += val / word;
+                        break;
+                    case ELF_DT_FINI_ARRAYSZ:
+                        report->destructors += val / word;
+                        break;
+                    case ELF_DT_SYMBOLIC:
+                        report->symbolic = true;
+                        break;
+                    case ELF_DT_TEXTREL:
+                        report->textRelocations = true;
+                        break;
+                    case ELF_DT_BIND_NOW:
+                        report->bindNow = true;
+                        break;
+                    case ELF_DT_FLAGS:
+                        report->symbolic |= (val & ELF_DF_SYMBOLIC) != 0;
+                        report->textRelocations |= (val & ELF_DF_TEXTREL) != 0;
+                        report->bindNow |= (val & ELF_DF_BIND_NOW) != 0;
+                        break;
+                    case ELF_DT_FLAGS_1:
+                        report->bindNow |= (val & ELF_DF_1_NOW) != 0;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        // Dynamic symbols: whether a reference must be looked up in the global scope
+        std::vector<bool> globalScope;
+        for (const auto &sec : info.sections) {
+            if (sec.type != ELF_SHT_DYNSYM) {
+                continue;
+            }
+            std::string data;
+            if (!src.readString(sec.offset, sec.size, &data)) {
+                return false;
+            }
+            auto p = reinterpret_cast<const unsigned char *>(data.data());
+            const size_t entSize = info.is64 ? 24 : 16;
+            globalScope.resize(data.size() / entSize);
+            for (size_t i = 1; i < globalScope.size(); ++i) {
+                const size_t off = i * entSize;
+                const unsigned char stInfo = p[off + (info.is64 ? 4 : 12)];
+                const unsigned char stOther = p[off + (info.is64 ? 5 : 13)];
+                const uint16_t shndx = get16(p + off + (info.is64 ? 6 : 14), be);
+                const int bind = stInfo >> 4, vis = stOther & 0x3;
+                const bool interposable =
+                    (bind == 1 || bind == 2) && vis == 0 && !report->symbolic;
+                globalScope[i] = shndx == 0 || interposable;
+                if (shndx != 0 && (bind == 1 || bind == 2) && (vis == 0 || vis == 3)) {
+                    report->exportedSymbols++;
+                }
+            }
+        }
+
+        // Relocation sections
+        for (const auto &sec : info.sections) {
+            if (!(sec.flags & ELF_SHF_ALLOC)) {
+                continue;
+            }
+            if (sec.type == ELF_SHT_RELR) {
+                // Packed relative relocations: an address, then bitmaps of 63 (or 31) words
+                std::string data;
+                if (!src.readString(sec.offset, sec.size, &data)) {
+                    return false;
+                }
+                auto p = reinterpret_cast<const unsigned char *>(data.data());
+                for (size_t off = 0; off + word <= data.size(); off += word) {
+                    uint64_t entry = info.is64 ? get64(p + off, be) : get32(p + off, be);
+                    uint64_t count = 1;
+                    if (entry & 1) {
+                        count = 0;
+                        for (entry >>= 1; entry; entry &= entry - 1) {
+                            count++;
+                        }
+                    }
+                    report->relocations += count;
+                    report->relativeRelocations += count;
+                }
+                continue;
+            }
+            if (sec.type != ELF_SHT_REL && sec.type != ELF_SHT_RELA) {
+                continue;
+            }
+
+            const bool rela = sec.type == ELF_SHT_RELA;
+            const bool plt = endsWith(sec.name, ".plt");
+            const size_t entSize = (rela ? 3 : 2) * word;
+            std::string data;
+            if (!src.readString(sec.offset, sec.size, &data)) {
+                return false;
+            }
+            auto p = reinterpret_cast<const unsigned char *>(data.data());
+            for (size_t off = 0; off + entSize <= data.size(); off += entSize) {
+                const uint64_t rInfo =
+                    info.is64 ? get64(p + off + 8, be) : get32(p + off + 4, be);
+                const uint64_t sym = info.is64 ? rInfo >> 32 : rInfo >> 8;
+
+                report->relocations++;
+                if (plt) {
+                    report->pltRelocations++;
+                }
+                if (sym == 0) {
+                    report->relativeRelocations++;
+                    continue;
+                }
+                report->symbolicRelocations++;
+                if (sym >= globalScope.size() || globalScope[sym]) {
+                    report->globalScopeRelocations++;
+                }
+            }
+        }
+        return true;
+    }
+
+    uint64_t LoadCostAnalyzer::Report::score(bool eagerBinding) const {
+        uint64_t lookups = globalScopeRelocations;
+        if (!eagerBinding && !bindNow) {
+            // PLT slots are bound on first call instead
+            lookups -= std::min(lookups, pltRelocations);
+        }
+        return relocations + 19 * lookups + 1000 * constructors;
+    }
+
+    bool LoadCostAnalyzer::Analyze(const void *data, size_t size, Report *report) {
+        BufferSource src(data, size);
+        return analyzeELF(src, report);
+    }
+
+    bool LoadCostAnalyzer::AnalyzeFile(const PathString &path, Report *report) {
+        FileSource src(path);
+        if (!src.isOpen()) {
+            return false;
+        }
+        return analyzeELF(src, report);
+    }
+
+    std::vector<size_t> LoadCostAnalyzer::Rank(const std::vector<Report> &reports,
+                                               bool eagerBinding) {
+        std::vector<size_t> indexes(reports.size());
+        std::iota(indexes.begin(), indexes.end(), 0);
+        std::stable_sort(indexes.begin(), indexes.end(), [&](size_t a, size_t b) {
+            return reports[a].score(eagerBinding) > reports[b].score(eagerBinding);
+        });
+        return indexes;
+    }
+
+}
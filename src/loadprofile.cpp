@@ -0,0 +1,344 @@
+#include "loadprofile.h"
+#include "loadprofile_p.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include "system.h"
+
+#define LOADSO_PROFILE_MAGIC   "LSOPROF"
+#define LOADSO_PROFILE_VERSION 1
+
+namespace LoadSO {
+
+    // Bounds the symbols kept per library, a library resolving more is used anyway
+    static constexpr const size_t MaxSymbols = 1024;
+
+    struct Record {
+        LoadProfile::Entry entry;
+        std::unordered_set<std::string> symbolSet;
+    };
+
+    static std::mutex g_Mutex;
+    static std::map<PathString, Record> g_Records;
+    static std::chrono::steady_clock::time_point g_Start;
+    static std::chrono::steady_clock::time_point g_Deadline;
+
+    static PathString absolutePath(const PathString &path) {
+        if (System::IsRelativePath(path)) {
+            return System::ApplicationDirectory() + PathSeparator + path;
+        }
+        return path;
+    }
+
+    // Caller holds g_Mutex, returns the time since the start or false if the window has passed
+    static bool elapsedUs(uint64_t *us) {
+        const auto now = std::chrono::steady_clock::now();
+        if (!LoadProfilePrivate::isRecording() || now > g_Deadline) {
+            LoadProfilePrivate::g_Recording = false;
+            return false;
+        }
+        *us = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(now - g_Start)
+                           .count());
+        return true;
+    }
+
+    namespace LoadProfilePrivate {
+
+        std::atomic<bool> g_Recording(false);
+
+        void recordOpen(const PathString &path, std::chrono::nanoseconds loadTime) {
+            std::lock_guard<std::mutex> lock(g_Mutex);
+            uint64_t now;
+            if (!elapsedUs(&now)) {
+                return;
+            }
+            // A library opened again keeps its first record
+            auto &record = g_Records[path];
+            auto &entry = record.entry;
+            if (entry.path.empty()) {
+                entry.path = System::MultiFromPathString(path);
+                entry.openedUs = now;
+                entry.loadUs = uint64_t(loadTime.count() / 1000);
+            }
+        }
+
+        void recordUse(const PathString &path, const char *symbol, size_t size) {
+            const auto absPath = absolutePath(path);
+            std::lock_guard<std::mutex> lock(g_Mutex);
+            uint64_t now;
+            if (!elapsedUs(&now)) {
+                return;
+            }
+            auto it = g_Records.find(absPath);
+            if (it == g_Records.end()) {
+                return;
+            }
+            auto &record = it->second;
+            if (!record.entry.isUsed()) {
+                record.entry.firstUseUs = now;
+            }
+            if (symbol && record.symbolSet.size() < MaxSymbols) {
+                std::string name(symbol, size);
+                if (record.symbolSet.insert(name).second) {
+                    record.entry.symbols.push_back(std::move(name));
+                }
+            }
+        }
+
+    }
+
+    LoadProfile::LoadProfile() : _impl(new Impl()) {
+    }
+
+    LoadProfile::~LoadProfile() = default;
+
+    LoadProfile::LoadProfile(LoadProfile &&other) noexcept {
+        std::swap(_impl, other._impl);
+    }
+
+    LoadProfile &LoadProfile::operator=(LoadProfile &&other) noexcept {
+        if (this == &other)
+            return *this;
+        std::swap(_impl, other._impl);
+        return *this;
+    }
+
+    bool LoadProfile::StartRecording(std::chrono::milliseconds window) {
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        if (LoadProfilePrivate::isRecording() || window.count() <= 0) {
+            return false;
+        }
+        g_Records.clear();
+        g_Start = std::chrono::steady_clock::now();
+        g_Deadline = g_Start + window;
+        LoadProfilePrivate::g_Recording = true;
+        return true;
+    }
+
+    void LoadProfile::StopRecording() {
+        LoadProfilePrivate::g_Recording = false;
+    }
+
+    bool LoadProfile::IsRecording() {
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        return LoadProfilePrivate::isRecording() &&
+               std::chrono::steady_clock::now() <= g_Deadline;
+    }
+
+    LoadProfile LoadProfile::Recorded() {
+        LoadProfile res;
+        {
+            std::lock_guard<std::mutex> lock(g_Mutex);
+            for (const auto &item : g_Records) {
+                res._impl->entries.push_back(item.second.entry);
+            }
+        }
+        auto &entries = res._impl->entries;
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.openedUs < b.openedUs;
+        });
+        return res;
+    }
+
+    bool LoadProfile::load(const PathString &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return fromData(data.data(), data.size());
+    }
+
+    bool LoadProfile::save(const PathString &path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        auto data = toData();
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    // Text format, one library per "L" line followed by its "S" lines:
+    //   LSOPROF <version>
+    //   L <opened us> <first use us or -> <load us> <symbol count> <path>
+    //   S <symbol>
+    bool LoadProfile::fromData(const void *data, size_t size) {
+        std::istringstream in(std::string(static_cast<const char *>(data), size));
+        std::string line;
+        if (!std::getline(in, line) || line.compare(0, 8, LOADSO_PROFILE_MAGIC " ") != 0 ||
+            atoi(line.data() + 8) < 1 || atoi(line.data() + 8) > LOADSO_PROFILE_VERSION) {
+            return false;
+        }
+
+        std::vector<Entry> entries;
+        while (std::getline(in, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            Entry entry;
+            unsigned long long opened, load;
+            size_t count;
+            char firstUse[32];
+            int pathPos = -1;
+            if (sscanf(line.data(), "L %llu %31s %llu %zu %n", &opened, firstUse, &load, &count,
+                       &pathPos) != 4 ||
+                pathPos < 0 || size_t(pathPos) >= line.size()) {
+                return false;
+            }
+            entry.path = line.substr(size_t(pathPos));
+            entry.openedUs = opened;
+            entry.loadUs = load;
+            entry.firstUseUs =
+                strcmp(firstUse, "-") == 0 ? Unused : strtoull(firstUse, nullptr, 10);
+            for (size_t i = 0; i < count; ++i) {
+                if (!std::getline(in, line) || line.compare(0, 2, "S ") != 0) {
+                    return false;
+                }
+                entry.symbols.push_back(line.substr(2));
+            }
+            entries.push_back(std::move(entry));
+        }
+        _impl->entries = std::move(entries);
+        return true;
+    }
+
+    std::string LoadProfile::toData() const {
+        std::string res = LOADSO_PROFILE_MAGIC " " + std::to_string(LOADSO_PROFILE_VERSION) + "\n";
+        for (const auto &entry : _impl->entries) {
+            res += "L " + std::to_string(entry.openedUs) + " " +
+                   (entry.isUsed() ? std::to_string(entry.firstUseUs) : std::string("-")) + " " +
+                   std::to_string(entry.loadUs) + " " + std::to_string(entry.symbols.size()) +
+                   " " + entry.path + "\n";
+            for (const auto &symbol : entry.symbols) {
+                res += "S " + symbol + "\n";
+            }
+        }
+        return res;
+    }
+
+    const std::vector<LoadProfile::Entry> &LoadProfile::entries() const {
+        return _impl->entries;
+    }
+
+    const LoadProfile::Entry *LoadProfile::find(const PathString &path) const {
+        const auto key = System::MultiFromPathString(absolutePath(path));
+        for (const auto &entry : _impl->entries) {
+            if (entry.path == key) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    int LoadProfile::hints(const PathString &path, int hints) const {
+        auto entry = find(path);
+        if (!entry) {
+            return hints;
+        }
+        if (entry->isUsed()) {
+            return hints | Library::ResolveAllSymbolsHint;
+        }
+        return hints & ~Library::ResolveAllSymbolsHint;
+    }
+
+    size_t LoadProfile::prefetch() const {
+        size_t res = 0;
+#ifndef _WIN32
+        for (const auto &entry : _impl->entries) {
+            int fd = ::open(entry.path.data(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+#  if defined(POSIX_FADV_WILLNEED)
+            if (::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0) {
+                res++;
+            }
+#  endif
+            ::close(fd);
+        }
+#endif
+        return res;
+    }
+
+    size_t LoadProfile::preload(const std::vector<PluginLoader *> &plugins, int hints,
+                                int threads) const {
+        struct Task {
+            PluginLoader *plugin;
+            uint64_t firstUseUs;
+            int hints;
+        };
+        std::vector<Task> tasks;
+        for (auto plugin : plugins) {
+            if (!plugin || plugin->isLoaded()) {
+                continue;
+            }
+            auto entry = find(plugin->path());
+            if (entry && entry->isUsed()) {
+                tasks.push_back({plugin, entry->firstUseUs, this->hints(plugin->path(), hints)});
+            }
+        }
+        std::stable_sort(tasks.begin(), tasks.end(), [](const Task &a, const Task &b) {
+            return a.firstUseUs < b.firstUseUs;
+        });
+
+        if (threads <= 0) {
+            threads = std::max(1, int(std::thread::hardware_concurrency()));
+        }
+        threads = std::min<int>(threads, int(tasks.size()));
+
+        std::atomic<size_t> next(0);
+        std::atomic<size_t> succeeded(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < tasks.size(); i = next++) {
+                if (tasks[i].plugin->load(tasks[i].hints)) {
+                    succeeded++;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : workers) {
+            thread.join();
+        }
+        return succeeded;
+    }
+
+    std::string LoadProfile::report() const {
+        std::string res;
+        char buf[512];
+        snprintf(buf, sizeof(buf), "  %10s %10s %10s %7s  %s\n", "opened ms", "used ms", "load ms",
+                 "symbols", "library");
+        res += buf;
+        for (const auto &entry : _impl->entries) {
+            char used[32] = "-";
+            if (entry.isUsed()) {
+                snprintf(used, sizeof(used), "%.3f", double(entry.firstUseUs) / 1e3);
+            }
+            snprintf(buf, sizeof(buf), "  %10.3f %10s %10.3f %7zu  %s\n",
+                     double(entry.openedUs) / 1e3, used, double(entry.loadUs) / 1e3,
+                     entry.symbols.size(), entry.path.data());
+            res += buf;
+        }
+        return res;
+    }
+
+}
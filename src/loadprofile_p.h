@@ -0,0 +1,38 @@
+#ifndef LOADPROFILE_P_H
+#define LOADPROFILE_P_H
+
+#include <atomic>
+
+#include "loadprofile.h"
+
+namespace LoadSO {
+
+    class LoadProfile::Impl {
+    public:
+        std::vector<Entry> entries;
+    };
+
+    namespace LoadProfilePrivate {
+
+        extern std::atomic<bool> g_Recording;
+
+        inline bool isRecording() {
+            return g_Recording.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Logs a library opened from a file, the path is absolute.
+         */
+        void recordOpen(const PathString &path, std::chrono::nanoseconds loadTime);
+
+        /**
+         * @brief Logs the use of a library opened during recording, \c symbol is \c nullptr for
+         *        an instance request.
+         */
+        void recordUse(const PathString &path, const char *symbol, size_t size);
+
+    }
+
+}
+
+#endif // LOADPROFILE_P_H
@@ -0,0 +1,1252 @@
+#include "metadatareader.h"
+#include "metadatareader_p.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <tuple>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+
+#  include "iobatch_p.h"
+#endif
+
+namespace LoadSO {
+
+    constexpr const char *MetadataReader::DefaultName;
+
+    bool DataSource::readString(uint64_t offset, size_t size, std::string *out) {
+        if (offset > this->size() || size > this->size() - offset) {
+            return false;
+        }
+        std::string buffer;
+        buffer.resize(size);
+        if (size > 0 && !read(offset, &buffer[0], size)) {
+            return false;
+        }
+        std::swap(*out, buffer);
+        return true;
+    }
+
+    bool DataSource::readCString(uint64_t offset, std::string *out, size_t maxSize) {
+        std::string buffer;
+        char chunk[64];
+        while (buffer.size() < maxSize) {
+            if (offset >= size()) {
+                return false;
+            }
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(sizeof(chunk), size() - offset));
+            if (!read(offset, chunk, n)) {
+                return false;
+            }
+            auto end = std::find(chunk, chunk + n, '\0');
+            buffer.append(chunk, end);
+            if (end != chunk + n) {
+                std::swap(*out, buffer);
+                return true;
+            }
+            offset += n;
+        }
+        return false;
+    }
+
+    uint64_t BufferSource::size() const {
+        return _size;
+    }
+
+    bool BufferSource::read(uint64_t offset, void *buf, size_t size) {
+        if (offset > _size || size > _size - offset) {
+            return false;
+        }
+        memcpy(buf, _data + offset, size);
+        return true;
+    }
+
+    uint64_t SubSource::size() const {
+        return _size;
+    }
+
+    bool SubSource::read(uint64_t offset, void *buf, size_t size) {
+        if (offset > _size || size > _size - offset) {
+            return false;
+        }
+        return _src.read(_offset + offset, buf, size);
+    }
+
+    FileSource::FileSource(const PathString &path) : _file(path, std::ios::binary) {
+        if (!_file) {
+            return;
+        }
+        _file.seekg(0, std::ios::end);
+        auto end = _file.tellg();
+        if (end < 0) {
+            _file.close();
+            return;
+        }
+        _size = static_cast<uint64_t>(end);
+    }
+
+    bool FileSource::isOpen() const {
+        return _file.is_open();
+    }
+
+    uint64_t FileSource::size() const {
+        return _size;
+    }
+
+    bool FileSource::read(uint64_t offset, void *buf, size_t size) {
+        if (offset > _size || size > _size - offset) {
+            return false;
+        }
+        _file.clear();
+        _file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+        _file.read(static_cast<char *>(buf), static_cast<std::streamsize>(size));
+        return _file.good();
+    }
+
+    constexpr const size_t BlockSource::BlockSize;
+
+    uint64_t BlockSource::size() const {
+        return _size;
+    }
+
+    bool BlockSource::read(uint64_t offset, void *buf, size_t size) {
+        if (offset > _size || size > _size - offset) {
+            return false;
+        }
+        // Record every absent block of the range, not only the first one
+        bool complete = true;
+        auto dst = static_cast<char *>(buf);
+        for (uint64_t pos = offset; pos < offset + size;) {
+            const uint64_t block = pos / BlockSize;
+            const size_t begin = size_t(pos - block * BlockSize);
+            const size_t n = size_t(std::min<uint64_t>(BlockSize - begin, offset + size - pos));
+            auto it = blocks.find(block);
+            if (it == blocks.end()) {
+                missing.insert(block);
+                complete = false;
+            } else if (complete) {
+                memcpy(dst + (pos - offset), it->second.data() + begin, n);
+            }
+            pos += n;
+        }
+        return complete;
+    }
+
+    size_t BlockSource::blockLength(uint64_t block) const {
+        return size_t(std::min<uint64_t>(BlockSize, _size - block * BlockSize));
+    }
+
+    namespace MetadataReaderPrivate {
+
+        uint16_t get16(const unsigned char *p, bool bigEndian) {
+            return bigEndian ? uint16_t(p[0] << 8 | p[1]) : uint16_t(p[1] << 8 | p[0]);
+        }
+
+        uint32_t get32(const unsigned char *p, bool bigEndian) {
+            return bigEndian ? uint32_t(get16(p, true)) << 16 | get16(p + 2, true)
+                             : uint32_t(get16(p + 2, false)) << 16 | get16(p, false);
+        }
+
+        uint64_t get64(const unsigned char *p, bool bigEndian) {
+            return bigEndian ? uint64_t(get32(p, true)) << 32 | get32(p + 4, true)
+                             : uint64_t(get32(p + 4, false)) << 32 | get32(p, false);
+        }
+
+        static std::string fixedString(const unsigned char *p, size_t maxSize) {
+            auto s = reinterpret_cast<const char *>(p);
+            return std::string(s, std::find(s, s + maxSize, '\0'));
+        }
+
+        // ELF
+
+        static constexpr const uint32_t ELF_SHT_NOBITS = 8;
+
+        bool parseELF(DataSource &src, ElfInfo *info) {
+            unsigned char ehdr[64];
+            if (!src.read(0, ehdr, 16)) {
+                return false;
+            }
+
+            // Check header: ELF
+            if (memcmp(ehdr, "\x7f"
+                             "ELF",
+                       4) != 0) {
+                return false;
+            }
+
+            // Check bits and byte order
+            if (ehdr[4] != 1 && ehdr[4] != 2) {
+                return false;
+            }
+            if (ehdr[5] != 1 && ehdr[5] != 2) {
+                return false;
+            }
+            const bool is64 = ehdr[4] == 2;
+            const bool be = ehdr[5] == 2;
+            if (!src.read(0, ehdr, is64 ? 64 : 52)) {
+                return false;
+            }
+
+            uint64_t shoff = is64 ? get64(ehdr + 0x28, be) : get32(ehdr + 0x20, be);
+            uint32_t shentsize = get16(ehdr + (is64 ? 0x3A : 0x2E), be);
+            uint32_t shnum = get16(ehdr + (is64 ? 0x3C : 0x30), be);
+            uint32_t shstrndx = get16(ehdr + (is64 ? 0x3E : 0x32), be);
+
+            info->is64 = is64;
+            info->bigEndian = be;
+            info->machine = get16(ehdr + 0x12, be);
+            info->sections.clear();
+
+            if (shoff == 0) {
+                return true;
+            }
+
+            // Check header sizes
+            const uint32_t expectedSize = is64 ? 64 : 40;
+            if (shentsize != expectedSize) {
+                return false;
+            }
+
+            auto parseShdr = [is64, be](const unsigned char *p, ElfSection *sec, uint32_t *name) {
+                *name = get32(p, be);
+                sec->type = get32(p + 4, be);
+                if (is64) {
+                    sec->flags = get64(p + 0x08, be);
+                    sec->addr = get64(p + 0x10, be);
+                    sec->offset = get64(p + 0x18, be);
+                    sec->size = get64(p + 0x20, be);
+                    sec->link = get32(p + 0x28, be);
+                    sec->info = get32(p + 0x2C, be);
+                    sec->entsize = get64(p + 0x38, be);
+                } else {
+                    sec->flags = get32(p + 0x08, be);
+                    sec->addr = get32(p + 0x0C, be);
+                    sec->offset = get32(p + 0x10, be);
+                    sec->size = get32(p + 0x14, be);
+                    sec->link = get32(p + 0x18, be);
+                    sec->info = get32(p + 0x1C, be);
+                    sec->entsize = get32(p + 0x24, be);
+                }
+            };
+
+            // Extended section numbering, the real values live in the first section header
+            if (shnum == 0 || shstrndx == 0xFFFF) {
+                unsigned char first[64];
+                if (!src.read(shoff, first, expectedSize)) {
+                    return false;
+                }
+                ElfSection sec;
+                uint32_t name;
+                parseShdr(first, &sec, &name);
+                if (shnum == 0) {
+                    shnum = static_cast<uint32_t>(sec.size);
+                }
+                if (shstrndx == 0xFFFF) {
+                    shstrndx = sec.link;
+                }
+            }
+
+            // Read section headers
+            if (shoff > src.size() || uint64_t(shnum) * shentsize > src.size() - shoff) {
+                return false;
+            }
+            std::vector<unsigned char> shdrs(size_t(shnum) * shentsize);
+            if (!shdrs.empty() && !src.read(shoff, shdrs.data(), shdrs.size())) {
+                return false;
+            }
+
+            std::vector<uint32_t> nameOffsets(shnum);
+            info->sections.resize(shnum);
+            for (uint32_t i = 0; i < shnum; ++i) {
+                parseShdr(shdrs.data() + size_t(i) * shentsize, &info->sections[i],
+                          &nameOffsets[i]);
+            }
+
+            // Read section header string table
+            if (shstrndx >= shnum) {
+                return false;
+            }
+            const auto &strtabHdr = info->sections[shstrndx];
+            std::string shstrtab;
+            if (!src.readString(strtabHdr.offset, strtabHdr.size, &shstrtab)) {
+                return false;
+            }
+            for (uint32_t i = 0; i < shnum; ++i) {
+                if (nameOffsets[i] < shstrtab.size()) {
+                    info->sections[i].name = shstrtab.data() + nameOffsets[i];
+                }
+            }
+            return true;
+        }
+
+        bool locateInELF(DataSource &src, const char *name, uint64_t *offset, uint64_t *size) {
+            ElfInfo info;
+            if (!parseELF(src, &info)) {
+                return false;
+            }
+
+            // Find metadata section
+            const std::string sectionName = std::string(".") + name;
+            for (const auto &sec : info.sections) {
+                if (sec.name == sectionName && sec.type != ELF_SHT_NOBITS) {
+                    *offset = sec.offset;
+                    *size = sec.size;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool readFromELF(DataSource &src, const char *name, std::string *out) {
+            uint64_t offset, size;
+            return locateInELF(src, name, &offset, &size) && src.readString(offset, size, out);
+        }
+
+        // Mach-O
+
+        static constexpr const uint32_t MACHO_MAGIC = 0xFEEDFACE;
+        static constexpr const uint32_t MACHO_CIGAM = 0xCEFAEDFE;
+        static constexpr const uint32_t MACHO_MAGIC_64 = 0xFEEDFACF;
+        static constexpr const uint32_t MACHO_CIGAM_64 = 0xCFFAEDFE;
+        static constexpr const uint32_t MACHO_FAT_MAGIC = 0xCAFEBABE;
+        static constexpr const uint32_t MACHO_FAT_MAGIC_64 = 0xCAFEBABF;
+        static constexpr const uint32_t MACHO_LC_SEGMENT = 0x1;
+        static constexpr const uint32_t MACHO_LC_SEGMENT_64 = 0x19;
+        static constexpr const uint32_t MACHO_S_ZEROFILL = 0x1;
+
+        bool parseMachO(DataSource &src, MachOInfo *info) {
+            unsigned char header[32];
+            if (!src.read(0, header, 28)) {
+                return false;
+            }
+
+            // Check bits and byte order
+            bool is64, be;
+            switch (get32(header, false)) {
+                case MACHO_MAGIC:
+                    is64 = false, be = false;
+                    break;
+                case MACHO_CIGAM:
+                    is64 = false, be = true;
+                    break;
+                case MACHO_MAGIC_64:
+                    is64 = true, be = false;
+                    break;
+                case MACHO_CIGAM_64:
+                    is64 = true, be = true;
+                    break;
+                default:
+                    return false;
+            }
+
+            const uint32_t ncmds = get32(header + 16, be);
+            info->is64 = is64;
+            info->bigEndian = be;
+            info->cputype = get32(header + 4, be);
+            info->sections.clear();
+            info->commands.clear();
+
+            // Traverse load commands
+            uint64_t offset = is64 ? 32 : 28;
+            for (uint32_t i = 0; i < ncmds; ++i) {
+                unsigned char lc[8];
+                if (!src.read(offset, lc, sizeof(lc))) {
+                    return false;
+                }
+                const uint32_t cmd = get32(lc, be);
+                const uint32_t cmdsize = get32(lc + 4, be);
+                if (cmdsize < sizeof(lc)) {
+                    return false;
+                }
+                info->commands.push_back({cmd, offset, cmdsize});
+
+                if (cmd == MACHO_LC_SEGMENT || cmd == MACHO_LC_SEGMENT_64) {
+                    const bool seg64 = cmd == MACHO_LC_SEGMENT_64;
+                    const uint32_t segSize = seg64 ? 72 : 56;
+                    const uint32_t sectSize = seg64 ? 80 : 68;
+
+                    unsigned char seg[72];
+                    if (cmdsize < segSize || !src.read(offset, seg, segSize)) {
+                        return false;
+                    }
+                    const uint32_t nsects = get32(seg + (seg64 ? 64 : 48), be);
+                    if (uint64_t(nsects) * sectSize > cmdsize - segSize) {
+                        return false;
+                    }
+
+                    for (uint32_t j = 0; j < nsects; ++j) {
+                        unsigned char sect[80];
+                        if (!src.read(offset + segSize + uint64_t(j) * sectSize, sect, sectSize)) {
+                            return false;
+                        }
+                        MachOSection sec;
+                        sec.sectname = fixedString(sect, 16);
+                        sec.segname = fixedString(sect + 16, 16);
+                        if (seg64) {
+                            sec.size = get64(sect + 40, be);
+                            sec.offset = get32(sect + 48, be);
+                            sec.flags = get32(sect + 64, be);
+                        } else {
+                            sec.size = get32(sect + 36, be);
+                            sec.offset = get32(sect + 40, be);
+                            sec.flags = get32(sect + 56, be);
+                        }
+                        info->sections.push_back(std::move(sec));
+                    }
+                }
+                offset += cmdsize;
+            }
+            return true;
+        }
+
+        bool machOSlices(DataSource &src, std::vector<std::pair<uint64_t, uint64_t>> *slices) {
+            unsigned char header[8];
+            if (!src.read(0, header, sizeof(header))) {
+                return false;
+            }
+
+            slices->clear();
+            const uint32_t magic = get32(header, true);
+            if (magic != MACHO_FAT_MAGIC && magic != MACHO_FAT_MAGIC_64) {
+                slices->emplace_back(0, src.size());
+                return true;
+            }
+
+            // Fat headers are always big endian
+            const bool fat64 = magic == MACHO_FAT_MAGIC_64;
+            const uint32_t archSize = fat64 ? 32 : 20;
+            const uint32_t narchs = get32(header + 4, true);
+            if (uint64_t(narchs) * archSize > src.size()) {
+                return false;
+            }
+            for (uint32_t i = 0; i < narchs; ++i) {
+                unsigned char arch[32];
+                if (!src.read(8 + uint64_t(i) * archSize, arch, archSize)) {
+                    return false;
+                }
+                uint64_t offset = fat64 ? get64(arch + 8, true) : get32(arch + 8, true);
+                uint64_t size = fat64 ? get64(arch + 16, true) : get32(arch + 12, true);
+                if (offset > src.size() || size > src.size() - offset) {
+                    return false;
+                }
+                slices->emplace_back(offset, size);
+            }
+            return true;
+        }
+
+        bool locateInMachO(DataSource &src, const char *name, uint64_t *offset,
+                           uint64_t *size) {
+            std::vector<std::pair<uint64_t, uint64_t>> slices;
+            if (!machOSlices(src, &slices)) {
+                return false;
+            }
+
+            // Section names are at most 16 characters
+            const std::string sectionName = std::string(name).substr(0, 16);
+            for (const auto &slice : slices) {
+                SubSource sliceSrc(src, slice.first, slice.second);
+                MachOInfo info;
+                if (!parseMachO(sliceSrc, &info)) {
+                    continue;
+                }
+                for (const auto &sec : info.sections) {
+                    if (sec.segname == "__TEXT" && sec.sectname == sectionName &&
+                        (sec.flags & 0xFF) != MACHO_S_ZEROFILL) {
+                        if (sec.offset > sliceSrc.size() ||
+                            sec.size > sliceSrc.size() - sec.offset) {
+                            return false;
+                        }
+                        *offset = slice.first + sec.offset;
+                        *size = sec.size;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool readFromMachO(DataSource &src, const char *name, std::string *out) {
+            uint64_t offset, size;
+            return locateInMachO(src, name, &offset, &size) && src.readString(offset, size, out);
+        }
+
+        // PE
+
+        static constexpr const uint32_t PE_DIRECTORY_RESOURCE = 2;
+        static constexpr const uint32_t PE_RT_RCDATA = 10;
+
+        bool PeInfo::rvaToOffset(uint32_t rva, uint64_t *offset) const {
+            for (const auto &sec : sections) {
+                const uint32_t span = std::max(sec.virtualSize, sec.rawSize);
+                if (rva >= sec.virtualAddress && rva - sec.virtualAddress < span) {
+                    const uint32_t delta = rva - sec.virtualAddress;
+                    if (delta >= sec.rawSize) {
+                        return false;
+                    }
+                    *offset = uint64_t(sec.rawOffset) + delta;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool parsePE(DataSource &src, PeInfo *info) {
+            unsigned char dos[64];
+            if (!src.read(0, dos, sizeof(dos)) || dos[0] != 'M' || dos[1] != 'Z') {
+                return false;
+            }
+            const uint32_t peOffset = get32(dos + 0x3C, false);
+
+            // Signature and COFF file header
+            unsigned char coff[24];
+            if (!src.read(peOffset, coff, sizeof(coff)) || memcmp(coff, "PE\0\0", 4) != 0) {
+                return false;
+            }
+            const uint16_t nsections = get16(coff + 6, false);
+            const uint16_t optSize = get16(coff + 20, false);
+
+            // Optional header
+            std::vector<unsigned char> opt(optSize);
+            if (optSize < 2 || !src.read(uint64_t(peOffset) + 24, opt.data(), opt.size())) {
+                return false;
+            }
+            const uint16_t optMagic = get16(opt.data(), false);
+            if (optMagic != 0x10B && optMagic != 0x20B) {
+                return false;
+            }
+            const bool is64 = optMagic == 0x20B;
+            const uint32_t countOffset = is64 ? 108 : 92;
+            const uint32_t dirOffset = is64 ? 112 : 96;
+
+            info->is64 = is64;
+            info->machine = get16(coff + 4, false);
+            info->dataDirectories.clear();
+            if (optSize >= countOffset + 4) {
+                uint32_t count = get32(opt.data() + countOffset, false);
+                count = std::min<uint32_t>(count, (optSize - dirOffset) / 8);
+                for (uint32_t i = 0; i < count; ++i) {
+                    const unsigned char *p = opt.data() + dirOffset + i * 8;
+                    info->dataDirectories.emplace_back(get32(p, false), get32(p + 4, false));
+                }
+            }
+
+            // Section table
+            const uint64_t tableOffset = uint64_t(peOffset) + 24 + optSize;
+            info->sections.clear();
+            for (uint16_t i = 0; i < nsections; ++i) {
+                unsigned char hdr[40];
+                if (!src.read(tableOffset + i * 40ULL, hdr, sizeof(hdr))) {
+                    return false;
+                }
+                PeSection sec;
+                sec.name = fixedString(hdr, 8);
+                sec.virtualSize = get32(hdr + 8, false);
+                sec.virtualAddress = get32(hdr + 12, false);
+                sec.rawSize = get32(hdr + 16, false);
+                sec.rawOffset = get32(hdr + 20, false);
+                info->sections.push_back(std::move(sec));
+            }
+            return true;
+        }
+
+        static bool peResourceNameEquals(DataSource &src, uint64_t offset, const char *name) {
+            unsigned char lenBuf[2];
+            if (!src.read(offset, lenBuf, sizeof(lenBuf))) {
+                return false;
+            }
+            const uint16_t len = get16(lenBuf, false);
+            if (len != strlen(name)) {
+                return false;
+            }
+            std::vector<unsigned char> chars(len * 2);
+            if (!src.read(offset + 2, chars.data(), chars.size())) {
+                return false;
+            }
+
+            // Resource names are compared case insensitively, like FindResource()
+            for (uint16_t i = 0; i < len; ++i) {
+                const uint16_t ch = get16(chars.data() + i * 2, false);
+                if (ch > 0x7F || ::toupper(ch) != ::toupper(static_cast<unsigned char>(name[i]))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Returns the entry pointing to a sub-directory or data entry, the high bit tells which
+        static bool peFindResourceEntry(DataSource &src, uint64_t base, uint32_t dirOffset,
+                                        const char *name, uint32_t id, uint32_t *entry) {
+            unsigned char dir[16];
+            if (!src.read(base + dirOffset, dir, sizeof(dir))) {
+                return false;
+            }
+            const uint32_t count = uint32_t(get16(dir + 12, false)) + get16(dir + 14, false);
+            for (uint32_t i = 0; i < count; ++i) {
+                unsigned char ent[8];
+                if (!src.read(base + dirOffset + 16 + i * 8ULL, ent, sizeof(ent))) {
+                    return false;
+                }
+                const uint32_t entName = get32(ent, false);
+                const bool named = (entName & 0x80000000) != 0;
+                bool match;
+                if (name) {
+                    match = named &&
+                            peResourceNameEquals(src, base + (entName & 0x7FFFFFFF), name);
+                } else {
+                    // A null name with id 0 matches any entry, e.g. the first language
+                    match = id == 0 || (!named && entName == id);
+                }
+                if (match) {
+                    *entry = get32(ent + 4, false);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool locateInPE(DataSource &src, const char *name, uint64_t *offset, uint64_t *size) {
+            PeInfo info;
+            if (!parsePE(src, &info)) {
+                return false;
+            }
+            if (info.dataDirectories.size() <= PE_DIRECTORY_RESOURCE) {
+                return false;
+            }
+            uint64_t base;
+            if (!info.rvaToOffset(info.dataDirectories[PE_DIRECTORY_RESOURCE].first, &base)) {
+                return false;
+            }
+
+            // Resource tree: type -> name -> language -> data entry
+            uint32_t entry;
+            if (!peFindResourceEntry(src, base, 0, nullptr, PE_RT_RCDATA, &entry) ||
+                !(entry & 0x80000000)) {
+                return false;
+            }
+            if (!peFindResourceEntry(src, base, entry & 0x7FFFFFFF, name, 0, &entry) ||
+                !(entry & 0x80000000)) {
+                return false;
+            }
+            if (!peFindResourceEntry(src, base, entry & 0x7FFFFFFF, nullptr, 0, &entry) ||
+                (entry & 0x80000000)) {
+                return false;
+            }
+
+            unsigned char data[16];
+            if (!src.read(base + entry, data, sizeof(data))) {
+                return false;
+            }
+            if (!info.rvaToOffset(get32(data, false), offset)) {
+                return false;
+            }
+            *size = get32(data + 4, false);
+            return true;
+        }
+
+        bool readFromPE(DataSource &src, const char *name, std::string *out) {
+            uint64_t offset, size;
+            return locateInPE(src, name, &offset, &size) && src.readString(offset, size, out);
+        }
+
+        // Symbols and dependencies
+
+        static constexpr const uint32_t ELF_SHT_DYNAMIC = 6;
+        static constexpr const uint32_t ELF_SHT_DYNSYM = 11;
+        static constexpr const uint64_t ELF_DT_NEEDED = 1;
+
+        bool readSymbolsFromELF(DataSource &src, std::vector<std::string> *exports,
+                                std::vector<std::string> *dependencies) {
+            ElfInfo info;
+            if (!parseELF(src, &info)) {
+                return false;
+            }
+            const bool be = info.bigEndian;
+
+            for (const auto &sec : info.sections) {
+                if (sec.type != ELF_SHT_DYNSYM && sec.type != ELF_SHT_DYNAMIC) {
+                    continue;
+                }
+                if (sec.link >= info.sections.size()) {
+                    return false;
+                }
+                std::string data, strtab;
+                const auto &strHdr = info.sections[sec.link];
+                if (!src.readString(sec.offset, sec.size, &data) ||
+                    !src.readString(strHdr.offset, strHdr.size, &strtab)) {
+                    return false;
+                }
+                auto p = reinterpret_cast<const unsigned char *>(data.data());
+                auto str = [&strtab](uint64_t off) -> const char * {
+                    return off < strtab.size() ? strtab.data() + off : "";
+                };
+
+                if (sec.type == ELF_SHT_DYNSYM) {
+                    // Defined global or weak symbols with default or protected visibility
+                    const size_t entSize = info.is64 ? 24 : 16;
+                    for (size_t off = entSize; off + entSize <= data.size(); off += entSize) {
+                        const uint32_t nameOff = get32(p + off, be);
+                        const unsigned char stInfo = p[off + (info.is64 ? 4 : 12)];
+                        const unsigned char stOther = p[off + (info.is64 ? 5 : 13)];
+                        const uint16_t shndx = get16(p + off + (info.is64 ? 6 : 14), be);
+                        const int bind = stInfo >> 4, type = stInfo & 0xF, vis = stOther & 0x3;
+                        if (shndx == 0 || (bind != 1 && bind != 2) || (vis != 0 && vis != 3) ||
+                            (type > 2 && type != 10 /* STT_GNU_IFUNC */)) {
+                            continue;
+                        }
+                        if (*str(nameOff)) {
+                            exports->emplace_back(str(nameOff));
+                        }
+                    }
+                } else {
+                    const size_t entSize = info.is64 ? 16 : 8;
+                    for (size_t off = 0; off + entSize <= data.size(); off += entSize) {
+                        const uint64_t tag = info.is64 ? get64(p + off, be) : get32(p + off, be);
+                        const uint64_t val =
+                            info.is64 ? get64(p + off + 8, be) : get32(p + off + 4, be);
+                        if (tag == 0) {
+                            break;
+                        }
+                        if (tag == ELF_DT_NEEDED) {
+                            dependencies->emplace_back(str(val));
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        static constexpr const uint32_t MACHO_LC_SYMTAB = 0x2;
+        static constexpr const uint32_t MACHO_LC_LOAD_DYLIB = 0xC;
+        static constexpr const uint32_t MACHO_LC_LOAD_WEAK_DYLIB = 0x80000018;
+        static constexpr const uint32_t MACHO_LC_REEXPORT_DYLIB = 0x8000001F;
+        static constexpr const uint32_t MACHO_LC_LAZY_LOAD_DYLIB = 0x20;
+        static constexpr const uint32_t MACHO_LC_LOAD_UPWARD_DYLIB = 0x80000023;
+
+        bool readSymbolsFromMachO(DataSource &src, std::vector<std::string> *exports,
+                                  std::vector<std::string> *dependencies) {
+            std::vector<std::pair<uint64_t, uint64_t>> slices;
+            if (!machOSlices(src, &slices) || slices.empty()) {
+                return false;
+            }
+
+            // All slices of a fat file export the same interface, the first one is enough
+            SubSource sliceSrc(src, slices.front().first, slices.front().second);
+            MachOInfo info;
+            if (!parseMachO(sliceSrc, &info)) {
+                return false;
+            }
+            const bool be = info.bigEndian;
+
+            for (const auto &lc : info.commands) {
+                switch (lc.cmd) {
+                    case MACHO_LC_SYMTAB: {
+                        unsigned char cmd[24];
+                        if (lc.size < sizeof(cmd) || !sliceSrc.read(lc.offset, cmd, sizeof(cmd))) {
+                            return false;
+                        }
+                        const uint32_t symoff = get32(cmd + 8, be), nsyms = get32(cmd + 12, be);
+                        const uint32_t stroff = get32(cmd + 16, be), strsize = get32(cmd + 20, be);
+                        const size_t entSize = info.is64 ? 16 : 12;
+
+                        std::string syms, strtab;
+                        if (!sliceSrc.readString(symoff, size_t(nsyms) * entSize, &syms) ||
+                            !sliceSrc.readString(stroff, strsize, &strtab)) {
+                            return false;
+                        }
+                        auto p = reinterpret_cast<const unsigned char *>(syms.data());
+                        for (uint32_t i = 0; i < nsyms; ++i) {
+                            const uint32_t strx = get32(p + i * entSize, be);
+                            const unsigned char type = p[i * entSize + 4];
+
+                            // External, defined in a section and not a debug entry
+                            if ((type & 0xE0) || !(type & 0x01) || (type & 0x0E) != 0x0E ||
+                                strx >= strtab.size()) {
+                                continue;
+                            }
+
+                            // C symbols carry a leading underscore that dlsym() adds itself
+                            const char *sym = strtab.data() + strx;
+                            if (*sym == '_') {
+                                sym++;
+                            }
+                            if (*sym) {
+                                exports->emplace_back(sym);
+                            }
+                        }
+                        break;
+                    }
+                    case MACHO_LC_LOAD_DYLIB:
+                    case MACHO_LC_LOAD_WEAK_DYLIB:
+                    case MACHO_LC_REEXPORT_DYLIB:
+                    case MACHO_LC_LAZY_LOAD_DYLIB:
+                    case MACHO_LC_LOAD_UPWARD_DYLIB: {
+                        unsigned char cmd[12];
+                        if (lc.size < sizeof(cmd) || !sliceSrc.read(lc.offset, cmd, sizeof(cmd))) {
+                            return false;
+                        }
+                        const uint32_t nameOff = get32(cmd + 8, be);
+                        std::string dylib;
+                        if (nameOff >= lc.size ||
+                            !sliceSrc.readCString(lc.offset + nameOff, &dylib, lc.size - nameOff)) {
+                            return false;
+                        }
+                        dependencies->push_back(std::move(dylib));
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+            return true;
+        }
+
+        static constexpr const uint32_t PE_DIRECTORY_EXPORT = 0;
+        static constexpr const uint32_t PE_DIRECTORY_IMPORT = 1;
+
+        bool readSymbolsFromPE(DataSource &src, std::vector<std::string> *exports,
+                               std::vector<std::string> *dependencies) {
+            PeInfo info;
+            if (!parsePE(src, &info)) {
+                return false;
+            }
+
+            auto readRvaString = [&](uint32_t rva, std::string *out) {
+                uint64_t offset;
+                return info.rvaToOffset(rva, &offset) && src.readCString(offset, out);
+            };
+
+            // Export directory: names are sorted RVAs of null terminated strings
+            if (info.dataDirectories.size() > PE_DIRECTORY_EXPORT &&
+                info.dataDirectories[PE_DIRECTORY_EXPORT].first != 0) {
+                uint64_t offset;
+                unsigned char dir[40];
+                if (!info.rvaToOffset(info.dataDirectories[PE_DIRECTORY_EXPORT].first, &offset) ||
+                    !src.read(offset, dir, sizeof(dir))) {
+                    return false;
+                }
+                const uint32_t numNames = get32(dir + 24, false);
+                uint64_t namesOffset;
+                std::string names;
+                if (!info.rvaToOffset(get32(dir + 32, false), &namesOffset) ||
+                    !src.readString(namesOffset, size_t(numNames) * 4, &names)) {
+                    return false;
+                }
+                for (uint32_t i = 0; i < numNames; ++i) {
+                    std::string sym;
+                    if (!readRvaString(
+                            get32(reinterpret_cast<const unsigned char *>(names.data()) + i * 4,
+                                  false),
+                            &sym)) {
+                        return false;
+                    }
+                    exports->push_back(std::move(sym));
+                }
+            }
+
+            // Import directory: descriptors terminated by an all zero entry
+            if (info.dataDirectories.size() > PE_DIRECTORY_IMPORT &&
+                info.dataDirectories[PE_DIRECTORY_IMPORT].first != 0) {
+                uint64_t offset;
+                if (!info.rvaToOffset(info.dataDirectories[PE_DIRECTORY_IMPORT].first, &offset)) {
+                    return false;
+                }
+                for (;; offset += 20) {
+                    unsigned char desc[20];
+                    if (!src.read(offset, desc, sizeof(desc))) {
+                        return false;
+                    }
+                    const uint32_t nameRva = get32(desc + 12, false);
+                    if (nameRva == 0) {
+                        break;
+                    }
+                    std::string dll;
+                    if (!readRvaString(nameRva, &dll)) {
+                        return false;
+                    }
+                    dependencies->push_back(std::move(dll));
+                }
+            }
+            return true;
+        }
+
+        bool readInfo(DataSource &src, const char *name, MetadataReader::FileInfo *info) {
+            *info = {};
+            info->format = detectFormat(src);
+            switch (info->format) {
+                case MetadataReader::ElfFormat:
+                    std::ignore = readFromELF(src, name, &info->metadata);
+                    return readSymbolsFromELF(src, &info->exports, &info->dependencies);
+                case MetadataReader::MachOFormat:
+                    std::ignore = readFromMachO(src, name, &info->metadata);
+                    return readSymbolsFromMachO(src, &info->exports, &info->dependencies);
+                case MetadataReader::PeFormat:
+                    std::ignore = readFromPE(src, name, &info->metadata);
+                    return readSymbolsFromPE(src, &info->exports, &info->dependencies);
+                default:
+                    break;
+            }
+            return false;
+        }
+
+        MetadataReader::Format detectFormat(DataSource &src) {
+            unsigned char magic[4];
+            if (!src.read(0, magic, sizeof(magic))) {
+                return MetadataReader::UnknownFormat;
+            }
+            if (memcmp(magic, "\x7f"
+                              "ELF",
+                       4) == 0) {
+                return MetadataReader::ElfFormat;
+            }
+            if (magic[0] == 'M' && magic[1] == 'Z') {
+                return MetadataReader::PeFormat;
+            }
+            switch (get32(magic, true)) {
+                case MACHO_MAGIC:
+                case MACHO_CIGAM:
+                case MACHO_MAGIC_64:
+                case MACHO_CIGAM_64:
+                case MACHO_FAT_MAGIC:
+                case MACHO_FAT_MAGIC_64:
+                    return MetadataReader::MachOFormat;
+                default:
+                    break;
+            }
+            return MetadataReader::UnknownFormat;
+        }
+
+        bool locate(DataSource &src, const char *name, uint64_t *offset, uint64_t *size) {
+            switch (detectFormat(src)) {
+                case MetadataReader::ElfFormat:
+                    return locateInELF(src, name, offset, size);
+                case MetadataReader::MachOFormat:
+                    return locateInMachO(src, name, offset, size);
+                case MetadataReader::PeFormat:
+                    return locateInPE(src, name, offset, size);
+                default:
+                    break;
+            }
+            return false;
+        }
+
+        bool read(DataSource &src, const char *name, std::string *out) {
+            uint64_t offset, size;
+            return locate(src, name, &offset, &size) && src.readString(offset, size, out);
+        }
+
+        // Resources
+
+        static constexpr const uint32_t RESOURCES_MAGIC = 0x4352534C; // "LSRC"
+        static constexpr const uint32_t RESOURCES_VERSION = 1;
+        static constexpr const size_t RESOURCES_HEADER_SIZE = 16;
+        static constexpr const size_t RESOURCES_ENTRY_SIZE = 24;
+
+        bool findResource(DataSource &src, uint64_t base, uint64_t size, const char *resource,
+                          std::vector<std::string> *names, uint64_t *offset, uint64_t *length) {
+            unsigned char header[RESOURCES_HEADER_SIZE];
+            if (size < sizeof(header) || !src.read(base, header, sizeof(header)) ||
+                get32(header, false) != RESOURCES_MAGIC ||
+                get32(header + 4, false) != RESOURCES_VERSION) {
+                return false;
+            }
+            const uint64_t count = get32(header + 8, false);
+            const uint64_t namesSize = get32(header + 12, false);
+            const uint64_t indexSize = count * RESOURCES_ENTRY_SIZE + namesSize;
+            if (indexSize > size - sizeof(header)) {
+                return false;
+            }
+
+            // The entries and the names are read at once, the data is left alone
+            std::string index;
+            if (!src.readString(base + sizeof(header), size_t(indexSize), &index)) {
+                return false;
+            }
+            auto p = reinterpret_cast<const unsigned char *>(index.data());
+            const uint64_t namesStart = sizeof(header) + count * RESOURCES_ENTRY_SIZE;
+            for (uint64_t i = 0; i < count; ++i, p += RESOURCES_ENTRY_SIZE) {
+                const uint64_t nameOffset = get32(p, false);
+                const uint64_t nameSize = get32(p + 4, false);
+                const uint64_t dataOffset = get64(p + 8, false);
+                const uint64_t dataSize = get64(p + 16, false);
+                if (nameOffset < namesStart || nameSize > namesSize ||
+                    nameOffset - namesStart > namesSize - nameSize || dataOffset > size ||
+                    dataSize > size - dataOffset) {
+                    return false;
+                }
+                const char *name = index.data() + (nameOffset - sizeof(header));
+                if (names) {
+                    names->emplace_back(name, size_t(nameSize));
+                }
+                if (resource && strlen(resource) == nameSize &&
+                    memcmp(resource, name, size_t(nameSize)) == 0) {
+                    *offset = base + dataOffset;
+                    *length = dataSize;
+                    return true;
+                }
+            }
+            return names != nullptr;
+        }
+
+        void splitResourceNames(const char *data, size_t size, std::vector<std::string> *names) {
+            size_t start = 0;
+            for (size_t i = 0; i <= size; ++i) {
+                if (i == size || data[i] == '|' || data[i] == '\0') {
+                    if (i > start) {
+                        names->emplace_back(data + start, i - start);
+                    }
+                    start = i + 1;
+                }
+            }
+        }
+
+        // PE plugins keep each resource in an RCDATA of its own, listed by the index RCDATA
+        static bool peResourceNames(DataSource &src, std::vector<std::string> *names) {
+            std::string index;
+            if (!readFromPE(src, MetadataReader::ResourcesName, &index)) {
+                return false;
+            }
+            splitResourceNames(index.data(), index.size(), names);
+            return true;
+        }
+
+        bool readResource(DataSource &src, const char *resource, std::string *out) {
+            if (detectFormat(src) == MetadataReader::PeFormat) {
+                std::vector<std::string> names;
+                if (!peResourceNames(src, &names)) {
+                    return false;
+                }
+                auto it = std::find(names.begin(), names.end(), resource);
+                if (it == names.end()) {
+                    return false;
+                }
+                const std::string name =
+                    "loadso_resource_" + std::to_string(it - names.begin());
+                return readFromPE(src, name.data(), out);
+            }
+
+            uint64_t base, size, offset, length;
+            return locate(src, MetadataReader::ResourcesName, &base, &size) &&
+                   findResource(src, base, size, resource, nullptr, &offset, &length) &&
+                   src.readString(offset, size_t(length), out);
+        }
+
+        bool readResourceNames(DataSource &src, std::vector<std::string> *names) {
+            names->clear();
+            if (detectFormat(src) == MetadataReader::PeFormat) {
+                return peResourceNames(src, names);
+            }
+            uint64_t base, size;
+            return locate(src, MetadataReader::ResourcesName, &base, &size) &&
+                   findResource(src, base, size, nullptr, names, nullptr, nullptr);
+        }
+
+    }
+
+    MetadataReader::Format MetadataReader::DetectFormat(const void *data, size_t size) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::detectFormat(src);
+    }
+
+    bool MetadataReader::ReadFromELF(const void *data, size_t size, std::string *out,
+                                     const char *name) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::readFromELF(src, name, out);
+    }
+
+    bool MetadataReader::ReadFromMachO(const void *data, size_t size, std::string *out,
+                                       const char *name) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::readFromMachO(src, name, out);
+    }
+
+    bool MetadataReader::ReadFromPE(const void *data, size_t size, std::string *out,
+                                    const char *name) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::readFromPE(src, name, out);
+    }
+
+    bool MetadataReader::Read(const void *data, size_t size, std::string *out,
+                              const char *name) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::read(src, name, out);
+    }
+
+    bool MetadataReader::ReadInfo(const void *data, size_t size, FileInfo *info,
+                                  const char *name) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::readInfo(src, name, info);
+    }
+
+    bool MetadataReader::ReadFileInfo(const PathString &path, FileInfo *info, const char *name) {
+        FileSource src(path);
+        if (!src.isOpen()) {
+            *info = {};
+            return false;
+        }
+        return MetadataReaderPrivate::readInfo(src, name, info);
+    }
+
+    bool MetadataReader::ReadFile(const PathString &path, std::string *out, const char *name) {
+        FileSource src(path);
+        if (!src.isOpen()) {
+            return false;
+        }
+        return MetadataReaderPrivate::read(src, name, out);
+    }
+
+    bool MetadataReader::ReadResource(const void *data, size_t size, const char *resource,
+                                      std::string *out) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::readResource(src, resource, out);
+    }
+
+    bool MetadataReader::ReadFileResource(const PathString &path, const char *resource,
+                                          std::string *out) {
+        FileSource src(path);
+        if (!src.isOpen()) {
+            return false;
+        }
+        return MetadataReaderPrivate::readResource(src, resource, out);
+    }
+
+    bool MetadataReader::ReadResourceNames(const void *data, size_t size,
+                                           std::vector<std::string> *names) {
+        BufferSource src(data, size);
+        return MetadataReaderPrivate::readResourceNames(src, names);
+    }
+
+    bool MetadataReader::ReadFileResourceNames(const PathString &path,
+                                               std::vector<std::string> *names) {
+        FileSource src(path);
+        if (!src.isOpen()) {
+            names->clear();
+            return false;
+        }
+        return MetadataReaderPrivate::readResourceNames(src, names);
+    }
+
+    size_t MetadataReader::ReadFilesInfo(const std::vector<PathString> &paths,
+                                         std::vector<FileInfo> *infos,
+                                         std::vector<bool> *succeeded, const char *name,
+                                         IoBackend backend) {
+        infos->assign(paths.size(), {});
+        std::vector<bool> ok(paths.size(), false);
+
+#ifdef _WIN32
+        (void) backend;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            ok[i] = ReadFileInfo(paths[i], &(*infos)[i], name);
+        }
+#else
+        // Files open at once, bounds the descriptors and the blocks held in memory
+        static const size_t WindowSize = 1024;
+
+        // Rounds after which a file is read synchronously, the formats need far less
+        static const int MaxRounds = 16;
+
+        struct Pending {
+            size_t index;
+            int fd;
+            BlockSource src;
+            int rounds;
+        };
+
+        auto batch = IoBatch::create(backend);
+        for (size_t begin = 0; begin < paths.size(); begin += WindowSize) {
+            const size_t end = std::min(paths.size(), begin + WindowSize);
+
+            std::vector<Pending> pending;
+            for (size_t i = begin; i < end; ++i) {
+                int fd = ::open(paths[i].data(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    continue;
+                }
+                struct stat st;
+                if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+                    ::close(fd);
+                    continue;
+                }
+                pending.push_back({i, fd, BlockSource(uint64_t(st.st_size)), 0});
+
+                // Speculate on the first round: the headers, and the ELF section headers at
+                // the end of the file
+                auto &src = pending.back().src;
+                src.missing.insert(0);
+                src.missing.insert((src.size() - 1) / BlockSource::BlockSize);
+            }
+
+            while (!pending.empty()) {
+                // Fetch every block the last round asked for in one batch
+                std::vector<IoBatch::Request> requests;
+                std::vector<size_t> owners;
+                for (size_t i = 0; i < pending.size(); ++i) {
+                    auto &item = pending[i];
+                    for (auto block : item.src.missing) {
+                        auto &buf = item.src.blocks[block];
+                        buf.resize(item.src.blockLength(block));
+                        requests.push_back({item.fd, block * BlockSource::BlockSize, &buf[0],
+                                            buf.size(), 0});
+                        owners.push_back(i);
+                    }
+                    item.src.missing.clear();
+                }
+                batch->run(requests);
+
+                std::vector<bool> failed(pending.size(), false);
+                for (size_t i = 0; i < requests.size(); ++i) {
+                    if (requests[i].result != static_cast<long long>(requests[i].size)) {
+                        failed[owners[i]] = true;
+                    }
+                }
+
+                // Rerun the parsers, those that touched no absent block are done
+                std::vector<Pending> next;
+                for (size_t i = 0; i < pending.size(); ++i) {
+                    auto &item = pending[i];
+                    auto &info = (*infos)[item.index];
+                    bool done = true;
+                    if (!failed[i]) {
+                        info = {};
+                        const bool res = MetadataReaderPrivate::readInfo(item.src, name, &info);
+                        if (item.src.missing.empty()) {
+                            ok[item.index] = res;
+                        } else if (++item.rounds < MaxRounds) {
+                            done = false;
+                        } else {
+                            ok[item.index] = ReadFileInfo(paths[item.index], &info, name);
+                        }
+                    }
+                    if (done) {
+                        ::close(item.fd);
+                        if (!ok[item.index]) {
+                            info = {};
+                        }
+                    } else {
+                        next.push_back(std::move(item));
+                    }
+                }
+                pending = std::move(next);
+            }
+        }
+#endif
+
+        if (succeeded) {
+            *succeeded = ok;
+        }
+        return size_t(std::count(ok.begin(), ok.end(), true));
+    }
+
+    MetadataReader::IoBackend MetadataReader::DefaultIoBackend() {
+#ifdef _WIN32
+        return PreadBackend;
+#else
+        static const IoBackend backend = IoBatch::create(AutoBackend)->backend();
+        return backend;
+#endif
+    }
+
+}
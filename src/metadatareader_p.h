@@ -0,0 +1,214 @@
+#ifndef METADATAREADER_P_H
+#define METADATAREADER_P_H
+
+#include <cstdint>
+#include <fstream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "metadatareader.h"
+
+namespace LoadSO {
+
+    /**
+     * @brief Random access byte source that the format parsers read from.
+     */
+    class DataSource {
+    public:
+        virtual ~DataSource() = default;
+
+        virtual uint64_t size() const = 0;
+        virtual bool read(uint64_t offset, void *buf, size_t size) = 0;
+
+        bool readString(uint64_t offset, size_t size, std::string *out);
+        bool readCString(uint64_t offset, std::string *out, size_t maxSize = 4096);
+    };
+
+    class BufferSource : public DataSource {
+    public:
+        BufferSource(const void *data, size_t size)
+            : _data(static_cast<const unsigned char *>(data)), _size(size) {
+        }
+
+        uint64_t size() const override;
+        bool read(uint64_t offset, void *buf, size_t size) override;
+
+    protected:
+        const unsigned char *_data;
+        size_t _size;
+    };
+
+    class SubSource : public DataSource {
+    public:
+        SubSource(DataSource &src, uint64_t offset, uint64_t size)
+            : _src(src), _offset(offset), _size(size) {
+        }
+
+        uint64_t size() const override;
+        bool read(uint64_t offset, void *buf, size_t size) override;
+
+    protected:
+        DataSource &_src;
+        uint64_t _offset;
+        uint64_t _size;
+    };
+
+    class FileSource : public DataSource {
+    public:
+        explicit FileSource(const PathString &path);
+
+        bool isOpen() const;
+
+        uint64_t size() const override;
+        bool read(uint64_t offset, void *buf, size_t size) override;
+
+    protected:
+        std::ifstream _file;
+        uint64_t _size = 0;
+    };
+
+    /**
+     * @brief Serves reads from blocks fetched ahead, a read touching an absent block fails and
+     *        records the block, so that a parser can be rerun once the blocks were fetched.
+     */
+    class BlockSource : public DataSource {
+    public:
+        static constexpr const size_t BlockSize = 16384;
+
+        explicit BlockSource(uint64_t size) : _size(size) {
+        }
+
+        uint64_t size() const override;
+        bool read(uint64_t offset, void *buf, size_t size) override;
+
+        size_t blockLength(uint64_t block) const;
+
+        std::unordered_map<uint64_t, std::string> blocks;
+        std::set<uint64_t> missing;
+
+    protected:
+        uint64_t _size;
+    };
+
+    namespace MetadataReaderPrivate {
+
+        struct ElfSection {
+            std::string name;
+            uint32_t type;
+            uint64_t flags;
+            uint64_t addr;
+            uint64_t offset;
+            uint64_t size;
+            uint32_t link;
+            uint32_t info;
+            uint64_t entsize;
+        };
+
+        struct ElfInfo {
+            bool is64 = false;
+            bool bigEndian = false;
+            uint16_t machine = 0;
+            std::vector<ElfSection> sections;
+        };
+
+        struct MachOSection {
+            std::string segname;
+            std::string sectname;
+            uint64_t offset;
+            uint64_t size;
+            uint32_t flags;
+        };
+
+        struct MachOCommand {
+            uint32_t cmd;
+            uint64_t offset;
+            uint32_t size;
+        };
+
+        struct MachOInfo {
+            bool is64 = false;
+            bool bigEndian = false;
+            uint32_t cputype = 0;
+            std::vector<MachOSection> sections;
+            std::vector<MachOCommand> commands;
+        };
+
+        struct PeSection {
+            std::string name;
+            uint32_t virtualSize;
+            uint32_t virtualAddress;
+            uint32_t rawSize;
+            uint32_t rawOffset;
+        };
+
+        struct PeInfo {
+            bool is64 = false;
+            uint16_t machine = 0;
+            std::vector<PeSection> sections;
+            std::vector<std::pair<uint32_t, uint32_t>> dataDirectories; // (rva, size)
+
+            bool rvaToOffset(uint32_t rva, uint64_t *offset) const;
+        };
+
+        uint16_t get16(const unsigned char *p, bool bigEndian);
+        uint32_t get32(const unsigned char *p, bool bigEndian);
+        uint64_t get64(const unsigned char *p, bool bigEndian);
+
+        bool parseELF(DataSource &src, ElfInfo *info);
+        bool parseMachO(DataSource &src, MachOInfo *info);
+        bool parsePE(DataSource &src, PeInfo *info);
+
+        /**
+         * @brief Enumerates the slices of a fat Mach-O file as (offset, size) pairs, a thin file
+         *        gives a single slice covering the whole source.
+         */
+        bool machOSlices(DataSource &src, std::vector<std::pair<uint64_t, uint64_t>> *slices);
+
+        MetadataReader::Format detectFormat(DataSource &src);
+
+        bool readFromELF(DataSource &src, const char *name, std::string *out);
+        bool readFromMachO(DataSource &src, const char *name, std::string *out);
+        bool readFromPE(DataSource &src, const char *name, std::string *out);
+
+        bool read(DataSource &src, const char *name, std::string *out);
+
+        /**
+         * @brief Finds a named resource, returns its offset and size in the source.
+         */
+        bool locateInELF(DataSource &src, const char *name, uint64_t *offset, uint64_t *size);
+        bool locateInMachO(DataSource &src, const char *name, uint64_t *offset,
+                           uint64_t *size);
+        bool locateInPE(DataSource &src, const char *name, uint64_t *offset, uint64_t *size);
+        bool locate(DataSource &src, const char *name, uint64_t *offset, uint64_t *size);
+
+        /**
+         * @brief Looks a resource up in the index of a resource table at \c base. With \c names,
+         *        collects the names of the entries before the match, or of all entries.
+         */
+        bool findResource(DataSource &src, uint64_t base, uint64_t size, const char *resource,
+                          std::vector<std::string> *names, uint64_t *offset, uint64_t *length);
+
+        /**
+         * @brief Splits the name list of the PE index RCDATA, separated by '|'.
+         */
+        void splitResourceNames(const char *data, size_t size, std::vector<std::string> *names);
+
+        bool readResource(DataSource &src, const char *resource, std::string *out);
+        bool readResourceNames(DataSource &src, std::vector<std::string> *names);
+
+        bool readSymbolsFromELF(DataSource &src, std::vector<std::string> *exports,
+                                std::vector<std::string> *dependencies);
+        bool readSymbolsFromMachO(DataSource &src, std::vector<std::string> *exports,
+                                  std::vector<std::string> *dependencies);
+        bool readSymbolsFromPE(DataSource &src, std::vector<std::string> *exports,
+                               std::vector<std::string> *dependencies);
+
+        bool readInfo(DataSource &src, const char *name, MetadataReader::FileInfo *info);
+
+    }
+
+}
+
+#endif // METADATAREADER_P_H
@@ -0,0 +1,355 @@
+#include "pluginbundle.h"
+#include "pluginbundle_p.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+
+#include "filedigest.h"
+#include "system.h"
+#include "metadatareader_p.h"
+
+#ifdef _WIN32
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// Layout, all integers little endian:
+//   magic[8] version:u32 reserved:u32 tableOffset:u64 tableSize:u64
+//   member data, each aligned to LOADSO_BUNDLE_ALIGNMENT
+//   table: count:u32 count * { name:str offset:u64 size:u64 } indexSize:u64 index[indexSize]
+// where str is len:u32 followed by len bytes and index is the PluginIndex data.
+#define LOADSO_BUNDLE_MAGIC     "LSOBUNDL"
+#define LOADSO_BUNDLE_VERSION   1
+#define LOADSO_BUNDLE_ALIGNMENT 4096
+
+namespace LoadSO {
+
+    using MetadataReaderPrivate::get32;
+    using MetadataReaderPrivate::get64;
+
+    static const size_t HeaderSize = 32;
+
+    static void putInt(std::string *out, uint64_t val, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out->push_back(static_cast<char>((val >> (i * 8)) & 0xFF));
+        }
+    }
+
+    static bool replaceFile(const PathString &from, const PathString &to) {
+#ifdef _WIN32
+        return ::MoveFileExW(from.data(), to.data(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return ::rename(from.data(), to.data()) == 0;
+#endif
+    }
+
+    static void removeFile(const PathString &path) {
+#ifdef _WIN32
+        ::DeleteFileW(path.data());
+#else
+        ::unlink(path.data());
+#endif
+    }
+
+#ifndef __linux__
+    static PathString tempPath(const std::string &name) {
+        std::string base = name;
+        for (auto &ch : base) {
+            if (ch == '/' || ch == '\\' || ch == ':')
+                ch = '_';
+        }
+#  ifdef _WIN32
+        wchar_t buf[MAX_PATH + 1];
+        const DWORD len = ::GetTempPathW(MAX_PATH + 1, buf);
+        PathString dir(buf, len);
+        return dir + L"loadso-" + std::to_wstring(::GetCurrentProcessId()) + L"-" +
+               System::MultiToPathString(base);
+#  else
+        const char *dir = getenv("TMPDIR");
+        return std::string(dir && *dir ? dir : "/tmp") + "/loadso-" +
+               std::to_string(getpid()) + "-" + base;
+#  endif
+    }
+#endif
+
+    PluginBundle::Impl::~Impl() {
+        unmap();
+    }
+
+    bool PluginBundle::Impl::map(const PathString &path) {
+#ifdef _WIN32
+        HANDLE hFile = ::CreateFileW(path.data(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(hFile, &size) || size.QuadPart < LONGLONG(HeaderSize)) {
+            ::CloseHandle(hFile);
+            return false;
+        }
+        hMapping = ::CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        ::CloseHandle(hFile);
+        if (!hMapping) {
+            return false;
+        }
+        view = static_cast<const unsigned char *>(
+            ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+        if (!view) {
+            ::CloseHandle(hMapping);
+            hMapping = nullptr;
+            return false;
+        }
+        viewSize = size_t(size.QuadPart);
+#else
+        int fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < off_t(HeaderSize)) {
+            ::close(fd);
+            return false;
+        }
+        void *addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        view = static_cast<const unsigned char *>(addr);
+        viewSize = size_t(st.st_size);
+#endif
+        return true;
+    }
+
+    void PluginBundle::Impl::unmap() {
+        if (!view) {
+            return;
+        }
+#ifdef _WIN32
+        ::UnmapViewOfFile(view);
+        ::CloseHandle(hMapping);
+        hMapping = nullptr;
+#else
+        ::munmap(const_cast<unsigned char *>(view), viewSize);
+#endif
+        view = nullptr;
+        viewSize = 0;
+        index.clear();
+        members.clear();
+    }
+
+    bool PluginBundle::Impl::parse() {
+        if (memcmp(view, LOADSO_BUNDLE_MAGIC, 8) != 0 ||
+            get32(view + 8, false) != LOADSO_BUNDLE_VERSION) {
+            return false;
+        }
+        const uint64_t tableOffset = get64(view + 16, false);
+        const uint64_t tableSize = get64(view + 24, false);
+        if (tableOffset > viewSize || tableSize > viewSize - tableOffset) {
+            return false;
+        }
+
+        auto p = view + tableOffset;
+        const auto end = p + tableSize;
+        auto need = [&](uint64_t n) { return uint64_t(end - p) >= n; };
+        if (!need(4)) {
+            return false;
+        }
+        const uint32_t count = get32(p, false);
+        p += 4;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!need(4)) {
+                return false;
+            }
+            const uint32_t len = get32(p, false);
+            p += 4;
+            if (!need(uint64_t(len) + 16)) {
+                return false;
+            }
+            std::string name(reinterpret_cast<const char *>(p), len);
+            p += len;
+            Range range{get64(p, false), get64(p + 8, false)};
+            p += 16;
+            if (range.offset > viewSize || range.size > viewSize - range.offset) {
+                return false;
+            }
+            members[name] = range;
+        }
+
+        if (!need(8)) {
+            return false;
+        }
+        const uint64_t indexSize = get64(p, false);
+        p += 8;
+        return need(indexSize) && index.fromData(p, size_t(indexSize));
+    }
+
+    PluginBundle::PluginBundle() : _impl(new Impl()) {
+    }
+
+    PluginBundle::~PluginBundle() = default;
+
+    PluginBundle::PluginBundle(PluginBundle &&other) noexcept {
+        std::swap(_impl, other._impl);
+    }
+
+    PluginBundle &PluginBundle::operator=(PluginBundle &&other) noexcept {
+        if (this == &other)
+            return *this;
+        std::swap(_impl, other._impl);
+        return *this;
+    }
+
+    bool PluginBundle::Pack(const PathString &output, const std::vector<Member> &members,
+                            const char *name) {
+        // Members are looked up by name, a duplicate would shadow the other silently
+        std::set<std::string> names;
+        for (const auto &member : members) {
+            if (!names.insert(member.name).second) {
+                return false;
+            }
+        }
+
+        // Written aside and renamed over the output, so a failure never leaves a partial bundle
+        const PathString temp = output + LOADSO_STR(".tmp");
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        auto fail = [&]() {
+            out.close();
+            removeFile(temp);
+            return false;
+        };
+
+        std::string header(HeaderSize, '\0');
+        out.write(header.data(), std::streamsize(header.size()));
+
+        PluginIndex index;
+        std::string table;
+        putInt(&table, members.size(), 4);
+        uint64_t offset = HeaderSize;
+        for (const auto &member : members) {
+            std::ifstream file(member.path, std::ios::binary);
+            if (!file) {
+                return fail();
+            }
+            std::string data((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+
+            PluginIndex::Entry entry;
+            entry.path = member.name;
+            if (!MetadataReader::ReadInfo(data.data(), data.size(), &entry.info, name)) {
+                entry.info = {};
+            }
+            entry.digest = FileDigest::Hash(data.data(), data.size());
+            index.addEntry(std::move(entry));
+
+            // Page aligned members can be mapped on their own
+            const uint64_t aligned = (offset + LOADSO_BUNDLE_ALIGNMENT - 1) /
+                                     LOADSO_BUNDLE_ALIGNMENT * LOADSO_BUNDLE_ALIGNMENT;
+            std::string padding(size_t(aligned - offset), '\0');
+            out.write(padding.data(), std::streamsize(padding.size()));
+            out.write(data.data(), std::streamsize(data.size()));
+            offset = aligned + data.size();
+
+            putInt(&table, member.name.size(), 4);
+            table.append(member.name);
+            putInt(&table, aligned, 8);
+            putInt(&table, data.size(), 8);
+        }
+
+        const auto indexData = index.toData();
+        putInt(&table, indexData.size(), 8);
+        table.append(indexData);
+        out.write(table.data(), std::streamsize(table.size()));
+
+        header.clear();
+        header.append(LOADSO_BUNDLE_MAGIC, 8);
+        putInt(&header, LOADSO_BUNDLE_VERSION, 4);
+        putInt(&header, 0, 4);
+        putInt(&header, offset, 8);
+        putInt(&header, table.size(), 8);
+        out.seekp(0);
+        out.write(header.data(), std::streamsize(header.size()));
+        out.close();
+        if (!out || !replaceFile(temp, output)) {
+            return fail();
+        }
+        return true;
+    }
+
+    bool PluginBundle::open(const PathString &path) {
+        close();
+        if (!_impl->map(path)) {
+            return false;
+        }
+        if (!_impl->parse()) {
+            _impl->unmap();
+            return false;
+        }
+        return true;
+    }
+
+    void PluginBundle::close() {
+        _impl->unmap();
+    }
+
+    bool PluginBundle::isOpen() const {
+        return _impl->view != nullptr;
+    }
+
+    const PluginIndex &PluginBundle::index() const {
+        return _impl->index;
+    }
+
+    bool PluginBundle::data(const std::string &name, const void **data, size_t *size) const {
+        auto it = _impl->members.find(name);
+        if (it == _impl->members.end()) {
+            return false;
+        }
+        *data = _impl->view + it->second.offset;
+        *size = size_t(it->second.size);
+        return true;
+    }
+
+    bool PluginBundle::extract(const std::string &name, const PathString &path) const {
+        const void *buf;
+        size_t size;
+        if (!data(name, &buf, &size)) {
+            return false;
+        }
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(static_cast<const char *>(buf), std::streamsize(size));
+        return file.good();
+    }
+
+    bool PluginBundle::load(const std::string &name, PluginLoader *loader, int hints) const {
+        const void *buf;
+        size_t size;
+        if (!data(name, &buf, &size)) {
+            return false;
+        }
+#ifdef __linux__
+        return loader->loadFromMemory(buf, size, hints, name.data());
+#else
+        // The extracted file is left in place, the loaded library keeps it open
+        const auto path = tempPath(name);
+        if (!extract(name, path)) {
+            return false;
+        }
+        loader->setPath(path);
+        return loader->load(hints);
+#endif
+    }
+
+}
@@ -0,0 +1,36 @@
+#ifndef PLUGINBUNDLE_P_H
+#define PLUGINBUNDLE_P_H
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "pluginbundle.h"
+
+namespace LoadSO {
+
+    class PluginBundle::Impl {
+    public:
+        ~Impl();
+
+        struct Range {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        const unsigned char *view = nullptr;
+        size_t viewSize = 0;
+#ifdef _WIN32
+        void *hMapping = nullptr;
+#endif
+
+        PluginIndex index;
+        std::unordered_map<std::string, Range> members;
+
+        bool map(const PathString &path);
+        void unmap();
+        bool parse();
+    };
+
+}
+
+#endif // PLUGINBUNDLE_P_H
@@ -0,0 +1,906 @@
+#include "pluginhost.h"
+#include "pluginhost_p.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <tuple>
+
+#ifdef LOADSO_PLUGIN_HOST
+#  include <cerrno>
+#  include <csignal>
+#  include <linux/futex.h>
+#  include <poll.h>
+#  include <sys/mman.h>
+#  include <sys/prctl.h>
+#  include <sys/signalfd.h>
+#  include <sys/socket.h>
+#  include <sys/syscall.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+#include "system.h"
+
+namespace LoadSO {
+
+    static constexpr const size_t MinRingSize = 4096;
+
+#ifdef LOADSO_PLUGIN_HOST
+
+    using namespace PluginHostPrivate;
+
+    // How long a side sleeps before it checks whether the other side is still alive
+    static constexpr const int SliceMs = 10;
+
+    static inline size_t padded(size_t size) {
+        return (size + sizeof(Message) - 1) & ~(sizeof(Message) - 1);
+    }
+
+    static inline void cpuRelax() {
+#  if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#  endif
+    }
+
+    // Spinning only helps when the other side runs on another CPU
+    static int spinCount() {
+        static const int count = std::thread::hardware_concurrency() > 1 ? 4000 : 0;
+        return count;
+    }
+
+    static void notify(Event &event) {
+        event.seq.fetch_add(1);
+        if (event.waiters.load() != 0) {
+            ::syscall(SYS_futex, &event.seq, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+    // Spins, then sleeps on the event for at most a time slice, returns the final predicate
+    template <class Pred>
+    static bool waitFor(Event &event, Pred pred, int ms) {
+        for (int i = spinCount(); i > 0; --i) {
+            if (pred()) {
+                return true;
+            }
+            cpuRelax();
+        }
+        const uint32_t seq = event.seq.load();
+        event.waiters.fetch_add(1);
+        if (!pred()) {
+            // A notify between the load and the wait changes the word, the wait returns at once
+            struct timespec timeout = {ms / 1000, (ms % 1000) * 1000000L};
+            ::syscall(SYS_futex, &event.seq, FUTEX_WAIT, seq, &timeout, nullptr, 0);
+        }
+        event.waiters.fetch_sub(1);
+        return pred();
+    }
+
+    // Producer side, finds room for a message of at most \c size bytes
+    static bool reserveSlot(Ring &ring, char *buf, size_t cap, size_t size, Slot *slot) {
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+        const size_t offset = size_t(head & (cap - 1));
+        const size_t total = sizeof(Message) + padded(size);
+        const size_t pad = offset + total > cap ? cap - offset : 0;
+        if (cap - size_t(head - tail) < pad + total) {
+            return false;
+        }
+        if (pad > 0) {
+            auto wrap = reinterpret_cast<Message *>(buf + offset);
+            wrap->size = 0;
+            wrap->flags = WrapFlag;
+        }
+        slot->message = reinterpret_cast<Message *>(buf + (offset + pad) % cap);
+        slot->head = head;
+        slot->pad = pad;
+        return true;
+    }
+
+    static void commit(Ring &ring, const Slot &slot) {
+        const uint64_t next = slot.head + slot.pad + sizeof(Message) + padded(slot.message->size);
+        ring.head.store(next, std::memory_order_release);
+        notify(ring.data);
+    }
+
+    // Consumer side, returns the oldest message or \c nullptr if the ring is empty
+    static Message *peek(Ring &ring, char *buf, size_t cap) {
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        while (ring.head.load(std::memory_order_acquire) != tail) {
+            const size_t offset = size_t(tail & (cap - 1));
+            auto message = reinterpret_cast<Message *>(buf + offset);
+            if (!(message->flags & WrapFlag)) {
+                return message;
+            }
+            tail += cap - offset;
+            ring.tail.store(tail, std::memory_order_release);
+        }
+        return nullptr;
+    }
+
+    // Host side of peek(), nothing the helper wrote is trusted. Returns the oldest message and
+    // its size as read once, or \c nullptr with \c corrupt set if the ring doesn't hold together.
+    static Message *peekChecked(Ring &ring, char *buf, size_t cap, size_t *size, bool *corrupt) {
+        const size_t maxSize = cap / 2 - sizeof(Message);
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        *corrupt = false;
+        for (;;) {
+            const uint64_t head = ring.head.load(std::memory_order_acquire);
+            if (head == tail) {
+                return nullptr;
+            }
+            const uint64_t used = head - tail;
+            const size_t offset = size_t(tail & (cap - 1));
+            auto message = reinterpret_cast<Message *>(buf + offset);
+            const uint32_t flags = message->flags;
+            if (used > cap || used < sizeof(Message) || (flags & ~uint32_t(WrapFlag))) {
+                break;
+            }
+            if (flags & WrapFlag) {
+                if (used < cap - offset) {
+                    break;
+                }
+                tail += cap - offset;
+                ring.tail.store(tail, std::memory_order_release);
+                continue;
+            }
+            *size = message->size;
+            const size_t total = sizeof(Message) + padded(*size);
+            if (*size > maxSize || offset + total > cap || total > used) {
+                break;
+            }
+            return message;
+        }
+        *corrupt = true;
+        return nullptr;
+    }
+
+    static void release(Ring &ring, size_t size) {
+        const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        ring.tail.store(tail + sizeof(Message) + padded(size), std::memory_order_release);
+        notify(ring.space);
+    }
+
+    static bool isEmpty(const Ring &ring) {
+        return ring.head.load(std::memory_order_acquire) ==
+               ring.tail.load(std::memory_order_relaxed);
+    }
+
+    static std::string describeExit(int status) {
+        char buf[128];
+        if (status == -1) {
+            return "plugin host zygote exited";
+        }
+        if (WIFSIGNALED(status)) {
+            snprintf(buf, sizeof(buf), "plugin host crashed with signal %d (%s)",
+                     WTERMSIG(status), strsignal(WTERMSIG(status)));
+        } else {
+            snprintf(buf, sizeof(buf), "plugin host exited with code %d", WEXITSTATUS(status));
+        }
+        return buf;
+    }
+
+    static void reap(int pid) {
+        while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+        }
+    }
+
+    static bool readAll(int fd, void *buf, size_t size) {
+        auto p = static_cast<char *>(buf);
+        while (size > 0) {
+            auto n = ::read(fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+
+    static bool writeAll(int fd, const void *buf, size_t size) {
+        auto p = static_cast<const char *>(buf);
+        while (size > 0) {
+            auto n = ::write(fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+
+    // Requests to the zygote, it answers a launch with the helper pid or -errno and reports the
+    // wait status once the helper has exited
+    enum ZygoteCommand : char {
+        LaunchCommand = 'L',
+        KillCommand = 'K',
+    };
+
+#endif
+
+    PluginHost::Impl::~Impl() {
+        shutdown();
+        unmap();
+    }
+
+    bool PluginHost::Impl::startZygote() {
+#ifdef LOADSO_PLUGIN_HOST
+        if (shared && mappedRingSize != ringSize) {
+            unmap();
+        }
+        const size_t headerSize = (sizeof(Shared) + 63) & ~size_t(63);
+        if (!shared) {
+            mappingSize = headerSize + 2 * ringSize;
+            void *addr = ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (addr == MAP_FAILED) {
+                error = strerror(errno);
+                return false;
+            }
+            shared = static_cast<Shared *>(addr);
+            buffers = static_cast<char *>(addr) + headerSize;
+            mappedRingSize = ringSize;
+        }
+
+        int sv[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0) {
+            error = strerror(errno);
+            return false;
+        }
+
+        // Don't let the zygote flush what the host has buffered
+        const int hostPid = ::getpid();
+        ::fflush(nullptr);
+        const int pid = ::fork();
+        if (pid < 0) {
+            error = strerror(errno);
+            ::close(sv[0]);
+            ::close(sv[1]);
+            return false;
+        }
+        if (pid == 0) {
+            ::close(sv[0]);
+            zygoteFd = sv[1];
+            zygoteMain(hostPid);
+        }
+        ::close(sv[1]);
+        zygoteFd = sv[0];
+        zygotePid = pid;
+        return true;
+#else
+        error = "plugin host is only supported on Linux";
+        return false;
+#endif
+    }
+
+    void PluginHost::Impl::stopZygote() {
+#ifdef LOADSO_PLUGIN_HOST
+        if (zygoteFd < 0) {
+            return;
+        }
+
+        // The zygote exits when the socket is shut down, zygotes of other hosts may hold copies
+        // of this end so closing it isn't enough
+        ::shutdown(zygoteFd, SHUT_RDWR);
+        ::close(zygoteFd);
+        zygoteFd = -1;
+        reap(zygotePid);
+        zygotePid = -1;
+#endif
+    }
+
+    bool PluginHost::Impl::launch() {
+#ifdef LOADSO_PLUGIN_HOST
+        // The previous helper is gone, whatever it left in the rings is dropped
+        new (shared) Shared();
+        replyHeld = false;
+
+        const char cmd = LaunchCommand;
+        int32_t pid;
+        if (zygoteFd < 0 || !writeAll(zygoteFd, &cmd, sizeof(cmd)) ||
+            !readAll(zygoteFd, &pid, sizeof(pid))) {
+            error = describeExit(-1);
+            stopZygote();
+            return false;
+        }
+        if (pid < 0) {
+            error = strerror(-pid);
+            return false;
+        }
+        helperPid = pid;
+
+        // Wait until the plugin is loaded
+        const auto deadline = std::chrono::steady_clock::now() + callTimeout;
+        auto loaded = [this]() { return shared->state.load() != Starting; };
+        while (!waitFor(shared->stateChanged, loaded, SliceMs)) {
+            int status;
+            if (helperExited(&status, 0)) {
+                helperPid = -1;
+                error = describeExit(status) + " while loading the plugin";
+                return false;
+            }
+            if (callTimeout.count() > 0 && std::chrono::steady_clock::now() > deadline) {
+                killHelper();
+                error = "plugin host timed out while loading the plugin";
+                return false;
+            }
+        }
+        if (shared->state.load() == Failed) {
+            error.assign(shared->error, strnlen(shared->error, sizeof(shared->error)));
+            killHelper();
+            return false;
+        }
+        return true;
+#else
+        error = "plugin host is only supported on Linux";
+        return false;
+#endif
+    }
+
+    void PluginHost::Impl::shutdown() {
+#ifdef LOADSO_PLUGIN_HOST
+        if (helperPid > 0) {
+            shared->stopping.store(1);
+            notify(shared->requests.data);
+
+            // The helper finishes the queued requests first
+            int status;
+            if (helperExited(&status, 100)) {
+                helperPid = -1;
+            } else {
+                killHelper();
+            }
+        }
+        stopZygote();
+#endif
+    }
+
+    void PluginHost::Impl::unmap() {
+#ifdef LOADSO_PLUGIN_HOST
+        if (shared) {
+            ::munmap(shared, mappingSize);
+            shared = nullptr;
+            buffers = nullptr;
+        }
+#endif
+    }
+
+    void PluginHost::Impl::killHelper() {
+#ifdef LOADSO_PLUGIN_HOST
+        if (helperPid < 0) {
+            return;
+        }
+
+        // Only the zygote can tell whether the pid still names the helper
+        const char cmd = KillCommand;
+        int status;
+        if (zygoteFd < 0 || !writeAll(zygoteFd, &cmd, sizeof(cmd))) {
+            stopZygote();
+        } else {
+            helperExited(&status, -1);
+        }
+        helperPid = -1;
+#endif
+    }
+
+    bool PluginHost::Impl::helperExited(int *status, int timeoutMs) {
+#ifdef LOADSO_PLUGIN_HOST
+        if (zygoteFd >= 0) {
+            struct pollfd pfd = {zygoteFd, POLLIN, 0};
+            int n;
+            while ((n = ::poll(&pfd, 1, timeoutMs)) < 0 && errno == EINTR) {
+            }
+            if (n == 0) {
+                return false;
+            }
+            int32_t value;
+            if (n > 0 && readAll(zygoteFd, &value, sizeof(value))) {
+                *status = value;
+                return true;
+            }
+            stopZygote();
+        }
+        *status = -1;
+        return true;
+#else
+        (void) timeoutMs;
+        *status = -1;
+        return true;
+#endif
+    }
+
+    void PluginHost::Impl::recover(const std::string &reason) {
+#ifdef LOADSO_PLUGIN_HOST
+        killHelper();
+        if (maxRestarts >= 0 && restarts >= maxRestarts) {
+            error = reason + ", restart limit reached";
+            return;
+        }
+        restarts++;
+        if (!launch()) {
+            error = reason + ", restart failed: " + error;
+            return;
+        }
+        error = reason;
+#else
+        error = reason;
+#endif
+    }
+
+    bool PluginHost::Impl::checkHelper() {
+#ifdef LOADSO_PLUGIN_HOST
+        int status;
+        if (!helperExited(&status, 0)) {
+            return true;
+        }
+        helperPid = -1;
+        recover(describeExit(status));
+#endif
+        return false;
+    }
+
+    bool PluginHost::Impl::wait(Event &event, const std::function<bool()> &pred,
+                                std::chrono::steady_clock::time_point deadline) {
+#ifdef LOADSO_PLUGIN_HOST
+        while (!waitFor(event, pred, SliceMs)) {
+            if (!checkHelper()) {
+                return false;
+            }
+            if (callTimeout.count() > 0 && std::chrono::steady_clock::now() > deadline) {
+                recover("plugin host call timed out");
+                return false;
+            }
+        }
+        return true;
+#else
+        (void) event;
+        (void) pred;
+        (void) deadline;
+        return false;
+#endif
+    }
+
+    bool PluginHost::Impl::reserveRequest(size_t size, Slot *slot,
+                                          std::chrono::steady_clock::time_point deadline) {
+#ifdef LOADSO_PLUGIN_HOST
+        dropReply();
+        if (helperPid < 0) {
+            error = "plugin host is not running";
+            return false;
+        }
+        if (size > mappedRingSize / 2 - sizeof(Message)) {
+            error = "message is too large";
+            return false;
+        }
+
+        auto &ring = shared->requests;
+        while (!reserveSlot(ring, buffers, mappedRingSize, size, slot)) {
+            const uint64_t tail = ring.tail.load();
+            if (!wait(ring.space, [&]() { return ring.tail.load() != tail; }, deadline)) {
+                return false;
+            }
+        }
+        return true;
+#else
+        (void) size;
+        (void) slot;
+        (void) deadline;
+        error = "plugin host is only supported on Linux";
+        return false;
+#endif
+    }
+
+    void PluginHost::Impl::commitRequest(const Slot &slot, uint32_t method, size_t size,
+                                         uint32_t flags) {
+#ifdef LOADSO_PLUGIN_HOST
+        auto message = slot.message;
+        message->size = uint32_t(size);
+        message->method = method;
+        message->status = 0;
+        message->flags = flags;
+        commit(shared->requests, slot);
+#else
+        (void) slot;
+        (void) method;
+        (void) size;
+        (void) flags;
+#endif
+    }
+
+    bool PluginHost::Impl::send(uint32_t method, const void *data, size_t size, uint32_t flags,
+                                std::chrono::steady_clock::time_point deadline) {
+        Slot slot;
+        if (!reserveRequest(size, &slot, deadline)) {
+            return false;
+        }
+        if (size > 0) {
+            memcpy(slot.message + 1, data, size);
+        }
+        commitRequest(slot, method, size, flags);
+        return true;
+    }
+
+    bool PluginHost::Impl::receive(const void **data, size_t *size, int32_t *status,
+                                   std::chrono::steady_clock::time_point deadline) {
+#ifdef LOADSO_PLUGIN_HOST
+        auto &ring = shared->replies;
+        char *buf = buffers + mappedRingSize;
+        Message *message;
+        size_t messageSize;
+        bool corrupt;
+        while (!(message = peekChecked(ring, buf, mappedRingSize, &messageSize, &corrupt))) {
+            if (corrupt) {
+                recover("plugin host wrote a malformed reply");
+                return false;
+            }
+            if (!wait(ring.data, [&ring]() { return !isEmpty(ring); }, deadline)) {
+                return false;
+            }
+        }
+        *data = message + 1;
+        *size = messageSize;
+        if (status) {
+            *status = message->status;
+        }
+        replyHeld = true;
+        heldReplySize = messageSize;
+        return true;
+#else
+        (void) data;
+        (void) size;
+        (void) status;
+        (void) deadline;
+        error = "plugin host is only supported on Linux";
+        return false;
+#endif
+    }
+
+    void PluginHost::Impl::dropReply() {
+#ifdef LOADSO_PLUGIN_HOST
+        if (replyHeld) {
+            release(shared->replies, heldReplySize);
+            replyHeld = false;
+        }
+#endif
+    }
+
+    void PluginHost::Impl::zygoteMain(int hostPid) {
+#ifdef LOADSO_PLUGIN_HOST
+        // Watch the host process, not the thread that forked us
+        int hostFd = -1;
+#  ifdef SYS_pidfd_open
+        hostFd = int(::syscall(SYS_pidfd_open, hostPid, 0));
+#  endif
+        if (::getppid() != hostPid) {
+            std::_Exit(0);
+        }
+
+        // Only the thread that called start() survived the fork, so helpers forked from here
+        // never inherit a lock some other host thread was holding
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGCHLD);
+        ::sigprocmask(SIG_BLOCK, &mask, nullptr);
+        const int signalFd = ::signalfd(-1, &mask, SFD_CLOEXEC);
+
+        const int zygotePid = ::getpid();
+        int child = -1;
+        struct pollfd fds[3] = {
+            {zygoteFd, POLLIN, 0},
+            {signalFd, POLLIN, 0},
+            {hostFd,   POLLIN, 0}, // Ignored if pidfd_open() is missing
+        };
+        for (;;) {
+            if (::poll(fds, 3, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+
+            // Report the exit before handling a command, the host waits for it to relaunch
+            if (fds[1].revents & POLLIN) {
+                struct signalfd_siginfo info;
+                std::ignore = ::read(signalFd, &info, sizeof(info));
+                int status;
+                int pid;
+                while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+                    if (pid == child) {
+                        child = -1;
+                        int32_t value = status;
+                        writeAll(zygoteFd, &value, sizeof(value));
+                    }
+                }
+            }
+            if (fds[2].revents) {
+                break;
+            }
+            if (!fds[0].revents) {
+                continue;
+            }
+
+            // The host is gone or stopped us when the socket is shut down
+            char cmd;
+            if (!readAll(zygoteFd, &cmd, sizeof(cmd))) {
+                break;
+            }
+            if (cmd == KillCommand) {
+                if (child > 0) {
+                    ::kill(child, SIGKILL);
+                }
+                continue;
+            }
+
+            int32_t pid = ::fork();
+            if (pid == 0) {
+                if (hostFd >= 0) {
+                    ::close(hostFd);
+                }
+                ::close(signalFd);
+                ::close(zygoteFd);
+                zygoteFd = -1;
+                ::sigprocmask(SIG_UNBLOCK, &mask, nullptr);
+                helperMain(zygotePid);
+            }
+            if (pid < 0) {
+                pid = -errno;
+            } else {
+                child = pid;
+            }
+            writeAll(zygoteFd, &pid, sizeof(pid));
+        }
+
+        if (child > 0) {
+            ::kill(child, SIGKILL);
+            reap(child);
+        }
+#endif
+        std::_Exit(0);
+    }
+
+    void PluginHost::Impl::helperMain(int zygotePid) {
+#ifdef LOADSO_PLUGIN_HOST
+        // Don't outlive the zygote, it has a single thread so the signal comes only when it exits
+        ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (::getppid() != zygotePid) {
+            std::_Exit(1);
+        }
+
+        PluginLoader plugin(path);
+        if (!plugin.load(hints)) {
+            snprintf(shared->error, sizeof(shared->error), "%s: %s",
+                     System::MultiFromPathString(path).data(), plugin.lastError().data());
+            shared->state.store(Failed);
+            notify(shared->stateChanged);
+            std::_Exit(1);
+        }
+        shared->state.store(Ready);
+        notify(shared->stateChanged);
+
+        auto &requests = shared->requests;
+        auto &replies = shared->replies;
+        char *requestBuffer = buffers;
+        char *replyBuffer = buffers + mappedRingSize;
+        const size_t maxSize = mappedRingSize / 2 - sizeof(Message);
+        auto pending = [&]() { return !isEmpty(requests) || shared->stopping.load(); };
+
+        for (;;) {
+            auto request = peek(requests, requestBuffer, mappedRingSize);
+            if (!request) {
+                if (shared->stopping.load()) {
+                    break;
+                }
+                waitFor(requests.data, pending, 100);
+                continue;
+            }
+
+            Call call = {request->method, request + 1, request->size, nullptr, 0, 0};
+            if (!(request->flags & ReplyFlag)) {
+                if (handler) {
+                    handler(plugin, call);
+                }
+                release(requests, request->size);
+                continue;
+            }
+
+            // The caller reads each reply before sending the next call, so the ring is empty
+            Slot slot;
+            reserveSlot(replies, replyBuffer, mappedRingSize, maxSize, &slot);
+            call.reply = slot.message + 1;
+            call.capacity = maxSize;
+            const int32_t status = handler ? handler(plugin, call) : 0;
+
+            slot.message->size = uint32_t(std::min(call.replySize, maxSize));
+            slot.message->method = request->method;
+            slot.message->status = status;
+            slot.message->flags = 0;
+            release(requests, request->size);
+            commit(replies, slot);
+        }
+
+        // Skip the destructors inherited from the host
+        ::fflush(nullptr);
+#else
+        (void) zygotePid;
+#endif
+        std::_Exit(0);
+    }
+
+    PluginHost::PluginHost(const PathString &path, int hints) : _impl(new Impl()) {
+        _impl->path = path;
+        _impl->hints = hints;
+    }
+
+    PluginHost::~PluginHost() = default;
+
+    PluginHost::PluginHost(PluginHost &&other) noexcept {
+        std::swap(_impl, other._impl);
+    }
+
+    PluginHost &PluginHost::operator=(PluginHost &&other) noexcept {
+        if (this == &other)
+            return *this;
+        std::swap(_impl, other._impl);
+        return *this;
+    }
+
+    PathString PluginHost::path() const {
+        return _impl->path;
+    }
+
+    void PluginHost::setPath(const PathString &path) {
+        _impl->path = path;
+    }
+
+    int PluginHost::hints() const {
+        return _impl->hints;
+    }
+
+    void PluginHost::setHints(int hints) {
+        _impl->hints = hints;
+    }
+
+    void PluginHost::setHandler(const Handler &handler) {
+        _impl->handler = handler;
+    }
+
+    void PluginHost::setRingSize(size_t size) {
+        size_t res = MinRingSize;
+        while (res < size) {
+            res <<= 1;
+        }
+        _impl->ringSize = res;
+    }
+
+    size_t PluginHost::ringSize() const {
+        return _impl->ringSize;
+    }
+
+    size_t PluginHost::maxMessageSize() const {
+        return _impl->ringSize / 2 - sizeof(PluginHostPrivate::Message);
+    }
+
+    void PluginHost::setCallTimeout(std::chrono::milliseconds timeout) {
+        _impl->callTimeout = timeout;
+    }
+
+    void PluginHost::setMaxRestarts(int count) {
+        _impl->maxRestarts = count;
+    }
+
+    bool PluginHost::start() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        if (_impl->helperPid > 0) {
+            return true;
+        }
+        if (_impl->zygoteFd < 0 && !_impl->startZygote()) {
+            return false;
+        }
+        return _impl->launch();
+    }
+
+    void PluginHost::stop() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->shutdown();
+    }
+
+    bool PluginHost::isRunning() const {
+        return _impl->helperPid > 0;
+    }
+
+    int PluginHost::pid() const {
+        return _impl->helperPid;
+    }
+
+    int PluginHost::restarts() const {
+        return _impl->restarts;
+    }
+
+    bool PluginHost::call(uint32_t method, const void *data, size_t size, std::string *reply,
+                          int32_t *status) {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        const auto deadline = std::chrono::steady_clock::now() + _impl->callTimeout;
+        const void *replyData;
+        size_t replySize;
+        if (!_impl->send(method, data, size, ReplyFlag, deadline) ||
+            !_impl->receive(&replyData, &replySize, status, deadline)) {
+            return false;
+        }
+        if (reply) {
+            reply->assign(static_cast<const char *>(replyData), replySize);
+        }
+        _impl->dropReply();
+        return true;
+    }
+
+    void *PluginHost::reserve(size_t size) {
+        _impl->mutex.lock();
+        const auto deadline = std::chrono::steady_clock::now() + _impl->callTimeout;
+        if (!_impl->reserveRequest(size, &_impl->reserved, deadline)) {
+            _impl->mutex.unlock();
+            return nullptr;
+        }
+        _impl->reservedSize = size;
+        _impl->reservingThread = std::this_thread::get_id();
+        return _impl->reserved.message + 1;
+    }
+
+    bool PluginHost::callReserved(uint32_t method, size_t size, const void **reply,
+                                  size_t *replySize, int32_t *status) {
+        if (_impl->reservingThread.load() != std::this_thread::get_id()) {
+            _impl->error = "no request reserved";
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_impl->mutex, std::adopt_lock);
+        _impl->reservingThread = std::thread::id();
+        if (size > _impl->reservedSize) {
+            _impl->error = "message is larger than reserved";
+            return false;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + _impl->callTimeout;
+        _impl->commitRequest(_impl->reserved, method, size, ReplyFlag);
+
+        const void *replyData;
+        size_t replyDataSize;
+        if (!_impl->receive(&replyData, &replyDataSize, status, deadline)) {
+            return false;
+        }
+        if (reply) {
+            *reply = replyData;
+        }
+        if (replySize) {
+            *replySize = replyDataSize;
+        }
+        return true;
+    }
+
+    void PluginHost::cancelReserved() {
+        if (_impl->reservingThread.load() != std::this_thread::get_id()) {
+            return;
+        }
+        _impl->reservingThread = std::thread::id();
+        _impl->mutex.unlock();
+    }
+
+    bool PluginHost::post(uint32_t method, const void *data, size_t size) {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        const auto deadline = std::chrono::steady_clock::now() + _impl->callTimeout;
+        return _impl->send(method, data, size, 0, deadline);
+    }
+
+    std::string PluginHost::lastError() const {
+        return _impl->error;
+    }
+
+}
@@ -0,0 +1,149 @@
+#ifndef PLUGINHOST_P_H
+#define PLUGINHOST_P_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "pluginhost.h"
+
+#ifdef __linux__
+#  define LOADSO_PLUGIN_HOST
+#endif
+
+namespace LoadSO {
+
+    namespace PluginHostPrivate {
+
+        // Futex word a side sleeps on when it has nothing to do
+        struct Event {
+            std::atomic<uint32_t> seq;
+            std::atomic<uint32_t> waiters;
+        };
+
+        // Single producer, single consumer byte ring, positions only grow
+        struct alignas(64) Ring {
+            alignas(64) std::atomic<uint64_t> head; // Written by the producer
+            alignas(64) std::atomic<uint64_t> tail; // Written by the consumer
+            alignas(64) Event data;                 // Signalled when a message is published
+            Event space;                            // Signalled when a message is released
+        };
+
+        // Message header, the payload follows padded to the header alignment
+        struct Message {
+            uint32_t size;
+            uint32_t method;
+            int32_t status;
+            uint32_t flags;
+        };
+
+        // Room reserved in a ring by the producer, published by commit()
+        struct Slot {
+            Message *message;
+            uint64_t head; // Producer position of the padding or the message
+            size_t pad;    // Bytes skipped to wrap around
+        };
+
+        enum MessageFlag {
+            WrapFlag = 1,  // Padding up to the end of the ring
+            ReplyFlag = 2, // The caller waits for a reply
+        };
+
+        enum State {
+            Starting,
+            Ready,
+            Failed,
+        };
+
+        // Head of the shared mapping, followed by the request and reply ring buffers
+        struct Shared {
+            std::atomic<uint32_t> state;
+            Event stateChanged;
+            std::atomic<uint32_t> stopping;
+            char error[1024];
+            Ring requests;
+            Ring replies;
+        };
+
+    }
+
+    class PluginHost::Impl {
+    public:
+        PathString path;
+        int hints;
+        Handler handler;
+
+        size_t ringSize = 1 << 20;
+        std::chrono::milliseconds callTimeout{0};
+        int maxRestarts = 3;
+
+        PluginHostPrivate::Shared *shared = nullptr;
+        char *buffers = nullptr; // Request ring then reply ring, ringSize bytes each
+        size_t mappingSize = 0;
+        size_t mappedRingSize = 0;
+
+        int zygotePid = -1;
+        int zygoteFd = -1; // Socket to the zygote, or to the host inside the zygote
+        int helperPid = -1;
+        int restarts = 0;
+        bool started = false;
+        std::string error;
+
+        std::mutex mutex; // Serializes the producer side
+
+        // Request built in place between reserve() and callReserved(), which hold the mutex
+        std::atomic<std::thread::id> reservingThread{};
+        PluginHostPrivate::Slot reserved = {};
+        size_t reservedSize = 0;
+
+        // Reply left in the ring for the caller to read, released by the next request
+        bool replyHeld = false;
+        size_t heldReplySize = 0;
+
+        ~Impl();
+
+        // Maps the rings and forks the zygote that forks every helper
+        bool startZygote();
+        void stopZygote();
+
+        bool launch();
+        void shutdown();
+        void unmap();
+
+        // Has the zygote kill the helper and waits until it is reaped
+        void killHelper();
+
+        // Returns true and the wait status once the helper has exited, -1 if the zygote is gone
+        bool helperExited(int *status, int timeoutMs);
+
+        // Reaps a dead or hung helper and restarts it if allowed
+        void recover(const std::string &reason);
+
+        // Returns false if the helper is gone, after recovering
+        bool checkHelper();
+
+        // Waits until the predicate holds, watching the helper and the call deadline
+        bool wait(PluginHostPrivate::Event &event, const std::function<bool()> &pred,
+                  std::chrono::steady_clock::time_point deadline);
+
+        // Finds room for a request, waiting while the ring is full
+        bool reserveRequest(size_t size, PluginHostPrivate::Slot *slot,
+                            std::chrono::steady_clock::time_point deadline);
+        void commitRequest(const PluginHostPrivate::Slot &slot, uint32_t method, size_t size,
+                           uint32_t flags);
+
+        bool send(uint32_t method, const void *data, size_t size, uint32_t flags,
+                  std::chrono::steady_clock::time_point deadline);
+
+        // Waits for the reply and holds it in the ring
+        bool receive(const void **data, size_t *size, int32_t *status,
+                     std::chrono::steady_clock::time_point deadline);
+        void dropReply();
+
+        [[noreturn]] void zygoteMain(int hostPid);
+        [[noreturn]] void helperMain(int zygotePid);
+    };
+
+}
+
+#endif // PLUGINHOST_P_H
@@ -0,0 +1,213 @@
+#include "pluginindex.h"
+#include "pluginindex_p.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "metadatareader_p.h"
+
+// Layout, all integers little endian:
+//   magic[8] version:u32 count:u32
+//   count * { path:str format:u8 metadata:str nexports:u32 str... ndeps:u32 str... digest:str }
+// where str is len:u32 followed by len bytes. Version 1 has no digest.
+#define LOADSO_INDEX_MAGIC   "LSOINDEX"
+#define LOADSO_INDEX_VERSION 2
+
+namespace LoadSO {
+
+    using MetadataReaderPrivate::get32;
+
+    namespace {
+
+        class Writer {
+        public:
+            std::string data;
+
+            void u8(uint8_t val) {
+                data.push_back(static_cast<char>(val));
+            }
+
+            void u32(uint32_t val) {
+                for (int i = 0; i < 4; ++i) {
+                    data.push_back(static_cast<char>((val >> (i * 8)) & 0xFF));
+                }
+            }
+
+            void str(const std::string &s) {
+                u32(static_cast<uint32_t>(s.size()));
+                data.append(s);
+            }
+        };
+
+        class Reader {
+        public:
+            Reader(const void *data, size_t size)
+                : p(static_cast<const unsigned char *>(data)), end(p + size) {
+            }
+
+            bool u8(uint8_t *val) {
+                if (end - p < 1) {
+                    return false;
+                }
+                *val = *p++;
+                return true;
+            }
+
+            bool u32(uint32_t *val) {
+                if (end - p < 4) {
+                    return false;
+                }
+                *val = get32(p, false);
+                p += 4;
+                return true;
+            }
+
+            bool str(std::string *s) {
+                uint32_t len;
+                if (!u32(&len) || size_t(end - p) < len) {
+                    return false;
+                }
+                s->assign(reinterpret_cast<const char *>(p), len);
+                p += len;
+                return true;
+            }
+
+            bool strList(std::vector<std::string> *list) {
+                uint32_t count;
+                if (!u32(&count) || size_t(end - p) / 4 < count) {
+                    return false;
+                }
+                list->resize(count);
+                for (auto &s : *list) {
+                    if (!str(&s)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            const unsigned char *p;
+            const unsigned char *end;
+        };
+
+    }
+
+    void PluginIndex::Impl::add(Entry entry) {
+        auto it = pathIndexes.find(entry.path);
+        if (it != pathIndexes.end()) {
+            entries[it->second] = std::move(entry);
+            return;
+        }
+        pathIndexes.emplace(entry.path, entries.size());
+        entries.push_back(std::move(entry));
+    }
+
+    PluginIndex::PluginIndex() : _impl(new Impl()) {
+    }
+
+    PluginIndex::~PluginIndex() = default;
+
+    PluginIndex::PluginIndex(PluginIndex &&other) noexcept {
+        std::swap(_impl, other._impl);
+    }
+
+    PluginIndex &PluginIndex::operator=(PluginIndex &&other) noexcept {
+        if (this == &other)
+            return *this;
+        std::swap(_impl, other._impl);
+        return *this;
+    }
+
+    bool PluginIndex::load(const PathString &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return fromData(data.data(), data.size());
+    }
+
+    bool PluginIndex::save(const PathString &path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        auto data = toData();
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    bool PluginIndex::fromData(const void *data, size_t size) {
+        Reader reader(data, size);
+        uint32_t version, count;
+        if (size < 8 || memcmp(data, LOADSO_INDEX_MAGIC, 8) != 0) {
+            return false;
+        }
+        reader.p += 8;
+        if (!reader.u32(&version) || version < 1 || version > LOADSO_INDEX_VERSION ||
+            !reader.u32(&count)) {
+            return false;
+        }
+
+        Impl impl;
+        for (uint32_t i = 0; i < count; ++i) {
+            Entry entry;
+            uint8_t format;
+            if (!reader.str(&entry.path) || !reader.u8(&format) ||
+                !reader.str(&entry.info.metadata) || !reader.strList(&entry.info.exports) ||
+                !reader.strList(&entry.info.dependencies) ||
+                (version >= 2 && !reader.str(&entry.digest))) {
+                return false;
+            }
+            entry.info.format = static_cast<MetadataReader::Format>(format);
+            impl.add(std::move(entry));
+        }
+        std::swap(*_impl, impl);
+        return true;
+    }
+
+    std::string PluginIndex::toData() const {
+        Writer writer;
+        writer.data.append(LOADSO_INDEX_MAGIC, 8);
+        writer.u32(LOADSO_INDEX_VERSION);
+        writer.u32(static_cast<uint32_t>(_impl->entries.size()));
+        for (const auto &entry : _impl->entries) {
+            writer.str(entry.path);
+            writer.u8(static_cast<uint8_t>(entry.info.format));
+            writer.str(entry.info.metadata);
+            writer.u32(static_cast<uint32_t>(entry.info.exports.size()));
+            for (const auto &sym : entry.info.exports) {
+                writer.str(sym);
+            }
+            writer.u32(static_cast<uint32_t>(entry.info.dependencies.size()));
+            for (const auto &dep : entry.info.dependencies) {
+                writer.str(dep);
+            }
+            writer.str(entry.digest);
+        }
+        return std::move(writer.data);
+    }
+
+    const std::vector<PluginIndex::Entry> &PluginIndex::entries() const {
+        return _impl->entries;
+    }
+
+    void PluginIndex::addEntry(Entry entry) {
+        _impl->add(std::move(entry));
+    }
+
+    void PluginIndex::clear() {
+        _impl->entries.clear();
+        _impl->pathIndexes.clear();
+    }
+
+    const PluginIndex::Entry *PluginIndex::find(const std::string &path) const {
+        auto it = _impl->pathIndexes.find(path);
+        if (it == _impl->pathIndexes.end()) {
+            return nullptr;
+        }
+        return &_impl->entries[it->second];
+    }
+
+}
@@ -0,0 +1,20 @@
+#ifndef PLUGININDEX_P_H
+#define PLUGININDEX_P_H
+
+#include <unordered_map>
+
+#include "pluginindex.h"
+
+namespace LoadSO {
+
+    class PluginIndex::Impl {
+    public:
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, size_t> pathIndexes;
+
+        void add(Entry entry);
+    };
+
+}
+
+#endif // PLUGININDEX_P_H
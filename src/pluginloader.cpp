@@ -1,266 +1,336 @@
 #include "pluginloader_p.h"
 #include "pluginloader.h"
 
-#include <vector>
+#include <algorithm>
+#include <thread>
 #include <tuple>
 
+#include "loadprofile_p.h"
+#include "metadatareader.h"
+#include "metadatareader_p.h"
+#include "system.h"
+
 #ifdef _WIN32
-#  define UNICODE
 #  include <Windows.h>
-// 12345
-#  include <Shlwapi.h>
 #else
 #  include <dlfcn.h>
-#  include <limits.h>
-#  include <string.h>
-#  ifdef __APPLE__
-#    include <mach-o/loader.h>
-#    include <mach-o/fat.h>
-#  else
-#    include <elf.h>
-#  endif
-
-#  include <fstream>
 #endif
 
-#include "system.h"
-
-#define LOADSO_PLUGIN_IDENTIFIER "loadso_metadata"
+#define LOADSO_PLUGIN_IDENTIFIER       "loadso_metadata"
+#define LOADSO_PLUGIN_ABI_IDENTIFIER   "loadso_abi"
+#define LOADSO_PLUGIN_FLAGS_IDENTIFIER "loadso_flags"
 
 namespace LoadSO {
 
-#if defined(_WIN32)
-    static bool readMetadataResource(HMODULE hModule, std::string *out) {
-        HRSRC hResource = ::FindResourceW(hModule, LOADSO_STR(LOADSO_PLUGIN_IDENTIFIER), RT_RCDATA);
-        if (!hResource) {
-            ::FreeLibrary(hModule);
-            return false;
+    // String literals are embedded with their terminating 0
+    static void trimTerminators(std::string *s) {
+        while (!s->empty() && s->back() == '\0') {
+            s->pop_back();
         }
+    }
 
-        HGLOBAL hResourceLoad = ::LoadResource(hModule, hResource);
-        if (!hResourceLoad) {
-            ::FreeLibrary(hModule);
-            return false;
-        }
+    PluginLoader::Impl::~Impl() {
+        // The warm-up runs code of the library, whether it is unloaded below or not
+        stopWarmUp();
 
-        LPVOID pData = ::LockResource(hResourceLoad);
-        if (!pData) {
-            ::FreeResource(hResourceLoad);
-            return false;
-        }
+        // Taken from the image when loading, the file is not read at exit
+        cleanupRequired = cleanupRequired || cleanupFlag;
+    }
 
-        if (IS_INTRESOURCE(pData)) {
-            ::FreeResource(hResourceLoad);
-            return false;
+    void PluginLoader::Impl::getMetaData() const {
+        // A loaded plugin carries its metadata in the mapped image
+        const char *data;
+        size_t size;
+        if (imageMetaData(&data, &size)) {
+            metaData.assign(data, size);
+            return;
         }
 
-        *out = std::string(static_cast<char *>(pData), ::SizeofResource(hModule, hResource));
-        ::FreeResource(hResourceLoad);
-        return true;
+        if (path.empty())
+            return;
+
+        // Parse ELF section, Mach-O section or PE resource
+        std::ignore =
+            MetadataReader::ReadFile(absolutePath(path), &metaData, LOADSO_PLUGIN_IDENTIFIER);
     }
-#elif defined(__APPLE__)
-    static bool readSectionData(std::ifstream &file, uint32_t offset, uint32_t size,
-                                std::string *out) {
-        std::string buffer;
-        buffer.resize(size);
-        file.seekg(offset, std::ios::beg);
-        file.read(&buffer[0], size);
-        if (!file.good()) {
+
+#ifdef _WIN32
+    static bool rcData(void *hDll, const char *name, const char **data, size_t *size) {
+        auto hModule = reinterpret_cast<HMODULE>(hDll);
+        auto hResource = ::FindResourceA(hModule, name, MAKEINTRESOURCEA(10));
+        if (!hResource) {
             return false;
         }
-        std::swap(*out, buffer);
+        auto hData = ::LoadResource(hModule, hResource);
+        auto ptr = hData ? ::LockResource(hData) : nullptr;
+        if (!ptr) {
+            return false;
+        }
+        *data = static_cast<const char *>(ptr);
+        *size = ::SizeofResource(hModule, hResource);
         return true;
     }
+#endif
 
-    static bool readMetadataFromMachO(std::ifstream &file, std::string *out) {
-        // Read head
-        mach_header header;
-        file.read(reinterpret_cast<char *>(&header), sizeof(header));
-
-        // Check bits
-        uint32_t ncmds;
-        bool is64bit = false;
-        if (header.magic == MH_MAGIC) {
-#  if __WORDSIZE == 32
-            ncmds = header.ncmds;
-#  else
-            return false;
-#  endif
-        } else if (header.magic == MH_MAGIC_64) {
-#  if __WORDSIZE == 64
-            mach_header_64 header64;
-            file.seekg(0, std::ios::beg);
-            file.read(reinterpret_cast<char *>(&header64), sizeof(header64));
-            ncmds = header64.ncmds;
-            is64bit = true;
-#  else
+    bool PluginLoader::Impl::imageMetaData(const char **data, size_t *size) const {
+        if (!hDll) {
             return false;
-#  endif
-        } else {
+        }
+#ifdef _WIN32
+        return rcData(hDll, LOADSO_PLUGIN_IDENTIFIER, data, size);
+#else
+        // Emitted by loadso_export_plugin(), plugins built before it have none
+        using MetaDataEntry = const unsigned char *(*) (size_t *);
+        auto entry = reinterpret_cast<MetaDataEntry>(dlsym(hDll, "loadso_plugin_metadata"));
+        if (!entry) {
+            std::ignore = dlerror();
             return false;
         }
+        *data = reinterpret_cast<const char *>(entry(size));
+        return true;
+#endif
+    }
 
-        // Traverse load commands
-        for (uint32_t i = 0; i < ncmds; ++i) {
-            load_command lc;
-            file.read(reinterpret_cast<char *>(&lc), sizeof(lc));
-
-            if (lc.cmd == LC_SEGMENT) {
-                segment_command seg;
-                file.seekg(-static_cast<int>(sizeof(load_command)), std::ios::cur);
-                file.read(reinterpret_cast<char *>(&seg), sizeof(seg));
-
-                if (std::strcmp(seg.segname, "__TEXT") == 0) {
-                    for (uint32_t j = 0; j < seg.nsects; ++j) {
-                        section sec;
-                        file.read(reinterpret_cast<char *>(&sec), sizeof(sec));
-                        if (std::strcmp(sec.sectname, LOADSO_PLUGIN_IDENTIFIER) == 0) {
-                            return readSectionData(file, sec.offset, sec.size, out);
-                        }
-                    }
-                } else {
-                    file.seekg(seg.cmdsize - sizeof(segment_command), std::ios::cur);
-                }
-            } else if (lc.cmd == LC_SEGMENT_64) {
-                // 64 bit segment
-                segment_command_64 seg64;
-                file.seekg(-static_cast<int>(sizeof(load_command)), std::ios::cur);
-                file.read(reinterpret_cast<char *>(&seg64), sizeof(seg64));
-                if (std::strcmp(seg64.segname, "__TEXT") == 0) {
-                    for (uint32_t j = 0; j < seg64.nsects; ++j) {
-                        section_64 sec64;
-                        file.read(reinterpret_cast<char *>(&sec64), sizeof(sec64));
-                        if (std::strcmp(sec64.sectname, LOADSO_PLUGIN_IDENTIFIER) == 0) {
-                            return readSectionData(file, sec64.offset, sec64.size, out);
-                        }
-                    }
-                } else {
-                    file.seekg(seg64.cmdsize - sizeof(segment_command_64), std::ios::cur);
-                }
-            } else {
-                file.seekg(lc.cmdsize - sizeof(load_command), std::ios::cur);
-            }
+    bool PluginLoader::Impl::loadImageFlags() {
+        const char *data;
+        size_t size;
+#ifdef _WIN32
+        // Plugins without flags have no such resource
+        if (!rcData(hDll, LOADSO_PLUGIN_FLAGS_IDENTIFIER, &data, &size)) {
+            size = 0;
         }
-        return false;
-    }
 #else
-    template <class ElfHeaderType, class ProgramHeaderType, class SectionHeaderType>
-    static bool readMetadataSection(std::ifstream &file, std::string *out) {
-        ElfHeaderType ehdr;
-        file.read(reinterpret_cast<char *>(&ehdr), sizeof(ehdr));
-        if (!file.good()) {
+        // Emitted by loadso_export_plugin(), flags of other plugins are read from the file
+        using FlagsEntry = const char *(*) (size_t *);
+        auto entry = reinterpret_cast<FlagsEntry>(dlsym(hDll, "loadso_plugin_flags"));
+        if (!entry) {
+            std::ignore = dlerror();
             return false;
         }
+        data = entry(&size);
+#endif
+        flags.assign(data, size);
+        flagsLoaded = true;
+        return true;
+    }
 
-        // Check header sizes
-        if (ehdr.e_ehsize != sizeof(ElfHeaderType)) {
+    bool PluginLoader::Impl::imageResource(const char *name, const char **data, size_t *size,
+                                           std::vector<std::string> *names) const {
+        if (!hDll) {
             return false;
         }
-        if (ehdr.e_phentsize != sizeof(ProgramHeaderType)) {
+#ifdef _WIN32
+        const char *index;
+        size_t indexSize;
+        if (!rcData(hDll, MetadataReader::ResourcesName, &index, &indexSize)) {
             return false;
         }
-        if (ehdr.e_shentsize != sizeof(SectionHeaderType) && ehdr.e_shentsize != 0) {
-            return false;
+        std::vector<std::string> list;
+        MetadataReaderPrivate::splitResourceNames(index, indexSize, &list);
+        if (names) {
+            *names = list;
+            return true;
         }
-
-        // Read section headers
-        file.seekg(ehdr.e_shoff, std::ios::beg);
-        std::vector<SectionHeaderType> shdrs(ehdr.e_shnum);
-        file.read(reinterpret_cast<char *>(shdrs.data()), ehdr.e_shnum * ehdr.e_shentsize);
-        if (!file.good()) {
+        auto it = std::find(list.begin(), list.end(), name);
+        if (it == list.end()) {
             return false;
         }
-
-        // Read section header string table
-        if (ehdr.e_shstrndx >= ehdr.e_shnum) {
+        const std::string rcName = "loadso_resource_" + std::to_string(it - list.begin());
+        return rcData(hDll, rcName.data(), data, size);
+#else
+        // Emitted by loadso_export_plugin() when resources are given
+        using ResourcesEntry = const unsigned char *(*) (size_t *);
+        auto entry = reinterpret_cast<ResourcesEntry>(dlsym(hDll, "loadso_plugin_resources"));
+        if (!entry) {
+            std::ignore = dlerror();
             return false;
         }
-        auto &shstrtab_hdr = shdrs[ehdr.e_shstrndx];
-        std::vector<char> shstrtab(shstrtab_hdr.sh_size);
-        file.seekg(shstrtab_hdr.sh_offset, std::ios::beg);
-        file.read(shstrtab.data(), shstrtab.size());
-        if (!file.good()) {
+        size_t tableSize;
+        auto table = entry(&tableSize);
+        BufferSource src(table, tableSize);
+        uint64_t offset, length;
+        if (names) {
+            names->clear();
+            return MetadataReaderPrivate::findResource(src, 0, tableSize, nullptr, names, nullptr,
+                                                       nullptr);
+        }
+        if (!MetadataReaderPrivate::findResource(src, 0, tableSize, name, nullptr, &offset,
+                                                 &length)) {
             return false;
         }
+        *data = reinterpret_cast<const char *>(table + offset);
+        *size = size_t(length);
+        return true;
+#endif
+    }
 
-        // Find metadata section
-        for (const auto &shdr : shdrs) {
-            if (strcmp(&shstrtab[shdr.sh_name], "." LOADSO_PLUGIN_IDENTIFIER) == 0) {
-                std::string section_data;
-                section_data.resize(shdr.sh_size);
-                file.seekg(shdr.sh_offset, std::ios::beg);
-                file.read(&section_data[0], section_data.size());
-                if (!file.good()) {
-                    return false;
-                }
-                std::swap(*out, section_data);
+    const std::string &PluginLoader::Impl::getInterfaceId() const {
+        if (!interfaceIdLoaded) {
+            interfaceIdLoaded = true;
+            if (!path.empty() && MetadataReader::ReadFile(absolutePath(path), &interfaceId,
+                                                          LOADSO_PLUGIN_ABI_IDENTIFIER)) {
+                trimTerminators(&interfaceId);
+            }
+        }
+        return interfaceId;
+    }
+
+    bool PluginLoader::Impl::hasFlag(const char *flag) const {
+        if (!flagsLoaded) {
+            flagsLoaded = true;
+            if (path.empty() || !MetadataReader::ReadFile(absolutePath(path), &flags,
+                                                          LOADSO_PLUGIN_FLAGS_IDENTIFIER)) {
+                flags.clear();
+            }
+        }
+
+        // Space separated words, as a string literal with its terminating 0
+        const std::string word = flag;
+        size_t pos = 0;
+        while (pos < flags.size()) {
+            size_t end = flags.find_first_of(" \0", pos, 2);
+            if (end == std::string::npos) {
+                end = flags.size();
+            }
+            if (flags.compare(pos, end - pos, word) == 0) {
                 return true;
             }
+            pos = end + 1;
         }
         return false;
     }
 
-    static bool readMetadataFromELF(std::ifstream &file, std::string *out) {
-        unsigned char e_ident[EI_NIDENT];
-        file.read(reinterpret_cast<char *>(e_ident), sizeof(e_ident));
-        if (!file.good()) {
-            return false;
+    bool PluginLoader::Impl::checkInterface() const {
+        if (requiredInterface.empty() || getInterfaceId() == requiredInterface) {
+            return true;
         }
+        const auto &found = getInterfaceId();
+        setError(Library::IncompatibleError,
+                 ("plugin interface mismatch: required " + requiredInterface + ", found " +
+                  (found.empty() ? "none" : found))
+                     .data());
+        return false;
+    }
 
-        // Check header: ELF
-        if (memcmp(e_ident, ELFMAG, SELFMAG) != 0) {
+    bool PluginLoader::Impl::initInstance(int hints) {
+        auto entry = reinterpret_cast<InstanceEntry>(resolve("loadso_plugin_instance"));
+        if (!entry) {
+            // Keep the resolve error, close() only overwrites it when it fails itself
+            std::ignore = close();
             return false;
         }
+        instanceEntry = entry;
+        warmUpOnConstruct = (hints & WarmUpHint) != 0;
+        cleanupFlag = loadImageFlags() && hasFlag("cleanup");
 
-        // Check bits
-        if (e_ident[EI_CLASS] == ELFCLASS64) {
-#  if __WORDSIZE == 32
-            return false;
-#  else
-            file.seekg(0, std::ios::beg);
-            return readMetadataSection<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr>(file, out);
-#  endif
-        } else if (e_ident[EI_CLASS] == ELFCLASS32) {
-#  if __WORDSIZE != 32
-            file.seekg(0, std::ios::beg);
-            return readMetadataSection<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr>(file, out);
-#  else
+        if (!(hints & DeferConstructionHint)) {
+            std::ignore = construct();
+        }
+        return true;
+    }
+
+    bool PluginLoader::Impl::construct() {
+        std::lock_guard<std::mutex> lock(constructMutex);
+        if (pluginInstance) {
+            return true;
+        }
+        if (!instanceEntry) {
+            setError(Library::NotOpenError);
             return false;
-#  endif
         }
 
-        // Unknown type
-        return false;
+        auto start = std::chrono::steady_clock::now();
+        auto instance = instanceEntry();
+        constructionTime = std::chrono::steady_clock::now() - start;
+        pluginInstance = instance;
+        if (instance && warmUpOnConstruct) {
+            std::ignore = startWarmUp(false);
+        }
+        return instance != nullptr;
     }
-#endif
 
-    void PluginLoader::Impl::getMetaData() const {
-        if (path.empty())
-            return;
+    void PluginLoader::Impl::clearEmbedded() {
+        metaData.clear();
+        metaDataLoaded = false;
+        interfaceId.clear();
+        interfaceIdLoaded = false;
+        flags.clear();
+        flagsLoaded = false;
+    }
+
+    void PluginLoader::Impl::resetInstance() {
+        std::lock_guard<std::mutex> lock(constructMutex);
+        instanceEntry = nullptr;
+        pluginInstance = nullptr;
+        constructionTime = std::chrono::nanoseconds(0);
+        warmUpOnConstruct = false;
+        cleanupFlag = false;
+
+        std::lock_guard<std::mutex> warmUpLock(warmUpMutex);
+        warmUpState = NoWarmUp;
+        warmUpTime = std::chrono::nanoseconds(0);
+    }
+
+    bool PluginLoader::Impl::startWarmUp(bool required) {
+        void *instance = pluginInstance;
+        if (!instance) {
+            if (required) {
+                setError(Library::NotOpenError);
+            }
+            return false;
+        }
 
+        // Emitted by loadso_export_plugin(WARMUP), looked up quietly as most plugins have none
+        auto entry = reinterpret_cast<WarmUpEntry>(
 #ifdef _WIN32
-        // Windows: Parse PE Resource
-        HMODULE hModule = ::LoadLibraryExW(path.data(), nullptr, LOAD_LIBRARY_AS_DATAFILE);
-        if (!hModule) {
-            return;
+            ::GetProcAddress(reinterpret_cast<HMODULE>(hDll), "loadso_plugin_warmup")
+#else
+            dlsym(hDll, "loadso_plugin_warmup")
+#endif
+        );
+        if (!entry) {
+#ifndef _WIN32
+            std::ignore = dlerror();
+#endif
+            if (required) {
+                setError(Library::SymbolNotFoundError, "loadso_plugin_warmup");
+            }
+            return false;
         }
-        std::ignore = readMetadataResource(hModule, &metaData);
-        ::FreeLibrary(hModule);
-#elif defined(__APPLE__)
-        // Mac: Parse Mach-O Section
-        std::ifstream file(path, std::ios::binary);
-        if (!file) {
-            return;
+
+        std::lock_guard<std::mutex> lock(warmUpMutex);
+        if (warmUpState == WarmingUp) {
+            return true;
         }
-        std::ignore = readMetadataFromMachO(file, &metaData);
-#else
-        // Linux: Parse ELF Section
-        std::ifstream file(path, std::ios::binary);
-        if (!file) {
-            return;
+        if (warmUpThread.joinable()) {
+            warmUpThread.join();
+        }
+        warmUpCancelled = false;
+        warmUpState = WarmingUp;
+        warmUpThread = std::thread([this, entry, instance]() {
+            auto start = std::chrono::steady_clock::now();
+            bool ok = entry(instance, &warmUpCancelled);
+            auto time = std::chrono::steady_clock::now() - start;
+            {
+                std::lock_guard<std::mutex> lock(warmUpMutex);
+                warmUpTime = time;
+                warmUpState = warmUpCancelled ? WarmUpCancelled : (ok ? WarmedUp : WarmUpFailed);
+            }
+            warmUpCond.notify_all();
+        });
+        return true;
+    }
+
+    void PluginLoader::Impl::stopWarmUp() {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(warmUpMutex);
+            warmUpCancelled = true;
+            thread = std::move(warmUpThread);
+        }
+        if (thread.joinable()) {
+            thread.join();
         }
-        std::ignore = readMetadataFromELF(file, &metaData);
-#endif
     }
 
     PluginLoader::PluginLoader(const PathString &path) : _impl(new Impl()) {
@@ -281,6 +351,9 @@ namespace LoadSO {
     }
 
     void *PluginLoader::instance() const {
+        if (LoadProfilePrivate::isRecording()) {
+            LoadProfilePrivate::recordUse(_impl->path, nullptr, 0);
+        }
         return _impl->pluginInstance;
     }
 
@@ -292,25 +365,217 @@ namespace LoadSO {
         return _impl->metaData;
     }
 
+    bool PluginLoader::metaDataView(const char **data, size_t *size) const {
+        return _impl->imageMetaData(data, size);
+    }
+
+    bool PluginLoader::resource(const char *name, std::string *out) const {
+        const char *data;
+        size_t size;
+        if (_impl->imageResource(name, &data, &size, nullptr)) {
+            out->assign(data, size);
+            return true;
+        }
+        return !_impl->path.empty() &&
+               MetadataReader::ReadFileResource(Impl::absolutePath(_impl->path), name, out);
+    }
+
+    bool PluginLoader::resourceView(const char *name, const char **data, size_t *size) const {
+        return _impl->imageResource(name, data, size, nullptr);
+    }
+
+    std::vector<std::string> PluginLoader::resourceNames() const {
+        std::vector<std::string> names;
+        if (!_impl->imageResource(nullptr, nullptr, nullptr, &names) && !_impl->path.empty()) {
+            std::ignore = MetadataReader::ReadFileResourceNames(Impl::absolutePath(_impl->path),
+                                                                &names);
+        }
+        return names;
+    }
+
+    bool PluginLoader::construct() {
+        return _impl->construct();
+    }
+
+    bool PluginLoader::isConstructed() const {
+        return _impl->pluginInstance != nullptr;
+    }
+
+    std::chrono::nanoseconds PluginLoader::constructionTime() const {
+        std::lock_guard<std::mutex> lock(_impl->constructMutex);
+        return _impl->constructionTime;
+    }
+
+    size_t PluginLoader::ConstructAll(const std::vector<PluginLoader *> &plugins, int threads) {
+        if (threads <= 0) {
+            threads = std::max(1, int(std::thread::hardware_concurrency()));
+        }
+        threads = std::min<int>(threads, int(plugins.size()));
+
+        std::atomic<size_t> next(0);
+        std::atomic<size_t> succeeded(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < plugins.size(); i = next++) {
+                if (plugins[i] && plugins[i]->construct()) {
+                    succeeded++;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : workers) {
+            thread.join();
+        }
+        return succeeded;
+    }
+
+    bool PluginLoader::warmUp() {
+        return _impl->startWarmUp(true);
+    }
+
+    void PluginLoader::cancelWarmUp() {
+        _impl->stopWarmUp();
+    }
+
+    bool PluginLoader::waitForWarmUp() {
+        std::unique_lock<std::mutex> lock(_impl->warmUpMutex);
+        _impl->warmUpCond.wait(lock, [this]() { return _impl->warmUpState != WarmingUp; });
+        // Join the finished thread, a process forking next must not inherit it
+        auto thread = std::move(_impl->warmUpThread);
+        lock.unlock();
+        if (thread.joinable()) {
+            thread.join();
+        }
+        return _impl->warmUpState == WarmedUp;
+    }
+
+    bool PluginLoader::waitForWarmUp(std::chrono::milliseconds timeout) {
+        {
+            std::unique_lock<std::mutex> lock(_impl->warmUpMutex);
+            if (!_impl->warmUpCond.wait_for(
+                    lock, timeout, [this]() { return _impl->warmUpState != WarmingUp; })) {
+                return false;
+            }
+        }
+        return waitForWarmUp();
+    }
+
+    PluginLoader::WarmUpState PluginLoader::warmUpState() const {
+        return static_cast<WarmUpState>(_impl->warmUpState.load());
+    }
+
+    std::chrono::nanoseconds PluginLoader::warmUpTime() const {
+        std::lock_guard<std::mutex> lock(_impl->warmUpMutex);
+        return _impl->warmUpTime;
+    }
+
+    void PluginLoader::setRequiredInterface(const std::string &interfaceId) {
+        _impl->requiredInterface = interfaceId;
+    }
+
+    const std::string &PluginLoader::requiredInterface() const {
+        return _impl->requiredInterface;
+    }
+
+    const std::string &PluginLoader::interfaceId() const {
+        return _impl->getInterfaceId();
+    }
+
+    bool PluginLoader::isCompatible() const {
+        return _impl->requiredInterface.empty() ||
+               _impl->getInterfaceId() == _impl->requiredInterface;
+    }
+
+    void PluginLoader::setAllowedDigests(const std::vector<std::string> &digests) {
+        _impl->allowedDigests = digests;
+    }
+
+    const std::vector<std::string> &PluginLoader::allowedDigests() const {
+        return _impl->allowedDigests;
+    }
+
+    void PluginLoader::setCleanupRequired(bool required) {
+        _impl->cleanupRequired = required;
+    }
+
+    bool PluginLoader::isCleanupRequired() const {
+        return _impl->cleanupRequired || _impl->hasFlag("cleanup");
+    }
+
+    PluginLoader::Priority PluginLoader::priority() const {
+        if (_impl->priority >= 0) {
+            return static_cast<Priority>(_impl->priority);
+        }
+        if (_impl->hasFlag("priority=critical")) {
+            return CriticalPriority;
+        }
+        if (_impl->hasFlag("priority=background")) {
+            return BackgroundPriority;
+        }
+        return NormalPriority;
+    }
+
+    void PluginLoader::setPriority(Priority priority) {
+        _impl->priority = priority;
+    }
+
     bool PluginLoader::load(int hints) {
-        if (!_impl->open(hints)) {
+        _impl->stopWarmUp();
+
+        // Reject incompatible plugins before paying the load cost
+        if (!_impl->checkInterface() || !_impl->open(hints)) {
             return false;
         }
+        return _impl->initInstance(hints);
+    }
 
-        using InstanceEntry = void *(*) ();
+    bool PluginLoader::loadFromMemory(const void *data, size_t size, int hints,
+                                      const char *name) {
+        _impl->stopWarmUp();
+        if (_impl->hDll) {
+            _impl->close();
+        }
+        _impl->resetInstance();
+
+        // Take the embedded resources from the image, the memfd path is not read again
+        auto &impl = *_impl;
+        impl.path.clear();
+        impl.metaData.clear();
+        std::ignore = MetadataReader::Read(data, size, &impl.metaData, LOADSO_PLUGIN_IDENTIFIER);
+        impl.metaDataLoaded = true;
+        impl.interfaceId.clear();
+        if (MetadataReader::Read(data, size, &impl.interfaceId, LOADSO_PLUGIN_ABI_IDENTIFIER)) {
+            trimTerminators(&impl.interfaceId);
+        }
+        impl.interfaceIdLoaded = true;
+        impl.flags.clear();
+        std::ignore = MetadataReader::Read(data, size, &impl.flags, LOADSO_PLUGIN_FLAGS_IDENTIFIER);
+        impl.flagsLoaded = true;
 
-        auto instance_entry =
-            reinterpret_cast<InstanceEntry>(_impl->resolve("loadso_plugin_instance"));
-        if (!instance_entry) {
-            std::ignore = _impl->close();
+        if (!impl.checkInterface() || !impl.openMemory(data, size, name, hints)) {
             return false;
         }
-        _impl->pluginInstance = instance_entry();
-        return true;
+        return _impl->initInstance(hints);
     }
 
     bool PluginLoader::unload() {
-        return _impl->close();
+        _impl->stopWarmUp();
+        const bool fromMemory = _impl->memoryFd >= 0;
+        if (!_impl->close()) {
+            return false;
+        }
+        _impl->resetInstance();
+
+        // The /proc/self/fd path died with the descriptor, and so did what was read from it
+        if (fromMemory) {
+            _impl->path.clear();
+            _impl->clearEmbedded();
+        }
+        return true;
     }
 
     bool PluginLoader::isLoaded() const {
@@ -325,17 +590,21 @@ namespace LoadSO {
         if (_impl->path == path)
             return;
 
+        _impl->stopWarmUp();
         if (_impl->hDll) {
             _impl->close();
         }
-        _impl->metaData.clear();
-        _impl->metaDataLoaded = false;
-        _impl->pluginInstance = nullptr;
+        _impl->clearEmbedded();
+        _impl->resetInstance();
         _impl->path = path;
     }
 
+    Library::ErrorCode PluginLoader::errorCode() const {
+        return static_cast<Library::ErrorCode>(_impl->errorCode.load());
+    }
+
     std::string PluginLoader::lastError(bool nativeLanguage) const {
-        return System::MultiFromPathString(_impl->sysErrorMessage(nativeLanguage));
+        return System::MultiFromPathString(_impl->errorMessage(nativeLanguage));
     }
 
 }
\ No newline at end of file
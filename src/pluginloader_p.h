@@ -1,6 +1,10 @@
 #ifndef PLUGINLOADER_P_H
 #define PLUGINLOADER_P_H
 
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
 #include "pluginloader.h"
 #include "library_p.h"
 
@@ -8,12 +12,60 @@ namespace LoadSO {
 
     class PluginLoader::Impl : public Library::Impl {
     public:
-        void *pluginInstance = nullptr;
+        using InstanceEntry = void *(*) ();
+        using WarmUpEntry = bool (*)(void *, const std::atomic<bool> *);
+
+        ~Impl() override;
+
+        InstanceEntry instanceEntry = nullptr;
+        std::atomic<void *> pluginInstance{nullptr};
+        std::chrono::nanoseconds constructionTime{0};
+        std::mutex constructMutex;
+
+        bool warmUpOnConstruct = false;
+        std::thread warmUpThread;
+        std::atomic<bool> warmUpCancelled{false};
+        std::atomic<int> warmUpState{NoWarmUp};
+        std::chrono::nanoseconds warmUpTime{0};
+        mutable std::mutex warmUpMutex;
+        std::condition_variable warmUpCond;
 
         mutable std::string metaData;
         mutable bool metaDataLoaded = false;
 
+        std::string requiredInterface;
+        mutable std::string interfaceId;
+        mutable bool interfaceIdLoaded = false;
+
+        mutable std::string flags;
+        mutable bool flagsLoaded = false;
+        bool cleanupFlag = false; // Embedded cleanup flag of the loaded image
+
+        int priority = -1; // Unset, read from the flags
+
         void getMetaData() const;
+        bool imageMetaData(const char **data, size_t *size) const;
+        // Takes the flags from the loaded image, returns false if it has no accessor
+        bool loadImageFlags();
+
+        // Finds a resource in the loaded image, or lists the names if \c names is given
+        bool imageResource(const char *name, const char **data, size_t *size,
+                           std::vector<std::string> *names) const;
+        const std::string &getInterfaceId() const;
+        bool hasFlag(const char *flag) const;
+
+        bool checkInterface() const;
+        bool initInstance(int hints);
+        bool construct();
+        void resetInstance();
+        // Drops what was read from the file or image, to be read again from the next one
+        void clearEmbedded();
+
+        // Starts the warm-up entry on a background thread, a missing entry is only an error
+        // when \c required
+        bool startWarmUp(bool required);
+        // Cancels the warm-up and joins its thread, must precede closing the library
+        void stopWarmUp();
     };
 
 }
@@ -0,0 +1,177 @@
+#include "pluginpool.h"
+#include "pluginpool_p.h"
+
+namespace LoadSO {
+
+    void PluginPool::Impl::release(int index) {
+        // Notify under the lock, a closing pool may be destroyed as soon as it is released
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(index);
+        releasedCond.notify_one();
+        if (closing) {
+            idleCond.notify_one();
+        }
+    }
+
+    PluginPool::Lease::Lease(PluginPool *pool, int index)
+        : _pool(pool), _plugin(&pool->_impl->copies[index]), _index(index) {
+    }
+
+    PluginPool::Lease::~Lease() {
+        release();
+    }
+
+    PluginPool::Lease::Lease(Lease &&other) noexcept {
+        std::swap(_pool, other._pool);
+        std::swap(_plugin, other._plugin);
+        std::swap(_index, other._index);
+    }
+
+    PluginPool::Lease &PluginPool::Lease::operator=(Lease &&other) noexcept {
+        if (this == &other)
+            return *this;
+        release();
+        std::swap(_pool, other._pool);
+        std::swap(_plugin, other._plugin);
+        std::swap(_index, other._index);
+        return *this;
+    }
+
+    void PluginPool::Lease::release() {
+        if (!_pool) {
+            return;
+        }
+        _pool->_impl->release(_index);
+        _pool = nullptr;
+        _plugin = nullptr;
+        _index = -1;
+    }
+
+    PluginPool::PluginPool(const PathString &path) : _impl(new Impl()) {
+        _impl->path = path;
+    }
+
+    PluginPool::~PluginPool() {
+        {
+            // Leases point into the copies and waiters into the Impl, let them all go first
+            std::unique_lock<std::mutex> lock(_impl->mutex);
+            _impl->closing = true;
+            _impl->releasedCond.notify_all();
+            _impl->idleCond.wait(lock, [this]() {
+                return _impl->freeList.size() == _impl->copies.size() && _impl->waiters == 0;
+            });
+        }
+        unload();
+    }
+
+    PathString PluginPool::path() const {
+        return _impl->path;
+    }
+
+    void PluginPool::setPath(const PathString &path) {
+        _impl->path = path;
+    }
+
+    void PluginPool::setRequiredInterface(const std::string &interfaceId) {
+        _impl->interfaceId = interfaceId;
+    }
+
+    bool PluginPool::load(size_t count, int hints) {
+        if (!unload()) {
+            return false;
+        }
+        if (count == 0) {
+            _impl->error = "no copies requested";
+            return false;
+        }
+
+        std::vector<PluginLoader> copies;
+        copies.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            PluginLoader loader(_impl->path);
+            loader.setRequiredInterface(_impl->interfaceId);
+            if (!loader.load(hints | Library::IsolatedNamespaceHint)) {
+                _impl->error = "copy " + std::to_string(i) + ": " + loader.lastError();
+                return false;
+            }
+            copies.push_back(std::move(loader));
+        }
+
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->copies = std::move(copies);
+        for (size_t i = count; i > 0; --i) {
+            _impl->freeList.push_back(int(i - 1));
+        }
+        return true;
+    }
+
+    bool PluginPool::unload() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        if (_impl->freeList.size() != _impl->copies.size()) {
+            _impl->error = "copies are still leased";
+            return false;
+        }
+        bool res = true;
+        for (auto &copy : _impl->copies) {
+            if (!copy.unload()) {
+                _impl->error = copy.lastError();
+                res = false;
+            }
+        }
+        _impl->copies.clear();
+        _impl->freeList.clear();
+        return res;
+    }
+
+    bool PluginPool::isLoaded() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return !_impl->copies.empty();
+    }
+
+    size_t PluginPool::size() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return _impl->copies.size();
+    }
+
+    PluginLoader &PluginPool::at(size_t index) {
+        return _impl->copies.at(index);
+    }
+
+    PluginPool::Lease PluginPool::acquire() {
+        std::unique_lock<std::mutex> lock(_impl->mutex);
+        if (_impl->copies.empty() || _impl->closing) {
+            return {};
+        }
+        _impl->waiters++;
+        _impl->releasedCond.wait(
+            lock, [this]() { return !_impl->freeList.empty() || _impl->closing; });
+        _impl->waiters--;
+        if (_impl->closing) {
+            _impl->idleCond.notify_one();
+            return {};
+        }
+        const int index = _impl->freeList.back();
+        _impl->freeList.pop_back();
+        return Lease(this, index);
+    }
+
+    PluginPool::Lease PluginPool::tryAcquire() {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        if (_impl->freeList.empty() || _impl->closing) {
+            return {};
+        }
+        const int index = _impl->freeList.back();
+        _impl->freeList.pop_back();
+        return Lease(this, index);
+    }
+
+    size_t PluginPool::available() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return _impl->freeList.size();
+    }
+
+    std::string PluginPool::lastError() const {
+        return _impl->error;
+    }
+
+}
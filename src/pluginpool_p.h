@@ -0,0 +1,32 @@
+#ifndef PLUGINPOOL_P_H
+#define PLUGINPOOL_P_H
+
+#include <condition_variable>
+#include <mutex>
+
+#include "pluginpool.h"
+
+namespace LoadSO {
+
+    class PluginPool::Impl {
+    public:
+        PathString path;
+        std::string interfaceId;
+        std::vector<PluginLoader> copies;
+        std::string error;
+
+        mutable std::mutex mutex;
+        std::condition_variable releasedCond;
+        std::vector<int> freeList; // Indexes of free copies, the last released at the back
+
+        // Set by the destructor, which waits on idleCond for the leases and the waiters
+        bool closing = false;
+        int waiters = 0;
+        std::condition_variable idleCond;
+
+        void release(int index);
+    };
+
+}
+
+#endif // PLUGINPOOL_P_H
@@ -0,0 +1,160 @@
+#include "pluginregistry.h"
+#include "pluginregistry_p.h"
+
+#include <cstring>
+#include <thread>
+
+namespace LoadSO {
+
+    PluginRegistry::Impl::Table::Table(std::vector<Entry> entries) : entries(std::move(entries)) {
+        size_t capacity = 8;
+        while (capacity < this->entries.size() * 2) {
+            capacity <<= 1;
+        }
+        buckets.resize(capacity);
+        mask = capacity - 1;
+
+        for (size_t i = 0; i < this->entries.size(); ++i) {
+            size_t pos = this->entries[i].hash & mask;
+            while (buckets[pos]) {
+                pos = (pos + 1) & mask;
+            }
+            buckets[pos] = uint32_t(i + 1);
+        }
+    }
+
+    const PluginRegistry::Impl::Entry *
+        PluginRegistry::Impl::Table::find(const char *key, size_t size, uint64_t hash) const {
+        for (size_t pos = hash & mask; buckets[pos]; pos = (pos + 1) & mask) {
+            const auto &entry = entries[buckets[pos] - 1];
+            if (entry.hash == hash && entry.key.size() == size &&
+                memcmp(entry.key.data(), key, size) == 0) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    PluginRegistry::Impl::Impl() : epoch(0), table(new Table({})) {
+        for (auto &shard : shards) {
+            shard.readers[0] = 0;
+            shard.readers[1] = 0;
+        }
+    }
+
+    PluginRegistry::Impl::~Impl() {
+        delete table.load();
+    }
+
+    void PluginRegistry::Impl::publish(Table *newTable) {
+        auto oldTable = table.exchange(newTable);
+        synchronize();
+        delete oldTable;
+    }
+
+    void PluginRegistry::Impl::synchronize() {
+        // A reader may have read the epoch just before a flip and counted itself afterwards,
+        // so drain both parities: after two flips every reader of the old table is gone
+        for (int i = 0; i < 2; ++i) {
+            const unsigned parity = epoch.fetch_add(1) & 1;
+            for (auto &shard : shards) {
+                while (shard.readers[parity].load() != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    size_t PluginRegistry::Impl::currentShard() {
+        static std::atomic<size_t> nextShard(0);
+        static thread_local size_t shard = nextShard.fetch_add(1) % ShardCount;
+        return shard;
+    }
+
+    PluginRegistry::ReadLock::ReadLock(const PluginRegistry &registry)
+        : _registry(registry), _shard(Impl::currentShard()) {
+        auto &impl = *registry._impl;
+        _index = int(impl.epoch.load() & 1);
+        impl.shards[_shard].readers[_index].fetch_add(1);
+        _table = impl.table.load();
+    }
+
+    PluginRegistry::ReadLock::~ReadLock() {
+        _registry._impl->shards[_shard].readers[_index].fetch_sub(1, std::memory_order_release);
+    }
+
+    PluginLoader *PluginRegistry::ReadLock::find(const char *key, size_t size) const {
+        auto entry = static_cast<const Impl::Table *>(_table)->find(
+            key, size, SymbolName::hash(key, size));
+        return entry ? entry->plugin : nullptr;
+    }
+
+    PluginLoader *PluginRegistry::ReadLock::find(const std::string &key) const {
+        return find(key.data(), key.size());
+    }
+
+    void *PluginRegistry::ReadLock::instance(const std::string &key) const {
+        auto plugin = find(key);
+        return plugin ? plugin->instance() : nullptr;
+    }
+
+    size_t PluginRegistry::ReadLock::size() const {
+        return static_cast<const Impl::Table *>(_table)->entries.size();
+    }
+
+    PluginRegistry::PluginRegistry() : _impl(new Impl()) {
+    }
+
+    PluginRegistry::~PluginRegistry() {
+    }
+
+    bool PluginRegistry::add(const std::string &key, PluginLoader *plugin) {
+        std::lock_guard<std::mutex> lock(_impl->writeMutex);
+        auto current = _impl->table.load();
+        const uint64_t hash = SymbolName::hash(key.data(), key.size());
+        if (current->find(key.data(), key.size(), hash)) {
+            return false;
+        }
+
+        auto entries = current->entries;
+        entries.push_back({key, hash, plugin});
+        _impl->publish(new Impl::Table(std::move(entries)));
+        return true;
+    }
+
+    PluginLoader *PluginRegistry::remove(const std::string &key) {
+        std::lock_guard<std::mutex> lock(_impl->writeMutex);
+        auto current = _impl->table.load();
+        auto entry = current->find(key.data(), key.size(),
+                                   SymbolName::hash(key.data(), key.size()));
+        if (!entry) {
+            return nullptr;
+        }
+        auto plugin = entry->plugin;
+
+        std::vector<Impl::Entry> entries;
+        entries.reserve(current->entries.size() - 1);
+        for (const auto &item : current->entries) {
+            if (&item != entry) {
+                entries.push_back(item);
+            }
+        }
+        _impl->publish(new Impl::Table(std::move(entries)));
+        return plugin;
+    }
+
+    void PluginRegistry::clear() {
+        std::lock_guard<std::mutex> lock(_impl->writeMutex);
+        _impl->publish(new Impl::Table({}));
+    }
+
+    std::vector<std::string> PluginRegistry::keys() const {
+        std::lock_guard<std::mutex> lock(_impl->writeMutex);
+        std::vector<std::string> res;
+        for (const auto &entry : _impl->table.load()->entries) {
+            res.push_back(entry.key);
+        }
+        return res;
+    }
+
+}
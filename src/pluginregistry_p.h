@@ -0,0 +1,54 @@
+#ifndef PLUGINREGISTRY_P_H
+#define PLUGINREGISTRY_P_H
+
+#include <atomic>
+#include <mutex>
+
+#include "pluginregistry.h"
+
+namespace LoadSO {
+
+    class PluginRegistry::Impl {
+    public:
+        struct Entry {
+            std::string key;
+            uint64_t hash;
+            PluginLoader *plugin;
+        };
+
+        // Immutable once published
+        struct Table {
+            std::vector<Entry> entries;
+            std::vector<uint32_t> buckets; // entry index + 1, 0 for an empty bucket
+            size_t mask = 0;
+
+            explicit Table(std::vector<Entry> entries);
+
+            const Entry *find(const char *key, size_t size, uint64_t hash) const;
+        };
+
+        // Reader counts of both epoch parities, padded to keep shards on separate cache lines
+        struct Shard {
+            std::atomic<size_t> readers[2];
+            char padding[128 - 2 * sizeof(std::atomic<size_t>)];
+        };
+
+        static constexpr const size_t ShardCount = 64;
+
+        Impl();
+        ~Impl();
+
+        Shard shards[ShardCount];
+        std::atomic<unsigned> epoch;
+        std::atomic<const Table *> table;
+        std::mutex writeMutex;
+
+        void publish(Table *newTable);
+        void synchronize();
+
+        static size_t currentShard();
+    };
+
+}
+
+#endif // PLUGINREGISTRY_P_H
@@ -0,0 +1,321 @@
+#include "samplingprofiler.h"
+#include "samplingprofiler_p.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include "system.h"
+
+#ifdef LOADSO_SAMPLING_PROFILER
+#  include <cerrno>
+#  include <csignal>
+#  include <link.h>
+#  include <sys/time.h>
+#  include <ucontext.h>
+#endif
+
+namespace LoadSO {
+
+#ifdef LOADSO_SAMPLING_PROFILER
+
+    static constexpr const size_t MaxModules = 1024;
+
+    // Modules are never removed, so that an unloaded plugin keeps its samples
+    struct ModuleSlot {
+        std::string path;
+        uintptr_t base = 0;
+        std::atomic<uint64_t> samples{0};
+    };
+
+    struct RangeIndex {
+        struct Range {
+            uintptr_t start;
+            uintptr_t end;
+            size_t module;
+        };
+        std::vector<Range> ranges; // Sorted by start, not overlapping
+
+        const Range *find(uintptr_t pc) const {
+            auto it = std::upper_bound(ranges.begin(), ranges.end(), pc,
+                                       [](uintptr_t pc, const Range &r) { return pc < r.start; });
+            if (it == ranges.begin() || pc >= (--it)->end) {
+                return nullptr;
+            }
+            return &*it;
+        }
+    };
+
+    static ModuleSlot g_Modules[MaxModules];
+    static size_t g_ModuleCount = 0;
+    static std::atomic<uint64_t> g_Unknown(0);
+
+    static std::atomic<RangeIndex *> g_Index(nullptr);
+    static std::atomic<int> g_HandlerReaders(0);
+    static std::atomic<bool> g_Running(false);
+
+    // Guards the module table, the index and the timer
+    static std::mutex g_Mutex;
+    static unsigned long long g_Adds = 0, g_Subs = 0;
+
+    static uintptr_t programCounter(void *context) {
+        auto uc = static_cast<ucontext_t *>(context);
+#  if defined(__x86_64__)
+        return uintptr_t(uc->uc_mcontext.gregs[REG_RIP]);
+#  elif defined(__i386__)
+        return uintptr_t(uc->uc_mcontext.gregs[REG_EIP]);
+#  else
+        return uintptr_t(uc->uc_mcontext.pc);
+#  endif
+    }
+
+    static void onSample(int sig, siginfo_t *info, void *context) {
+        (void) sig;
+        (void) info;
+        const int savedErrno = errno;
+        const uintptr_t pc = programCounter(context);
+
+        // The index is freed only when no handler uses it
+        g_HandlerReaders.fetch_add(1);
+        auto index = g_Index.load();
+        auto range = index ? index->find(pc) : nullptr;
+        g_HandlerReaders.fetch_sub(1);
+
+        (range ? g_Modules[range->module].samples : g_Unknown)
+            .fetch_add(1, std::memory_order_relaxed);
+        errno = savedErrno;
+    }
+
+    static size_t moduleSlot(const std::string &path, uintptr_t base) {
+        for (size_t i = 0; i < g_ModuleCount; ++i) {
+            if (g_Modules[i].base == base && g_Modules[i].path == path) {
+                return i;
+            }
+        }
+        if (g_ModuleCount == MaxModules) {
+            return MaxModules;
+        }
+        auto &slot = g_Modules[g_ModuleCount];
+        slot.path = path;
+        slot.base = base;
+        return g_ModuleCount++;
+    }
+
+    struct BuildContext {
+        bool changed = false;
+        RangeIndex *index = nullptr;
+    };
+
+    static int collectObject(struct dl_phdr_info *info, size_t size, void *data) {
+        auto ctx = static_cast<BuildContext *>(data);
+        (void) size;
+        if (!ctx->index) {
+            // The counters are the same for every object, stop at the first if nothing changed
+            ctx->changed = info->dlpi_adds != g_Adds || info->dlpi_subs != g_Subs;
+            g_Adds = info->dlpi_adds;
+            g_Subs = info->dlpi_subs;
+            if (!ctx->changed) {
+                return 1;
+            }
+            ctx->index = new RangeIndex();
+        }
+
+        std::string path = info->dlpi_name ? info->dlpi_name : "";
+        if (path.empty()) {
+            path = System::MultiFromPathString(System::ApplicationPath());
+        }
+        size_t module = MaxModules;
+        for (int i = 0; i < info->dlpi_phnum; ++i) {
+            const auto &phdr = info->dlpi_phdr[i];
+            if (phdr.p_type != PT_LOAD || !(phdr.p_flags & PF_X)) {
+                continue;
+            }
+            if (module == MaxModules) {
+                module = moduleSlot(path, info->dlpi_addr);
+                if (module == MaxModules) {
+                    return 0;
+                }
+            }
+            const uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+            ctx->index->ranges.push_back({start, start + phdr.p_memsz, module});
+        }
+        return 0;
+    }
+
+    // Caller holds g_Mutex
+    static void rebuild(bool force) {
+        if (force) {
+            g_Adds = g_Subs = ~0ULL;
+        }
+        BuildContext ctx;
+        dl_iterate_phdr(collectObject, &ctx);
+        if (!ctx.changed) {
+            return;
+        }
+        auto &ranges = ctx.index->ranges;
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const RangeIndex::Range &a, const RangeIndex::Range &b) {
+                      return a.start < b.start;
+                  });
+
+        auto old = g_Index.exchange(ctx.index);
+        while (g_HandlerReaders.load() != 0) {
+            std::this_thread::yield();
+        }
+        delete old;
+    }
+
+#endif
+
+    namespace SamplingProfilerPrivate {
+
+        void librariesChanged() {
+#ifdef LOADSO_SAMPLING_PROFILER
+            if (g_Running) {
+                std::lock_guard<std::mutex> lock(g_Mutex);
+                rebuild(false);
+            }
+#endif
+        }
+
+    }
+
+    bool SamplingProfiler::Start(int frequency) {
+#ifdef LOADSO_SAMPLING_PROFILER
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        if (g_Running || frequency <= 0) {
+            return false;
+        }
+        struct sigaction old;
+        if (sigaction(SIGPROF, nullptr, &old) != 0 || (old.sa_flags & SA_SIGINFO) ||
+            (old.sa_handler != SIG_DFL && old.sa_handler != SIG_IGN)) {
+            return false;
+        }
+        rebuild(true);
+
+        struct sigaction action = {};
+        action.sa_sigaction = onSample;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            return false;
+        }
+
+        const long interval = std::max(1L, 1000000L / frequency);
+        struct itimerval timer = {};
+        timer.it_interval.tv_sec = interval / 1000000;
+        timer.it_interval.tv_usec = interval % 1000000;
+        timer.it_value = timer.it_interval;
+        if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+            sigaction(SIGPROF, &old, nullptr);
+            return false;
+        }
+        g_Running = true;
+        return true;
+#else
+        (void) frequency;
+        return false;
+#endif
+    }
+
+    void SamplingProfiler::Stop() {
+#ifdef LOADSO_SAMPLING_PROFILER
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        if (!g_Running) {
+            return;
+        }
+        struct itimerval timer = {};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+
+        // A pending signal must not kill the process, the default action is not restored
+        struct sigaction action = {};
+        action.sa_handler = SIG_IGN;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        g_Running = false;
+#endif
+    }
+
+    bool SamplingProfiler::IsRunning() {
+#ifdef LOADSO_SAMPLING_PROFILER
+        return g_Running;
+#else
+        return false;
+#endif
+    }
+
+    void SamplingProfiler::Refresh() {
+        SamplingProfilerPrivate::librariesChanged();
+    }
+
+    std::vector<SamplingProfiler::Module> SamplingProfiler::Snapshot() {
+        std::vector<Module> res;
+#ifdef LOADSO_SAMPLING_PROFILER
+        std::lock_guard<std::mutex> lock(g_Mutex);
+
+        // Samples of a library reloaded at another address are merged
+        for (size_t i = 0; i < g_ModuleCount; ++i) {
+            const uint64_t samples = g_Modules[i].samples.load(std::memory_order_relaxed);
+            if (samples == 0) {
+                continue;
+            }
+            auto it = std::find_if(res.begin(), res.end(), [i](const Module &m) {
+                return m.path == g_Modules[i].path;
+            });
+            if (it == res.end()) {
+                Module module;
+                module.path = g_Modules[i].path;
+                module.samples = samples;
+                res.push_back(module);
+            } else {
+                it->samples += samples;
+            }
+        }
+        const uint64_t unknown = g_Unknown.load(std::memory_order_relaxed);
+        if (unknown > 0) {
+            Module module;
+            module.samples = unknown;
+            res.push_back(module);
+        }
+        std::stable_sort(res.begin(), res.end(), [](const Module &a, const Module &b) {
+            return a.samples > b.samples;
+        });
+#endif
+        return res;
+    }
+
+    void SamplingProfiler::Reset() {
+#ifdef LOADSO_SAMPLING_PROFILER
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        for (size_t i = 0; i < g_ModuleCount; ++i) {
+            g_Modules[i].samples.store(0, std::memory_order_relaxed);
+        }
+        g_Unknown.store(0, std::memory_order_relaxed);
+#endif
+    }
+
+    std::string SamplingProfiler::Report() {
+        const auto modules = Snapshot();
+        uint64_t total = 0;
+        for (const auto &module : modules) {
+            total += module.samples;
+        }
+
+        std::string res;
+        char buf[512];
+        snprintf(buf, sizeof(buf), "%llu samples\n  %10s %7s  %s\n", (unsigned long long) total,
+                 "samples", "share", "object");
+        res += buf;
+        for (const auto &module : modules) {
+            snprintf(buf, sizeof(buf), "  %10llu %6.2f%%  %s\n",
+                     (unsigned long long) module.samples,
+                     100.0 * double(module.samples) / double(total),
+                     module.path.empty() ? "<unknown>" : module.path.data());
+            res += buf;
+        }
+        return res;
+    }
+
+}
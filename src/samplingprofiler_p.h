@@ -0,0 +1,23 @@
+#ifndef SAMPLINGPROFILER_P_H
+#define SAMPLINGPROFILER_P_H
+
+#include "samplingprofiler.h"
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#  define LOADSO_SAMPLING_PROFILER
+#endif
+
+namespace LoadSO {
+
+    namespace SamplingProfilerPrivate {
+
+        /**
+         * @brief Refreshes the index if the sampler is running.
+         */
+        void librariesChanged();
+
+    }
+
+}
+
+#endif // SAMPLINGPROFILER_P_H
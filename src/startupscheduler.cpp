@@ -0,0 +1,199 @@
+#include "startupscheduler.h"
+#include "startupscheduler_p.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "system.h"
+
+namespace LoadSO {
+
+    StartupScheduler::Impl::~Impl() {
+        join();
+    }
+
+    void StartupScheduler::Impl::run(size_t index) {
+        auto &task = tasks[index];
+        auto plugin = task.result.plugin;
+
+        auto start = std::chrono::steady_clock::now();
+        const bool loaded = plugin->isLoaded() || plugin->load(task.hints);
+        const auto loadTime = std::chrono::steady_clock::now() - start;
+
+        Result result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &res = task.result;
+            res.finished = true;
+            res.loaded = loaded;
+            res.loadTime = loadTime;
+            res.budget = task.budget.count() > 0 ? task.budget : budgets[res.priority];
+            result = res;
+            remaining--;
+        }
+        finishedCond.notify_all();
+
+        if (result.isOverBudget() && overBudgetHandler) {
+            overBudgetHandler(result);
+        }
+    }
+
+    void StartupScheduler::Impl::join() {
+        for (auto &thread : workers) {
+            thread.join();
+        }
+        workers.clear();
+    }
+
+    StartupScheduler::StartupScheduler() : _impl(new Impl()) {
+    }
+
+    StartupScheduler::~StartupScheduler() = default;
+
+    bool StartupScheduler::addPlugin(PluginLoader *plugin, int hints,
+                                     std::chrono::nanoseconds budget) {
+        if (!plugin || _impl->started) {
+            return false;
+        }
+        Impl::Task task;
+        task.hints = hints;
+        task.budget = budget;
+        task.result.plugin = plugin;
+        task.result.priority = plugin->priority();
+
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->tasks.push_back(task);
+        _impl->remaining++;
+        return true;
+    }
+
+    void StartupScheduler::setBudget(PluginLoader::Priority priority,
+                                     std::chrono::nanoseconds budget) {
+        _impl->budgets[priority] = budget;
+    }
+
+    std::chrono::nanoseconds StartupScheduler::budget(PluginLoader::Priority priority) const {
+        return _impl->budgets[priority];
+    }
+
+    void StartupScheduler::setThreads(int threads) {
+        _impl->threads = threads;
+    }
+
+    void StartupScheduler::setOverBudgetHandler(
+        const std::function<void(const Result &)> &handler) {
+        _impl->overBudgetHandler = handler;
+    }
+
+    bool StartupScheduler::loadCritical() {
+        bool res = true;
+        for (size_t i = 0; i < _impl->tasks.size(); ++i) {
+            auto &task = _impl->tasks[i];
+            if (task.result.priority != PluginLoader::CriticalPriority) {
+                continue;
+            }
+            if (!task.result.finished) {
+                _impl->run(i);
+            }
+            res &= task.result.loaded;
+        }
+        _impl->criticalLoaded = true;
+        return res;
+    }
+
+    void StartupScheduler::ready() {
+        if (_impl->started) {
+            return;
+        }
+        if (!_impl->criticalLoaded) {
+            loadCritical();
+        }
+        _impl->started = true;
+
+        auto &queue = _impl->queue;
+        for (size_t i = 0; i < _impl->tasks.size(); ++i) {
+            if (_impl->tasks[i].result.priority != PluginLoader::CriticalPriority) {
+                queue.push_back(i);
+            }
+        }
+        std::stable_sort(queue.begin(), queue.end(), [this](size_t a, size_t b) {
+            return _impl->tasks[a].result.priority < _impl->tasks[b].result.priority;
+        });
+
+        int threads = _impl->threads;
+        if (threads <= 0) {
+            threads = std::max(1, int(std::thread::hardware_concurrency()));
+        }
+        threads = std::min<int>(threads, int(queue.size()));
+
+        auto impl = _impl.get();
+        for (int i = 0; i < threads; ++i) {
+            _impl->workers.emplace_back([impl]() {
+                for (size_t i = impl->next++; i < impl->queue.size(); i = impl->next++) {
+                    impl->run(impl->queue[i]);
+                }
+            });
+        }
+    }
+
+    bool StartupScheduler::wait() {
+        ready();
+        {
+            std::unique_lock<std::mutex> lock(_impl->mutex);
+            _impl->finishedCond.wait(lock, [this]() { return _impl->remaining == 0; });
+        }
+        _impl->join();
+
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return std::all_of(_impl->tasks.begin(), _impl->tasks.end(),
+                           [](const Impl::Task &task) { return task.result.loaded; });
+    }
+
+    bool StartupScheduler::isFinished() const {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        return _impl->remaining == 0;
+    }
+
+    std::vector<StartupScheduler::Result> StartupScheduler::results() const {
+        std::vector<Result> res;
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        for (const auto &task : _impl->tasks) {
+            res.push_back(task.result);
+        }
+        return res;
+    }
+
+    std::vector<StartupScheduler::Result> StartupScheduler::overBudget() const {
+        auto res = results();
+        res.erase(std::remove_if(res.begin(), res.end(),
+                                 [](const Result &r) { return !r.isOverBudget(); }),
+                  res.end());
+        return res;
+    }
+
+    std::string StartupScheduler::report() const {
+        static const char *const tierNames[] = {"critical", "normal", "background"};
+
+        std::string res;
+        char buf[512];
+        for (const auto &result : results()) {
+            if (!result.finished) {
+                continue;
+            }
+            const auto path = System::MultiFromPathString(result.plugin->path());
+            snprintf(buf, sizeof(buf), "%-10s %10.3f ms", tierNames[result.priority],
+                     double(result.loadTime.count()) / 1e6);
+            res += buf;
+            if (result.budget.count() > 0) {
+                snprintf(buf, sizeof(buf), " / %10.3f ms%s", double(result.budget.count()) / 1e6,
+                         result.isOverBudget() ? " OVER" : "");
+                res += buf;
+            }
+            res += result.loaded ? "  " : "  FAILED ";
+            res += path;
+            res += '\n';
+        }
+        return res;
+    }
+
+}
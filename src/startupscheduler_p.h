@@ -0,0 +1,43 @@
+#ifndef STARTUPSCHEDULER_P_H
+#define STARTUPSCHEDULER_P_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "startupscheduler.h"
+
+namespace LoadSO {
+
+    class StartupScheduler::Impl {
+    public:
+        ~Impl();
+
+        struct Task {
+            int hints;
+            std::chrono::nanoseconds budget;
+            Result result;
+        };
+        std::vector<Task> tasks;
+        std::chrono::nanoseconds budgets[3] = {};
+        int threads = 0;
+        std::function<void(const Result &)> overBudgetHandler;
+
+        bool criticalLoaded = false;
+        bool started = false;
+        std::vector<size_t> queue; // Non critical tasks, normal ones first
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> workers;
+
+        mutable std::mutex mutex; // Guards the results
+        std::condition_variable finishedCond;
+        size_t remaining = 0;
+
+        void run(size_t index);
+        void join();
+    };
+
+}
+
+#endif // STARTUPSCHEDULER_P_H
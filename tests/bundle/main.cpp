@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <loadso/filedigest.h>
+#include <loadso/pluginbundle.h>
+
+#include "interface.h"
+
+using namespace LoadSO;
+
+static std::string readFile(const char *path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char *argv[]) {
+    if (!PluginBundle::Pack(LOADSO_STR(BUNDLE_NAME),
+                            {
+                                {"plugin1", LOADSO_STR(PLUGIN1_NAME)},
+                                {"plugin2", LOADSO_STR(PLUGIN2_NAME)},
+                            })) {
+        printf("pack failed\n");
+        return -1;
+    }
+
+    // A failed pack leaves the previous bundle in place
+    const auto packed = readFile(BUNDLE_NAME);
+    if (PluginBundle::Pack(LOADSO_STR(BUNDLE_NAME), {{"missing", LOADSO_STR("not_exist")}}) ||
+        PluginBundle::Pack(LOADSO_STR(BUNDLE_NAME),
+                           {
+                               {"plugin1", LOADSO_STR(PLUGIN1_NAME)},
+                               {"plugin1", LOADSO_STR(PLUGIN2_NAME)},
+                           }) ||
+        readFile(BUNDLE_NAME) != packed) {
+        printf("failed pack replaced the bundle\n");
+        return -1;
+    }
+
+    PluginBundle bundle;
+    if (!bundle.open(LOADSO_STR(BUNDLE_NAME))) {
+        printf("open failed\n");
+        return -1;
+    }
+
+    // Index
+    const auto &index = bundle.index();
+    const auto entry1 = index.find("plugin1");
+    const auto entry2 = index.find("plugin2");
+    if (index.entries().size() != 2 || !entry1 || !entry2) {
+        printf("index mismatch\n");
+        return -1;
+    }
+    printf("plugin1 metadata: %s, digest: %s\n", entry1->info.metadata.data(),
+           entry1->digest.data());
+    printf("plugin2 metadata: %s, digest: %s\n", entry2->info.metadata.data(),
+           entry2->digest.data());
+
+    // Members are stored verbatim and page aligned
+    const auto image1 = readFile(PLUGIN1_NAME);
+    const void *data;
+    size_t size;
+    if (!bundle.data("plugin1", &data, &size) || size != image1.size() ||
+        image1.compare(0, size, static_cast<const char *>(data), size) != 0 ||
+        reinterpret_cast<uintptr_t>(data) % 4096 != 0) {
+        printf("member data mismatch\n");
+        return -1;
+    }
+    if (entry1->digest != FileDigest::Hash(image1.data(), image1.size()) ||
+        bundle.data("plugin3", &data, &size)) {
+        printf("member lookup mismatch\n");
+        return -1;
+    }
+
+    // Extract
+    if (!bundle.extract("plugin1", LOADSO_STR(EXTRACT_NAME)) ||
+        readFile(EXTRACT_NAME) != image1) {
+        printf("extract failed\n");
+        return -1;
+    }
+
+    // Load
+    PluginLoader plugin2;
+    plugin2.setAllowedDigests({entry2->digest});
+    if (!bundle.load("plugin2", &plugin2, 0)) {
+        printf("load failed: %s\n", plugin2.lastError().data());
+        return -1;
+    }
+    auto instance = static_cast<Interface *>(plugin2.instance());
+    if (!instance || plugin2.metaData() != entry2->info.metadata) {
+        printf("loaded plugin mismatch\n");
+        return -1;
+    }
+    printf("plugin2 key: %s\n", instance->key());
+
+    // Corrupted bundle
+    {
+        std::fstream file(BUNDLE_NAME, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(0);
+        file.write("XXXXXXXX", 8);
+    }
+    PluginBundle corrupted;
+    if (corrupted.open(LOADSO_STR(BUNDLE_NAME)) || corrupted.isOpen()) {
+        printf("corrupted bundle accepted\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -5,4 +5,17 @@
 int add(int x, int y) {
     std::cout << "Call add " << x << ", " << y << std::endl;
     return x + y;
-}
\ No newline at end of file
+}
+double scale(double x, double factor) {
+    return x * factor;
+}
+
+unsigned long long burn(unsigned long long n) {
+    volatile unsigned long long x = 0;
+    for (unsigned long long i = 0; i < n; ++i) {
+        x = x * 31 + i;
+    }
+    return x;
+}
+
+int dll_version = 1;
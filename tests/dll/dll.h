@@ -9,4 +9,10 @@
 
 extern "C" DLL_EXPORT int add(int x, int y);
 
+extern "C" DLL_EXPORT double scale(double x, double factor);
+
+extern "C" DLL_EXPORT unsigned long long burn(unsigned long long n);
+
+extern "C" DLL_EXPORT int dll_version;
+
 #endif // DLL_H
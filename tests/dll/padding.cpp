@@ -0,0 +1,4 @@
+// 6 MiB of never executed code, so that the text segment spans whole 2 MiB pages
+__asm__(".pushsection .text.padding,\"ax\",@progbits\n"
+        ".skip 6291456\n"
+        ".popsection\n");
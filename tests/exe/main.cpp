@@ -1,8 +1,18 @@
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <loadso/callprofiler.h>
 #include <loadso/library.h>
+#include <loadso/samplingprofiler.h>
 #include <loadso/system.h>
 
+#include "dll_functions.h"
+
 #ifdef _WIN32
 #  include <fcntl.h>
 #  include <io.h>
@@ -59,5 +69,209 @@ int main(int argc, char *argv[]) {
     // Call function
     std::cout << add_func(1, 3) << std::endl;
 
+    // Resolve by precomputed name
+    PrintLine(LOADSO_STR("[Test Resolve Cached]"));
+    static constexpr SymbolName addName("add");
+    if (lib.resolve(addName) != (EntryHandle) add_func ||
+        lib.resolve(addName) != (EntryHandle) add_func) {
+        System::ShowError(LOADSO_STR("Cached resolve mismatch"));
+        return -1;
+    }
+    char addBuffer[64] = "add";
+    if (SymbolName(addBuffer).size() != 3 || lib.resolve(SymbolName(addBuffer)) != (EntryHandle) add_func) {
+        System::ShowError(LOADSO_STR("Buffer name resolve mismatch"));
+        return -1;
+    }
+    PrintLine(LOADSO_STR("OK"));
+
+    // Probe optional symbol
+    PrintLine(LOADSO_STR("[Test Resolve Missing]"));
+    static constexpr SymbolName missingName("not_exist");
+    for (int i = 0; i < 2; ++i) {
+        if (lib.resolve(missingName) || lib.errorCode() != Library::SymbolNotFoundError) {
+            System::ShowError(LOADSO_STR("Missing symbol probe failed"));
+            return -1;
+        }
+    }
+    PrintLine(System::MultiToPathString(lib.lastError()));
+
+    // Failures on several threads keep their own messages
+    PrintLine(LOADSO_STR("[Test Concurrent Errors]"));
+    {
+        std::vector<std::thread> threads;
+        std::vector<int> mismatches(4);
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&lib, &mismatches, i]() {
+                const std::string name = "missing_" + std::to_string(i);
+                for (int j = 0; j < 1000; ++j) {
+                    if (lib.resolve(name.data()) ||
+                        lib.lastError().find(name) == std::string::npos) {
+                        mismatches[i]++;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (int count : mismatches) {
+            if (count != 0) {
+                System::ShowError(LOADSO_STR("Concurrent error messages mixed up"));
+                return -1;
+            }
+        }
+    }
+    PrintLine(LOADSO_STR("OK"));
+
+    // Fetch the function table
+    PrintLine(LOADSO_STR("[Test Function Table]"));
+    auto table = lib.functionTable("dll", LOADSO_FUNCTIONS_DLL_VERSION, LOADSO_FUNCTIONS_DLL_COUNT,
+                                   LOADSO_FUNCTIONS_DLL_HASH);
+    if (!table || table[LOADSO_FUNCTIONS_DLL_add] != (EntryHandle) add_func ||
+        ((AddFunc) table[LOADSO_FUNCTIONS_DLL_add])(2, 3) != 5) {
+        System::ShowError(LOADSO_STR("Function table mismatch"));
+        return -1;
+    }
+    if (lib.functionTable("dll", LOADSO_FUNCTIONS_DLL_VERSION + 1, 0) ||
+        lib.errorCode() != Library::IncompatibleError ||
+        lib.functionTable("dll", LOADSO_FUNCTIONS_DLL_VERSION, 0, 1) ||
+        lib.errorCode() != Library::IncompatibleError) {
+        System::ShowError(LOADSO_STR("Incompatible function table accepted"));
+        return -1;
+    }
+    PrintLine(System::MultiToPathString(lib.lastError()));
+
+#ifdef __GLIBC__
+    // Load private copies
+    PrintLine(LOADSO_STR("[Test Isolated Namespace]"));
+    {
+        Library copies[2];
+        for (auto &copy : copies) {
+            if (!copy.open(LOADSO_STR(DLL_NAME), Library::IsolatedNamespaceHint)) {
+                System::ShowError(System::MultiToPathString(copy.lastError()));
+                return -1;
+            }
+        }
+        auto version0 = (int *) copies[0].resolve("dll_version");
+        auto version1 = (int *) copies[1].resolve("dll_version");
+        auto version = (int *) lib.resolve("dll_version");
+        if (!version0 || !version1 || version0 == version1 || version0 == version) {
+            System::ShowError(LOADSO_STR("Isolated copies share their data"));
+            return -1;
+        }
+        *version0 = 2;
+        if (*version1 != 1 || *version != 1 || ((AddFunc) copies[1].resolve("add"))(1, 2) != 3) {
+            System::ShowError(LOADSO_STR("Isolated copies share their state"));
+            return -1;
+        }
+    }
+    PrintLine(LOADSO_STR("OK"));
+#endif
+
+#ifdef __linux__
+    // Reopen from memory, the previous library and its descriptor are released first
+    PrintLine(LOADSO_STR("[Test Reopen From Memory]"));
+    {
+        std::ifstream file(DLL_NAME, std::ios::binary);
+        std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        Library memory;
+        if (!memory.openFromMemory(image.data(), image.size(), 0, "testdll")) {
+            System::ShowError(System::MultiToPathString(memory.lastError()));
+            return -1;
+        }
+        const auto firstPath = memory.path();
+        if (!memory.openFromMemory(image.data(), image.size(), 0, "testdll") ||
+            memory.path() != firstPath || !memory.resolve("add")) {
+            System::ShowError(LOADSO_STR("Reopening from memory leaked the descriptor"));
+            return -1;
+        }
+    }
+    PrintLine(LOADSO_STR("OK"));
+#endif
+
+#ifdef HUGE_DLL_NAME
+    // Remap text onto huge pages
+    PrintLine(LOADSO_STR("[Test Huge Page Text]"));
+    Library huge;
+    if (!huge.open(LOADSO_STR(HUGE_DLL_NAME),
+                   Library::ResolveAllSymbolsHint | Library::HugePageTextHint)) {
+        System::ShowError(System::MultiToPathString(huge.lastError()));
+        return -1;
+    }
+    auto huge_add_func = (AddFunc) huge.resolve("add");
+    if (!huge_add_func || huge_add_func(2, 5) != 7) {
+        System::ShowError(LOADSO_STR("Remapped code failed"));
+        return -1;
+    }
+    std::cout << "Remapped " << huge.hugePageTextSize() << " bytes" << std::endl;
+#endif
+
+    // Profile calls
+    if (CallProfiler::IsSupported()) {
+        PrintLine(LOADSO_STR("[Test Profile Calls]"));
+        Library profiled;
+        if (!profiled.open(LOADSO_STR(DLL_NAME), Library::ProfileCallsHint)) {
+            System::ShowError(System::MultiToPathString(profiled.lastError()));
+            return -1;
+        }
+        using ScaleFunc = double (*)(double, double);
+        auto profiled_add = (AddFunc) profiled.resolve("add");
+        auto profiled_scale = (ScaleFunc) profiled.resolve(SymbolName("scale"));
+        if ((EntryHandle) profiled_add == (EntryHandle) add_func ||
+            profiled.resolve("add") != (EntryHandle) profiled_add ||
+            profiled.resolve("dll_version") != lib.resolve("dll_version")) {
+            System::ShowError(LOADSO_STR("Profiled resolve mismatch"));
+            return -1;
+        }
+        CallProfiler::Reset();
+        for (int i = 0; i < 100; ++i) {
+            if (profiled_add(i, 1) != i + 1 || profiled_scale(i, 0.5) != i * 0.5) {
+                System::ShowError(LOADSO_STR("Profiled call failed"));
+                return -1;
+            }
+        }
+        CallProfiler::SetEnabled(false);
+        profiled_scale(1, 2);
+        CallProfiler::SetEnabled(true);
+
+        auto exports = CallProfiler::Snapshot();
+        if (exports.size() != 2 || exports[0].name != "add" || exports[0].calls != 100 ||
+            exports[1].name != "scale" || exports[1].calls != 100 ||
+            exports[0].totalNs == 0) {
+            System::ShowError(LOADSO_STR("Profile mismatch"));
+            return -1;
+        }
+        std::cout << CallProfiler::Report();
+    }
+
+    // Sample CPU time
+    if (SamplingProfiler::Start(1000)) {
+        PrintLine(LOADSO_STR("[Test Sampling Profiler]"));
+        Library sampled;
+        if (!sampled.open(LOADSO_STR(DLL_NAME))) {
+            System::ShowError(System::MultiToPathString(sampled.lastError()));
+            return -1;
+        }
+        using BurnFunc = unsigned long long (*)(unsigned long long);
+        auto burn_func = (BurnFunc) sampled.resolve("burn");
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(300)) {
+            burn_func(1000000);
+        }
+        SamplingProfiler::Stop();
+
+        auto modules = SamplingProfiler::Snapshot();
+        uint64_t total = 0;
+        for (const auto &module : modules) {
+            total += module.samples;
+        }
+        std::cout << SamplingProfiler::Report();
+        const std::string dllName = System::MultiFromPathString(LOADSO_STR(DLL_NAME));
+        if (modules.empty() || modules[0].path != dllName || modules[0].samples * 2 < total) {
+            System::ShowError(LOADSO_STR("Samples not attributed to the library"));
+            return -1;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
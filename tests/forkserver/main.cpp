@@ -0,0 +1,109 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <loadso/forkserver.h>
+
+#ifndef _WIN32
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+#include "interface.h"
+
+using namespace LoadSO;
+
+int main(int argc, char *argv[]) {
+#ifdef _WIN32
+    printf("Fork server is not supported on Windows\n");
+    return 0;
+#else
+    ForkServer server;
+    server.addPlugin(LOADSO_STR(PLUGIN1_NAME));
+    server.addPlugin(LOADSO_STR(PLUGIN2_NAME));
+    server.setWarmUp([](PluginLoader &plugin) {
+        printf("zygote warms up %s\n", static_cast<Interface *>(plugin.instance())->key());
+    });
+    server.setWorkerMain([](ForkServer &server, const std::string &arg) {
+        // The plugins are already constructed, nothing should be printed by the constructors
+        auto plugin = server.plugin(arg);
+        if (!plugin || !plugin->instance()) {
+            return 1;
+        }
+        printf("worker %d uses %s\n", int(getpid()),
+               static_cast<Interface *>(plugin->instance())->key());
+        return 0;
+    });
+
+    printf("[Test Start]\n");
+    if (!server.start()) {
+        printf("start failed: %s\n", server.lastError().data());
+        return -1;
+    }
+
+    printf("[Test Spawn]\n");
+    int pids[] = {
+        server.spawn(PLUGIN1_NAME),
+        server.spawn(PLUGIN2_NAME),
+        server.spawn("not_exist"),
+    };
+    int expected[] = {0, 0, 1};
+    for (int i = 0; i < 3; ++i) {
+        int status = server.wait(pids[i]);
+        if (pids[i] < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != expected[i]) {
+            printf("worker %d failed\n", i);
+            return -1;
+        }
+    }
+    printf("OK\n");
+
+    printf("[Test Concurrent Requests]\n");
+    {
+        std::atomic<int> failures(0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&]() {
+                for (int j = 0; j < 20; ++j) {
+                    const int pid = server.spawn(PLUGIN1_NAME);
+                    const int status = server.wait(pid);
+                    if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                        failures++;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        if (failures != 0) {
+            printf("%d requests mixed up\n", int(failures));
+            return -1;
+        }
+    }
+    printf("OK\n");
+
+#  ifdef __linux__
+    printf("[Test Reap]\n");
+    {
+        // The worker is reaped when it exits, not on the next request
+        const int pid = server.spawn(PLUGIN1_NAME);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+        const bool exists = bool(stat);
+        const int status = server.wait(pid);
+        if (pid < 0 || exists || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("worker not reaped\n");
+            return -1;
+        }
+    }
+    printf("OK\n");
+#  endif
+
+    server.stop();
+    return server.isRunning() ? -1 : 0;
+#endif
+}
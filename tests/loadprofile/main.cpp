@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <thread>
+
+#include <loadso/loadprofile.h>
+#include <loadso/system.h>
+
+#include "interface.h"
+
+using namespace LoadSO;
+
+int main(int argc, char *argv[]) {
+    PluginLoader plugin1(LOADSO_STR(PLUGIN1_NAME));
+    PluginLoader plugin2(LOADSO_STR(PLUGIN2_NAME));
+
+    // First start, plugin1 is used and plugin2 only loaded
+    printf("[Test Record]\n");
+    if (!LoadProfile::StartRecording(std::chrono::seconds(60))) {
+        printf("start failed\n");
+        return -1;
+    }
+    if (!plugin1.load(0) || !plugin2.load(0)) {
+        printf("load failed\n");
+        return -1;
+    }
+    printf("%s\n", static_cast<Interface *>(plugin1.instance())->key());
+    LoadProfile::StopRecording();
+    std::ignore = plugin2.instance();
+
+    auto recorded = LoadProfile::Recorded();
+    printf("%s", recorded.report().data());
+    auto entry1 = recorded.find(plugin1.path());
+    auto entry2 = recorded.find(plugin2.path());
+    if (recorded.entries().size() != 2 || !entry1 || !entry1->isUsed() || !entry2 ||
+        entry2->isUsed() || entry1->openedUs > entry2->openedUs) {
+        printf("unexpected profile\n");
+        return -1;
+    }
+    if (recorded.hints(plugin1.path()) != Library::ResolveAllSymbolsHint ||
+        recorded.hints(plugin2.path(), Library::ResolveAllSymbolsHint) != 0 ||
+        recorded.hints(LOADSO_STR("not_exist"), Library::DeepBindHint) != Library::DeepBindHint) {
+        printf("unexpected hints\n");
+        return -1;
+    }
+
+    printf("[Test Save]\n");
+    const auto file = System::ApplicationDirectory() + LOADSO_STR("/testloadprofile.prof");
+    LoadProfile profile;
+    if (!recorded.save(file) || !profile.load(file) || profile.toData() != recorded.toData()) {
+        printf("round trip failed\n");
+        return -1;
+    }
+    if (profile.fromData("LSOPROF 1\nL 1 2 3 4 x\n", 22)) {
+        printf("truncated profile accepted\n");
+        return -1;
+    }
+    printf("OK\n");
+
+    // Next start
+    printf("[Test Preload]\n");
+    plugin1.unload();
+    plugin2.unload();
+    printf("prefetched %d files\n", int(profile.prefetch()));
+    if (profile.preload({&plugin1, &plugin2}) != 1 || !plugin1.isLoaded() ||
+        plugin2.isLoaded()) {
+        printf("unexpected preload\n");
+        return -1;
+    }
+    printf("OK\n");
+
+    printf("[Test Window]\n");
+    plugin1.unload();
+    if (!LoadProfile::StartRecording(std::chrono::milliseconds(1))) {
+        return -1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (!plugin1.load(0) || LoadProfile::IsRecording() ||
+        !LoadProfile::Recorded().entries().empty()) {
+        printf("event recorded after the window\n");
+        return -1;
+    }
+    printf("OK\n");
+    return 0;
+}
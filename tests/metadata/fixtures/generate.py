@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""
+Generates minimal ELF, Mach-O and PE files carrying a loadso metadata resource, so that the
+host independent readers can be tested on any platform.
+
+    python3 generate.py [output directory]
+"""
+
+import os
+import struct
+import sys
+
+METADATA = b"fixture metadata"
+EXPORT = b"fixture_export"
+DEPENDENCY = b"libdep.so"
+
+
+def align(n, a):
+    return (n + a - 1) // a * a
+
+
+def make_elf(is64, big_endian, metadata):
+    e = ">" if big_endian else "<"
+    names = [b"", b".text", b".loadso_metadata", b".dynsym", b".dynstr", b".dynamic",
+             b".shstrtab"]
+    shstrtab = b"\0".join(names) + b"\0"
+    name_offsets = [shstrtab.index(n + b"\0") if n else 0 for n in names]
+
+    dynstr = b"\0" + EXPORT + b"\0" + DEPENDENCY + b"\0"
+    if is64:
+        dynsym = struct.pack(e + "IBBHQQ", 0, 0, 0, 0, 0, 0)
+        dynsym += struct.pack(e + "IBBHQQ", 1, 0x12, 0, 1, 0, 16)
+        dynamic = struct.pack(e + "qQqQ", 1, len(EXPORT) + 2, 0, 0)
+    else:
+        dynsym = struct.pack(e + "IIIBBH", 0, 0, 0, 0, 0, 0)
+        dynsym += struct.pack(e + "IIIBBH", 1, 0, 16, 0x12, 0, 1)
+        dynamic = struct.pack(e + "iIiI", 1, len(EXPORT) + 2, 0, 0)
+
+    ehsize = 64 if is64 else 52
+    shentsize = 64 if is64 else 40
+    text = b"\x90" * 16
+    blobs = [text, metadata, dynsym, dynstr, dynamic, shstrtab]
+    offsets = []
+    offset = ehsize
+    for blob in blobs:
+        offset = align(offset, 8)
+        offsets.append(offset)
+        offset += len(blob)
+    shoff = align(offset, 8)
+
+    ident = b"\x7fELF" + bytes([2 if is64 else 1, 2 if big_endian else 1, 1]) + b"\0" * 9
+    machine = 62 if is64 else 20  # x86_64 / PowerPC
+    if is64:
+        ehdr = ident + struct.pack(e + "HHIQQQIHHHHHH", 3, machine, 1, 0, 0, shoff, 0,
+                                   ehsize, 56, 0, shentsize, len(names), 6)
+    else:
+        ehdr = ident + struct.pack(e + "HHIIIIIHHHHHH", 3, machine, 1, 0, 0, shoff, 0,
+                                   ehsize, 32, 0, shentsize, len(names), 6)
+
+    def shdr(name, type_, flags, offset, size, link=0):
+        if is64:
+            return struct.pack(e + "IIQQQQIIQQ", name, type_, flags, 0, offset, size, link, 0, 1,
+                               0)
+        return struct.pack(e + "IIIIIIIIII", name, type_, flags, 0, offset, size, link, 0, 1, 0)
+
+    # (type, flags, link) of .text, .loadso_metadata, .dynsym, .dynstr, .dynamic, .shstrtab
+    attrs = [(1, 6, 0), (1, 2, 0), (11, 2, 4), (3, 2, 0), (6, 3, 4), (3, 0, 0)]
+    shdrs = shdr(0, 0, 0, 0, 0)
+    for i, (type_, flags, link) in enumerate(attrs):
+        shdrs += shdr(name_offsets[i + 1], type_, flags, offsets[i], len(blobs[i]), link)
+
+    out = ehdr
+    for offset, blob in zip(offsets, blobs):
+        out += b"\0" * (offset - len(out)) + blob
+    return out + b"\0" * (shoff - len(out)) + shdrs
+
+
+def make_macho(is64, big_endian, cputype, metadata):
+    e = ">" if big_endian else "<"
+    header_size = 32 if is64 else 28
+    seg_size = 72 if is64 else 56
+    sect_size = 80 if is64 else 68
+    nsects = 2
+    seg_cmd_size = seg_size + nsects * sect_size
+    symtab_cmd_size = 24
+    dylib_name = DEPENDENCY.replace(b".so", b".dylib") + b"\0"
+    dylib_cmd_size = align(24 + len(dylib_name), 8)
+    cmd_size = seg_cmd_size + symtab_cmd_size + dylib_cmd_size
+    data_off = align(header_size + cmd_size, 16)
+    text = b"\x90" * 16
+    meta_off = data_off + len(text)
+    sym_off = align(meta_off + len(metadata), 8)
+    strtab = b"\0_" + EXPORT + b"\0"
+    if is64:
+        nlist = struct.pack(e + "IBBHQ", 1, 0x0F, 1, 0, 0)
+    else:
+        nlist = struct.pack(e + "IBBHI", 1, 0x0F, 1, 0, 0)
+    str_off = sym_off + len(nlist)
+
+    def name16(s):
+        return s.ljust(16, b"\0")
+
+    if is64:
+        header = struct.pack(e + "IiiIIIII", 0xFEEDFACF, cputype, 3, 6, 3, cmd_size, 0, 0)
+        seg = struct.pack(e + "II16sQQQQiiII", 0x19, seg_cmd_size, name16(b"__TEXT"), 0,
+                          0x1000, 0, meta_off + len(metadata), 5, 5, nsects, 0)
+
+        def sect(name, offset, size):
+            return struct.pack(e + "16s16sQQIIIIIIII", name16(name), name16(b"__TEXT"), 0,
+                               size, offset, 0, 0, 0, 0, 0, 0, 0)
+    else:
+        header = struct.pack(e + "IiiIIII", 0xFEEDFACE, cputype, 3, 6, 3, cmd_size, 0)
+        seg = struct.pack(e + "II16sIIIIiiII", 0x1, seg_cmd_size, name16(b"__TEXT"), 0, 0x1000,
+                          0, meta_off + len(metadata), 5, 5, nsects, 0)
+
+        def sect(name, offset, size):
+            return struct.pack(e + "16s16sIIIIIIIII", name16(name), name16(b"__TEXT"), 0, size,
+                               offset, 0, 0, 0, 0, 0, 0)
+
+    body = header + seg + sect(b"__text", data_off, len(text))
+    body += sect(b"loadso_metadata", meta_off, len(metadata))
+    body += struct.pack(e + "IIIIII", 0x2, symtab_cmd_size, sym_off, 1, str_off, len(strtab))
+    dylib = struct.pack(e + "IIIIII", 0xC, dylib_cmd_size, 24, 2, 0x10000, 0x10000) + dylib_name
+    body += dylib + b"\0" * (dylib_cmd_size - len(dylib))
+    body += b"\0" * (data_off - len(body)) + text + metadata
+    return body + b"\0" * (sym_off - len(body)) + nlist + strtab
+
+
+def make_fat(slices):
+    # fat_header and fat_arch are always big endian
+    out = struct.pack(">II", 0xCAFEBABE, len(slices))
+    offset = align(8 + 20 * len(slices), 4096)
+    archs, datas = b"", b""
+    for cputype, data in slices:
+        archs += struct.pack(">iiIII", cputype, 0, offset, len(data), 12)
+        datas += data + b"\0" * (align(len(data), 4096) - len(data))
+        offset += align(len(data), 4096)
+    out += archs
+    return out + b"\0" * (align(len(out), 4096) - len(out)) + datas
+
+
+def make_pe(is64, metadata):
+    file_align = 0x200
+    rsrc_rva = 0x1000
+
+    # Resource tree: RT_RCDATA -> "LOADSO_METADATA" -> language 0x409 -> data entry
+    name = "LOADSO_METADATA".encode("utf-16-le")
+    dir_size = 16 + 8
+    type_dir = 0
+    name_dir = type_dir + dir_size
+    lang_dir = name_dir + dir_size
+    data_entry = lang_dir + dir_size
+    name_str = data_entry + 16
+    data_off = align(name_str + 2 + len(name), 8)
+
+    def directory(named, ids, entry_name, entry_offset):
+        return struct.pack("<IIHHHH", 0, 0, 4, 0, named, ids) + struct.pack(
+            "<II", entry_name, entry_offset)
+
+    rsrc = directory(0, 1, 10, 0x80000000 | name_dir)
+    rsrc += directory(1, 0, 0x80000000 | name_str, 0x80000000 | lang_dir)
+    rsrc += directory(0, 1, 0x409, data_entry)
+    rsrc += struct.pack("<IIII", rsrc_rva + data_off, len(metadata), 0, 0)
+    rsrc += struct.pack("<H", len(name) // 2) + name
+    rsrc += b"\0" * (data_off - len(rsrc)) + metadata
+    rsrc_raw = rsrc + b"\0" * (align(len(rsrc), file_align) - len(rsrc))
+
+    # Export directory with a single name, followed by the import descriptors
+    rdata_rva = 0x2000
+    dll_name = b"fixture.dll\0"
+    dep_name = DEPENDENCY.replace(b"lib", b"").replace(b".so", b".dll") + b"\0"
+    functions = 40
+    names = functions + 4
+    ordinals = names + 4
+    export_name = ordinals + 2
+    dll_name_off = export_name + len(EXPORT) + 1
+    imports = align(dll_name_off + len(dll_name), 4)
+    dep_name_off = imports + 40
+    rdata = struct.pack("<IIHHIIIIIII", 0, 0, 0, 0, rdata_rva + dll_name_off, 1, 1, 1,
+                        rdata_rva + functions, rdata_rva + names, rdata_rva + ordinals)
+    rdata += struct.pack("<IIH", 0x1000, rdata_rva + export_name, 0)
+    rdata += EXPORT + b"\0" + dll_name
+    rdata += b"\0" * (imports - len(rdata))
+    rdata += struct.pack("<IIIII", 0, 0, 0, rdata_rva + dep_name_off, 0) + b"\0" * 20
+    rdata += dep_name
+    rdata_raw = rdata + b"\0" * (align(len(rdata), file_align) - len(rdata))
+
+    dos = b"MZ" + b"\0" * 0x3A + struct.pack("<I", 0x40)
+    num_dirs = 16
+    dirs = [(0, 0)] * num_dirs
+    dirs[0] = (rdata_rva, imports)
+    dirs[1] = (rdata_rva + imports, 40)
+    dirs[2] = (rsrc_rva, len(rsrc))
+    dir_bytes = b"".join(struct.pack("<II", *d) for d in dirs)
+
+    if is64:
+        opt = struct.pack("<HBBIIIIIQIIHHHHHHIIIIHHQQQQII", 0x20B, 14, 0, 0, 0, 0, 0, 0,
+                          0x180000000, 0x1000, file_align, 6, 0, 0, 0, 6, 0, 0, 0x3000, 0x400,
+                          0, 3, 0x160, 0x100000, 0x1000, 0x100000, 0x1000, 0, num_dirs)
+        machine = 0x8664
+    else:
+        opt = struct.pack("<HBBIIIIIIIIIHHHHHHIIIIHHIIIIII", 0x10B, 14, 0, 0, 0, 0, 0, 0, 0,
+                          0x10000000, 0x1000, file_align, 6, 0, 0, 0, 6, 0, 0, 0x3000, 0x400,
+                          0, 3, 0x140, 0x100000, 0x1000, 0x100000, 0x1000, 0, num_dirs)
+        machine = 0x14C
+    opt += dir_bytes
+
+    coff = b"PE\0\0" + struct.pack("<HHIIIHH", machine, 2, 0, 0, 0, len(opt), 0x2022)
+    headers_size = align(len(dos) + len(coff) + len(opt) + 80, file_align)
+    sections = struct.pack("<8sIIIIIIHHI", b".rsrc", len(rsrc), rsrc_rva, len(rsrc_raw),
+                           headers_size, 0, 0, 0, 0, 0x40000040)
+    sections += struct.pack("<8sIIIIIIHHI", b".rdata", len(rdata), rdata_rva, len(rdata_raw),
+                            headers_size + len(rsrc_raw), 0, 0, 0, 0, 0x40000040)
+    headers = dos + coff + opt + sections
+    return headers + b"\0" * (headers_size - len(headers)) + rsrc_raw + rdata_raw
+
+
+def main():
+    out_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(os.path.abspath(__file__))
+    fixtures = {
+        "elf64le.elf": make_elf(True, False, METADATA),
+        "elf32be.elf": make_elf(False, True, METADATA),
+        "macho64.dylib": make_macho(True, False, 0x01000007, METADATA),
+        "macho32be.dylib": make_macho(False, True, 18, METADATA),
+        "fat.dylib": make_fat([(0x01000007, make_macho(True, False, 0x01000007, METADATA)),
+                               (0x0100000C, make_macho(True, False, 0x0100000C, METADATA))]),
+        "pe64.dll": make_pe(True, METADATA),
+        "pe32.dll": make_pe(False, METADATA),
+    }
+    for name, data in fixtures.items():
+        with open(os.path.join(out_dir, name), "wb") as f:
+            f.write(data)
+
+
+if __name__ == "__main__":
+    main()
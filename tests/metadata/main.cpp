@@ -0,0 +1,173 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <loadso/filedigest.h>
+#include <loadso/loadcostanalyzer.h>
+#include <loadso/metadatareader.h>
+#include <loadso/pluginindex.h>
+#include <loadso/system.h>
+
+using namespace LoadSO;
+
+static const char *const g_Fixtures[] = {
+    "elf64le.elf", "elf32be.elf", "macho64.dylib", "macho32be.dylib",
+    "fat.dylib",  "pe64.dll",   "pe32.dll",
+};
+
+static const MetadataReader::Format g_Formats[] = {
+    MetadataReader::ElfFormat,   MetadataReader::ElfFormat, MetadataReader::MachOFormat,
+    MetadataReader::MachOFormat, MetadataReader::MachOFormat, MetadataReader::PeFormat,
+    MetadataReader::PeFormat,
+};
+
+int main(int argc, char *argv[]) {
+    int failed = 0;
+
+    printf("[Test Fixtures]\n");
+    for (size_t i = 0; i < sizeof(g_Fixtures) / sizeof(g_Fixtures[0]); ++i) {
+        std::string path = std::string(FIXTURE_DIR) + "/" + g_Fixtures[i];
+
+        // Read from memory
+        std::ifstream file(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string fromBuffer;
+        bool ok = MetadataReader::DetectFormat(data.data(), data.size()) == g_Formats[i] &&
+                  MetadataReader::Read(data.data(), data.size(), &fromBuffer) &&
+                  fromBuffer == "fixture metadata";
+
+        // Read from file
+        std::string fromFile;
+        ok = ok && MetadataReader::ReadFile(System::MultiToPathString(path), &fromFile) &&
+             fromFile == fromBuffer;
+
+        // Read symbols and dependencies
+        MetadataReader::FileInfo info;
+        ok = ok && MetadataReader::ReadInfo(data.data(), data.size(), &info) &&
+             info.metadata == fromBuffer && info.exports.size() == 1 &&
+             info.exports[0] == "fixture_export" && info.dependencies.size() == 1;
+
+        // Input truncated inside the headers must fail cleanly
+        std::string truncated;
+        ok = ok && !MetadataReader::Read(data.data(), 64, &truncated);
+
+        printf("%-16s: %s\n", g_Fixtures[i], ok ? "OK" : "FAILED");
+        failed += !ok;
+    }
+
+    printf("[Test Native Plugin]\n");
+    std::string metadata;
+    bool ok = MetadataReader::ReadFile(LOADSO_STR(PLUGIN1_NAME), &metadata) &&
+              metadata == "plugin1.txt";
+    printf("plugin1         : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    printf("[Test Batched Read]\n");
+    std::vector<PathString> paths;
+    for (auto fixture : g_Fixtures) {
+        paths.push_back(System::MultiToPathString(std::string(FIXTURE_DIR) + "/" + fixture));
+    }
+    paths.push_back(LOADSO_STR(PLUGIN1_NAME));
+    paths.push_back(LOADSO_STR("missing.so"));
+
+    const MetadataReader::IoBackend backends[] = {MetadataReader::AutoBackend,
+                                                  MetadataReader::PreadBackend};
+    for (auto backend : backends) {
+        std::vector<MetadataReader::FileInfo> infos;
+        std::vector<bool> succeeded;
+        ok = MetadataReader::ReadFilesInfo(paths, &infos, &succeeded, MetadataReader::DefaultName,
+                                           backend) == paths.size() - 1 &&
+             !succeeded.back();
+        for (size_t i = 0; ok && i + 1 < paths.size(); ++i) {
+            MetadataReader::FileInfo expected;
+            MetadataReader::ReadFileInfo(paths[i], &expected);
+            ok = succeeded[i] && infos[i].format == expected.format &&
+                 infos[i].metadata == expected.metadata &&
+                 infos[i].exports == expected.exports &&
+                 infos[i].dependencies == expected.dependencies;
+        }
+        printf("%-16s: %s\n",
+               backend == MetadataReader::AutoBackend
+                   ? (MetadataReader::DefaultIoBackend() == MetadataReader::IoUringBackend
+                          ? "io_uring"
+                          : "auto (pread)")
+                   : "pread",
+               ok ? "OK" : "FAILED");
+        failed += !ok;
+    }
+
+    printf("[Test File Digest]\n");
+    std::string bytes;
+    for (int i = 0; i < 1280; ++i) {
+        bytes.push_back(char(i & 0xFF));
+    }
+    ok = FileDigest::Hash("", 0) == "xxh64:ef46db3751d8e999" &&
+         FileDigest::Hash("abc", 3) == "xxh64:44bc2cf5ad770999" &&
+         FileDigest::Hash(bytes.data(), bytes.size()) == "xxh64:afc184ad7938a354";
+    printf("vectors         : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    std::string digest1, digest2;
+    FileDigest::ClearCache();
+    ok = FileDigest::HashFile(LOADSO_STR(PLUGIN1_NAME), &digest1) &&
+         FileDigest::CacheSize() == 1 && FileDigest::HashFile(LOADSO_STR(PLUGIN1_NAME), &digest2) &&
+         FileDigest::CacheSize() == 1 && digest1 == digest2 &&
+         !FileDigest::HashFile(LOADSO_STR("missing.so"), &digest2);
+    printf("cached file     : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    printf("[Test Load Cost]\n");
+    LoadCostAnalyzer::Report report;
+    ok = LoadCostAnalyzer::AnalyzeFile(LOADSO_STR(PLUGIN1_NAME), &report) &&
+         report.relocations > 0 && report.relocations >= report.pltRelocations &&
+         report.globalScopeRelocations <= report.symbolicRelocations &&
+         report.constructors > 0 && report.exportedSymbols > 0 &&
+         report.score() >= report.score(false);
+    printf("plugin1         : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    printf("[Test Plugin Index]\n");
+    PluginIndex index;
+    PluginIndex::Entry entry;
+    entry.path = "plugin1";
+    entry.digest = digest1;
+    ok = MetadataReader::ReadFileInfo(LOADSO_STR(PLUGIN1_NAME), &entry.info);
+    index.addEntry(entry);
+
+    PluginIndex loaded;
+    auto data = index.toData();
+    ok = ok && loaded.fromData(data.data(), data.size()) && loaded.entries().size() == 1;
+    auto found = loaded.find("plugin1");
+    ok = ok && found && found->info.metadata == "plugin1.txt" &&
+         found->info.exports == entry.info.exports &&
+         found->info.dependencies == entry.info.dependencies && found->digest == digest1;
+    ok = ok && !loaded.fromData(data.data(), data.size() - 1);
+    printf("round trip      : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    printf("[Test Resources]\n");
+    std::vector<std::string> names;
+    std::string schema;
+    ok = MetadataReader::ReadFileResourceNames(LOADSO_STR(PLUGIN2_NAME), &names) &&
+         names == std::vector<std::string>{"manifest", "schema.json", "empty"} &&
+         MetadataReader::ReadFileResource(LOADSO_STR(PLUGIN2_NAME), "schema.json", &schema) &&
+         schema.compare(0, 2, "{\n") == 0 &&
+         !MetadataReader::ReadFileResource(LOADSO_STR(PLUGIN2_NAME), "missing", &schema) &&
+         !MetadataReader::ReadFileResourceNames(LOADSO_STR(PLUGIN1_NAME), &names);
+    printf("plugin2 file    : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    {
+        std::ifstream file(PLUGIN2_NAME, std::ios::binary);
+        std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string fromImage;
+        ok = MetadataReader::ReadResource(image.data(), image.size(), "schema.json", &fromImage) &&
+             fromImage == schema &&
+             MetadataReader::ReadResource(image.data(), image.size(), "empty", &fromImage) &&
+             fromImage.empty();
+    }
+    printf("plugin2 image   : %s\n", ok ? "OK" : "FAILED");
+    failed += !ok;
+
+    return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,250 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <loadso/pluginhost.h>
+
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+#include "interface.h"
+
+using namespace LoadSO;
+
+enum Method {
+    Key,
+    Add,
+    Sum,
+    Crash,
+    Hang,
+};
+
+// Lives in the helper process
+static int64_t g_Sum = 0;
+
+static int32_t handle(PluginLoader &plugin, PluginHost::Call &call) {
+    switch (call.method) {
+        case Key: {
+            auto key = static_cast<Interface *>(plugin.instance())->key();
+            call.replySize = size_t(snprintf(static_cast<char *>(call.reply), call.capacity,
+                                             "%s %d", key, int(getpid())));
+            return 0;
+        }
+        case Add: {
+            int64_t value;
+            memcpy(&value, call.data, sizeof(value));
+            g_Sum += value;
+            return 0;
+        }
+        case Sum:
+            memcpy(call.reply, &g_Sum, sizeof(g_Sum));
+            call.replySize = sizeof(g_Sum);
+            return 0;
+        case Crash:
+            abort();
+        case Hang:
+            std::this_thread::sleep_for(std::chrono::hours(1));
+            return 0;
+        default:
+            break;
+    }
+    return -1;
+}
+
+static bool sum(PluginHost &host, int64_t *res) {
+    std::string reply;
+    if (!host.call(Sum, nullptr, 0, &reply) || reply.size() != sizeof(*res)) {
+        return false;
+    }
+    memcpy(res, reply.data(), sizeof(*res));
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+#ifndef __linux__
+    printf("Plugin host is only supported on Linux\n");
+    return 0;
+#else
+    PluginHost host(LOADSO_STR(PLUGIN1_NAME));
+    host.setHandler(handle);
+    host.setRingSize(64 * 1024);
+
+    printf("[Test Start]\n");
+    if (!host.start()) {
+        printf("start failed: %s\n", host.lastError().data());
+        return -1;
+    }
+
+    printf("[Test Call]\n");
+    std::string reply;
+    int32_t status = -1;
+    if (!host.call(Key, nullptr, 0, &reply, &status) || status != 0) {
+        printf("call failed: %s\n", host.lastError().data());
+        return -1;
+    }
+    printf("%s\n", reply.data());
+    if (reply.compare(0, 7, "plugin1") != 0 || atoi(reply.data() + 8) != host.pid() ||
+        host.pid() == int(getpid())) {
+        printf("unexpected reply\n");
+        return -1;
+    }
+    if (!host.call(100, nullptr, 0, nullptr, &status) || status != -1) {
+        printf("unexpected status\n");
+        return -1;
+    }
+    if (host.call(Key, nullptr, host.maxMessageSize() + 1)) {
+        printf("oversized request accepted\n");
+        return -1;
+    }
+
+    printf("[Test Throughput]\n");
+    {
+        const int count = 20000;
+        int64_t expected = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < count; ++i) {
+            if (!host.post(Add, &i, sizeof(i))) {
+                printf("post failed: %s\n", host.lastError().data());
+                return -1;
+            }
+            expected += i;
+        }
+        int64_t res;
+        if (!sum(host, &res) || res != expected) {
+            printf("sum mismatch\n");
+            return -1;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        printf("%d posts: %.1f ns each\n", count,
+               double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                   count);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i) {
+            if (!host.call(Key, nullptr, 0, &reply)) {
+                printf("call failed: %s\n", host.lastError().data());
+                return -1;
+            }
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        printf("%d calls: %.1f ns each\n", count,
+               double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                   count);
+
+        // Requests built in the ring, the reply read from it
+        start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < count; ++i) {
+            void *buf = host.reserve(sizeof(i));
+            if (!buf) {
+                printf("reserve failed: %s\n", host.lastError().data());
+                return -1;
+            }
+            memcpy(buf, &i, sizeof(i));
+            if (!host.callReserved(Add, sizeof(i))) {
+                printf("call failed: %s\n", host.lastError().data());
+                return -1;
+            }
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        printf("%d in place calls: %.1f ns each\n", count,
+               double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                   count);
+
+        const void *view = nullptr;
+        size_t viewSize = 0;
+        if (!host.reserve(64)) {
+            return -1;
+        }
+        host.cancelReserved();
+        if (!host.reserve(0) || !host.callReserved(Sum, 0, &view, &viewSize) ||
+            viewSize != sizeof(res)) {
+            printf("in place call failed: %s\n", host.lastError().data());
+            return -1;
+        }
+        memcpy(&res, view, sizeof(res));
+        if (res != 2 * expected || !host.call(Key, nullptr, 0) || host.callReserved(Sum, 0)) {
+            printf("in place sum mismatch\n");
+            return -1;
+        }
+        if (!host.call(Add, &res, sizeof(res)) || !sum(host, &res) || res != 4 * expected) {
+            printf("sum mismatch after in place calls\n");
+            return -1;
+        }
+    }
+
+    printf("[Test Crash]\n");
+    int pid = host.pid();
+    if (host.call(Crash, nullptr, 0)) {
+        printf("crash not detected\n");
+        return -1;
+    }
+    printf("%s\n", host.lastError().data());
+    int64_t res = -1;
+    if (host.restarts() != 1 || !host.isRunning() || host.pid() == pid || !sum(host, &res) ||
+        res != 0) {
+        printf("restart failed: %s\n", host.lastError().data());
+        return -1;
+    }
+
+    printf("[Test Timeout]\n");
+    host.setCallTimeout(std::chrono::milliseconds(200));
+    if (host.call(Hang, nullptr, 0)) {
+        printf("hang not detected\n");
+        return -1;
+    }
+    printf("%s\n", host.lastError().data());
+    if (host.restarts() != 2 || !host.call(Key, nullptr, 0)) {
+        printf("restart failed: %s\n", host.lastError().data());
+        return -1;
+    }
+
+    printf("[Test Restart Limit]\n");
+    host.setMaxRestarts(2);
+    if (host.call(Crash, nullptr, 0)) {
+        printf("crash not detected\n");
+        return -1;
+    }
+    printf("%s\n", host.lastError().data());
+    if (host.isRunning() || host.call(Key, nullptr, 0)) {
+        printf("restart limit not applied\n");
+        return -1;
+    }
+
+    printf("[Test Load Failure]\n");
+    PluginHost missing("not_exist");
+    if (missing.start()) {
+        printf("missing plugin loaded\n");
+        return -1;
+    }
+    printf("%s\n", missing.lastError().data());
+
+    printf("[Test Starting Thread Exit]\n");
+    {
+        PluginHost other(LOADSO_STR(PLUGIN1_NAME));
+        other.setHandler(handle);
+        bool started = false;
+        std::thread([&]() { started = other.start(); }).join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (!started || !other.call(Key, nullptr, 0) || other.restarts() != 0) {
+            printf("helper died with the starting thread: %s\n", other.lastError().data());
+            return -1;
+        }
+    }
+
+    printf("[Test Stop]\n");
+    if (!host.start()) {
+        printf("start failed: %s\n", host.lastError().data());
+        return -1;
+    }
+    host.stop();
+    if (host.isRunning()) {
+        return -1;
+    }
+    printf("OK\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,131 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <loadso/pluginpool.h>
+
+#include "interface.h"
+
+using namespace LoadSO;
+
+int main(int argc, char *argv[]) {
+#ifndef __GLIBC__
+    printf("Linker namespaces are only supported with glibc\n");
+    return 0;
+#else
+    const size_t count = 3;
+    PluginPool pool(LOADSO_STR(PLUGIN1_NAME));
+
+    printf("[Test Load]\n");
+    if (!pool.load(count)) {
+        printf("load failed: %s\n", pool.lastError().data());
+        return -1;
+    }
+    std::set<void *> instances;
+    for (size_t i = 0; i < count; ++i) {
+        instances.insert(pool.at(i).instance());
+    }
+    if (pool.size() != count || instances.size() != count || instances.count(nullptr)) {
+        printf("copies are not independent\n");
+        return -1;
+    }
+    printf("OK\n");
+
+    printf("[Test Acquire]\n");
+    {
+        std::vector<PluginPool::Lease> leases;
+        for (size_t i = 0; i < count; ++i) {
+            leases.push_back(pool.tryAcquire());
+            if (!leases.back().isValid()) {
+                printf("copy %d not available\n", int(i));
+                return -1;
+            }
+        }
+        if (pool.tryAcquire().isValid() || pool.available() != 0 || pool.unload()) {
+            printf("leased copy handed out or unloaded\n");
+            return -1;
+        }
+
+        // The copy released last is handed out first
+        const int index = leases[1].index();
+        leases[1].release();
+        auto lease = pool.tryAcquire();
+        if (lease.index() != index) {
+            printf("unexpected copy\n");
+            return -1;
+        }
+        lease.release();
+    }
+    if (pool.available() != count) {
+        printf("leases not released\n");
+        return -1;
+    }
+    printf("OK\n");
+
+    printf("[Test Workers]\n");
+    {
+        std::atomic<int> inUse[count] = {};
+        std::atomic<bool> shared(false);
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 8; ++i) {
+            workers.emplace_back([&]() {
+                for (int j = 0; j < 200; ++j) {
+                    auto lease = pool.acquire();
+                    if (inUse[lease.index()].fetch_add(1) != 0) {
+                        shared = true;
+                    }
+                    std::ignore = static_cast<Interface *>(lease.instance())->key();
+                    inUse[lease.index()].fetch_sub(1);
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        if (shared) {
+            printf("copy used by two workers at once\n");
+            return -1;
+        }
+    }
+    printf("OK\n");
+
+    if (!pool.unload() || pool.isLoaded()) {
+        printf("unload failed: %s\n", pool.lastError().data());
+        return -1;
+    }
+
+    printf("[Test Destroy]\n");
+    {
+        std::unique_ptr<PluginPool> busy(new PluginPool(LOADSO_STR(PLUGIN1_NAME)));
+        if (!busy->load(1)) {
+            printf("load failed: %s\n", busy->lastError().data());
+            return -1;
+        }
+        auto lease = busy->acquire();
+        std::atomic<int> waiter(0);
+        std::atomic<bool> destroyed(false);
+        std::thread waiting([&]() { waiter = busy->acquire().isValid() ? 2 : 1; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::thread destroying([&]() {
+            busy.reset();
+            destroyed = true;
+        });
+
+        // The waiter fails at once, the destructor waits for the lease
+        waiting.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (waiter != 1 || destroyed) {
+            printf("waiter not failed or lease not waited for\n");
+            return -1;
+        }
+        lease.release();
+        destroying.join();
+    }
+    printf("OK\n");
+    return 0;
+#endif
+}
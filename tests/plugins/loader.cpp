@@ -1,6 +1,15 @@
+#include <fstream>
 #include <iostream>
+#include <iterator>
 
+#ifndef _WIN32
+#  include <dlfcn.h>
+#  include <unistd.h>
+#endif
+
+#include <loadso/filedigest.h>
 #include <loadso/pluginloader.h>
+#include <loadso/system.h>
 
 #include "interface.h"
 
@@ -21,17 +30,172 @@ int main(int argc, char *argv[]) {
     }
     printf("plugin2 metadata: %s\n", plugin2.metaData().data());
 
+    // Check interface
+    printf("plugin1 interface: %s\n", plugin1.interfaceId().data());
+    plugin1.setRequiredInterface("LoadSO.Interface/0000000000000000");
+    if (plugin1.load(LoadSO::Library::ResolveAllSymbolsHint) || plugin1.isLoaded() ||
+        plugin1.errorCode() != LoadSO::Library::IncompatibleError) {
+        printf("plugin1 incompatible interface accepted\n");
+        return -1;
+    }
+    printf("plugin1 rejected: %s\n", plugin1.lastError().data());
+
+    // Check integrity
+    plugin1.setRequiredInterface(PLUGIN_INTERFACE_ID);
+    plugin1.setAllowedDigests({"xxh64:0000000000000000"});
+    if (plugin1.load(LoadSO::Library::ResolveAllSymbolsHint) || plugin1.isLoaded() ||
+        plugin1.errorCode() != LoadSO::Library::IntegrityError) {
+        printf("plugin1 unknown digest accepted\n");
+        return -1;
+    }
+    printf("plugin1 rejected: %s\n", plugin1.lastError().data());
+
+    std::string digest;
+    LoadSO::FileDigest::HashFile(plugin1.path(), &digest);
+    plugin1.setAllowedDigests({digest});
+
+    plugin2.setRequiredInterface(PLUGIN_INTERFACE_ID);
+
+    // Resources from the file
+    const std::string manifest = "{\"name\": \"plugin2\", \"permissions\": [\"read\"]}\n";
+    std::string resource;
+    if (!plugin2.resource("manifest", &resource) || resource != manifest) {
+        printf("plugin2 file resource mismatch\n");
+        return -1;
+    }
+    if (plugin2.resourceNames() != std::vector<std::string>{"manifest", "schema.json", "empty"}) {
+        printf("plugin2 resource names mismatch\n");
+        return -1;
+    }
+    if (plugin2.resource("missing", &resource) || !plugin1.resourceNames().empty()) {
+        printf("missing resource found\n");
+        return -1;
+    }
+
+#ifndef _WIN32
+    // Relative paths are evaluated against the executable directory, whatever the working
+    // directory is
+    {
+        // Up to the root from the executable directory, then down to the plugin
+        std::string relative;
+        const std::string appDir = LoadSO::System::ApplicationDirectory();
+        for (char c : appDir) {
+            if (c == '/') {
+                relative += "../";
+            }
+        }
+        relative += PLUGIN2_NAME + 1;
+
+        char cwd[4096];
+        if (!getcwd(cwd, sizeof(cwd)) || chdir("/") != 0) {
+            printf("chdir failed\n");
+            return -1;
+        }
+        LoadSO::PluginLoader relativePlugin(relative);
+        relativePlugin.setRequiredInterface(PLUGIN_INTERFACE_ID);
+        const bool ok = relativePlugin.metaData() == metadata2 &&
+                        relativePlugin.isCleanupRequired() &&
+                        relativePlugin.load(LoadSO::PluginLoader::DeferConstructionHint);
+        if (chdir(cwd) != 0 || !ok) {
+            printf("relative plugin path failed: %s\n", relativePlugin.lastError().data());
+            return -1;
+        }
+    }
+#endif
+
     // Load
     if (!plugin1.load(LoadSO::Library::ResolveAllSymbolsHint)) {
         printf("plugin1 load failed\n");
         return -1;
     }
 
-    if (!plugin2.load(LoadSO::Library::ResolveAllSymbolsHint)) {
+    if (!plugin2.load(LoadSO::Library::ResolveAllSymbolsHint |
+                      LoadSO::PluginLoader::DeferConstructionHint |
+                      LoadSO::PluginLoader::WarmUpHint)) {
         printf("plugin2 load failed\n");
         return -1;
     }
 
+    // Construct deferred instances
+    if (plugin2.isConstructed()) {
+        printf("plugin2 constructed too early\n");
+        return -1;
+    }
+    if (LoadSO::PluginLoader::ConstructAll({&plugin1, &plugin2}) != 2) {
+        printf("construct failed\n");
+        return -1;
+    }
+    printf("plugin1 construction: %lld ns\n", (long long) plugin1.constructionTime().count());
+    printf("plugin2 construction: %lld ns\n", (long long) plugin2.constructionTime().count());
+
+    // Warm up, plugin2 was started by its construction and plugin1 runs until cancelled
+    if (!plugin2.waitForWarmUp() || plugin2.warmUpState() != LoadSO::PluginLoader::WarmedUp) {
+        printf("plugin2 warm-up failed\n");
+        return -1;
+    }
+    printf("plugin2 warm-up: %lld ns\n", (long long) plugin2.warmUpTime().count());
+    if (plugin1.warmUpState() != LoadSO::PluginLoader::NoWarmUp || !plugin1.warmUp() ||
+        plugin1.waitForWarmUp(std::chrono::milliseconds(10)) ||
+        plugin1.warmUpState() != LoadSO::PluginLoader::WarmingUp) {
+        printf("plugin1 warm-up mismatch\n");
+        return -1;
+    }
+    plugin1.cancelWarmUp();
+    if (plugin1.warmUpState() != LoadSO::PluginLoader::WarmUpCancelled) {
+        printf("plugin1 warm-up not cancelled\n");
+        return -1;
+    }
+    printf("plugin1 warm-up cancelled after %lld ns\n", (long long) plugin1.warmUpTime().count());
+
+    // Resources from the mapped image
+    const char *view;
+    size_t viewSize;
+    for (const auto &name : plugin2.resourceNames()) {
+        if (!plugin2.resourceView(name.data(), &view, &viewSize) ||
+            reinterpret_cast<uintptr_t>(view) % 16 != 0 ||
+            !plugin2.resource(name.data(), &resource) || resource != std::string(view, viewSize)) {
+            printf("plugin2 resource view %s mismatch\n", name.data());
+            return -1;
+        }
+        printf("plugin2 resource %s: %zu bytes\n", name.data(), viewSize);
+    }
+    if (!plugin2.resourceView("manifest", &view, &viewSize) ||
+        std::string(view, viewSize) != manifest || !plugin2.resourceView("empty", &view, &viewSize) ||
+        viewSize != 0) {
+        printf("plugin2 resource view mismatch\n");
+        return -1;
+    }
+
+    // Metadata from the mapped image
+    if (!plugin1.metaDataView(&view, &viewSize) || std::string(view, viewSize) != metadata1) {
+        printf("plugin1 metadata view mismatch\n");
+        return -1;
+    }
+
+#ifndef _WIN32
+    // Metadata of a loaded plugin whose file was replaced
+    {
+        const std::string copyPath = std::string(PLUGIN2_NAME) + ".deployed";
+        const std::string nextPath = std::string(PLUGIN2_NAME) + ".next";
+        std::ifstream src(PLUGIN2_NAME, std::ios::binary);
+        std::ofstream(copyPath, std::ios::binary) << src.rdbuf();
+        std::ofstream(nextPath, std::ios::binary) << "not a plugin";
+
+        LoadSO::PluginLoader deployed(copyPath);
+        if (!deployed.load(LoadSO::PluginLoader::DeferConstructionHint)) {
+            printf("deployed plugin load failed\n");
+            return -1;
+        }
+        std::rename(nextPath.data(), copyPath.data());
+        if (deployed.metaData() != metadata2) {
+            printf("replaced plugin metadata mismatch\n");
+            return -1;
+        }
+        deployed.unload();
+        std::remove(copyPath.data());
+    }
+#endif
+
     // Get Instance
     auto instance1 = static_cast<LoadSO::Interface *>(plugin1.instance());
     if (!instance1) {
@@ -48,5 +212,84 @@ int main(int argc, char *argv[]) {
     printf("plugin1 key: %s\n", instance1->key());
     printf("plugin2 key: %s\n", instance2->key());
 
+#ifdef __linux__
+    // Load from memory
+    {
+        std::ifstream file(PLUGIN1_NAME, std::ios::binary);
+        std::string image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LoadSO::PluginLoader memory;
+        memory.setRequiredInterface(PLUGIN_INTERFACE_ID);
+        memory.setAllowedDigests({LoadSO::FileDigest::Hash(image.data(), image.size())});
+        if (!memory.loadFromMemory(image.data(), image.size(), 0, "plugin1")) {
+            printf("load from memory failed: %s\n", memory.lastError().data());
+            return -1;
+        }
+        auto instance = static_cast<LoadSO::Interface *>(memory.instance());
+        if (memory.metaData() != "plugin1.txt" || !instance ||
+            memory.path().compare(0, 14, "/proc/self/fd/") != 0) {
+            printf("plugin from memory mismatch\n");
+            return -1;
+        }
+        printf("memory plugin key: %s, path: %s\n", instance->key(), memory.path().data());
+
+        // The descriptor is gone with the library, nothing may be read through its number
+        if (!memory.unload() || !memory.path().empty() || !memory.metaData().empty() ||
+            memory.load(0)) {
+            printf("unloaded memory plugin kept its path\n");
+            return -1;
+        }
+    }
+#endif
+
+    // Fast exit, only plugin2 requires cleanup
+    if (plugin1.isCleanupRequired() || !plugin2.isCleanupRequired()) {
+        printf("cleanup flags mismatch\n");
+        return -1;
+    }
+    plugin1.unload();
+    plugin2.unload();
+
+    LoadSO::Library::SetFastExit(true);
+    {
+        LoadSO::PluginLoader fast1(LOADSO_STR(PLUGIN1_NAME));
+        LoadSO::PluginLoader fast2(LOADSO_STR(PLUGIN2_NAME));
+        if (!fast1.load(0) || !fast2.load(0)) {
+            printf("fast exit load failed\n");
+            return -1;
+        }
+    }
+#ifndef _WIN32
+    void *left1 = dlopen(PLUGIN1_NAME, RTLD_LAZY | RTLD_NOLOAD);
+    void *left2 = dlopen(PLUGIN2_NAME, RTLD_LAZY | RTLD_NOLOAD);
+    if (!left1 || left2) {
+        printf("fast exit unloaded the wrong plugins\n");
+        return -1;
+    }
+    printf("fast exit: plugin1 left loaded, plugin2 unloaded\n");
+
+    // The cleanup flag comes from the image, a replaced file is not read at exit
+    {
+        const std::string copyPath = std::string(PLUGIN2_NAME) + ".exiting";
+        const std::string nextPath = std::string(PLUGIN2_NAME) + ".next";
+        std::ifstream src(PLUGIN2_NAME, std::ios::binary);
+        std::ofstream(copyPath, std::ios::binary) << src.rdbuf();
+        std::ofstream(nextPath, std::ios::binary) << "not a plugin";
+        {
+            LoadSO::PluginLoader exiting(copyPath);
+            if (!exiting.load(0)) {
+                printf("exiting plugin load failed\n");
+                return -1;
+            }
+            std::rename(nextPath.data(), copyPath.data());
+        }
+        void *left = dlopen(copyPath.data(), RTLD_LAZY | RTLD_NOLOAD);
+        std::remove(copyPath.data());
+        if (left) {
+            printf("replaced plugin left loaded in fast exit\n");
+            return -1;
+        }
+    }
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "plugin1.h"
 
+#include <thread>
+
 namespace LoadSO {
 
     Plugin::Plugin() {
@@ -10,4 +12,12 @@ namespace LoadSO {
         return "plugin1";
     }
 
+    // Keeps warming until cancelled
+    bool Plugin::warmUp(const std::atomic<bool> &cancelled) {
+        while (!cancelled) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef PLUGIN1_H
 #define PLUGIN1_H
 
+#include <atomic>
 #include <iostream>
 
 #include "interface.h"
@@ -12,6 +13,8 @@ namespace LoadSO {
         Plugin();
 
         const char *key() const override;
+
+        bool warmUp(const std::atomic<bool> &cancelled);
     };
 
 }
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <iostream>
 
 #include "interface.h"
@@ -9,6 +10,11 @@ namespace LoadSO {
         Plugin();
 
         const char *key() const override;
+
+        bool warmUp(const std::atomic<bool> &cancelled);
+
+    private:
+        unsigned squares[4096];
     };
 
     Plugin::Plugin() {
@@ -19,6 +25,14 @@ namespace LoadSO {
         return "plugin2";
     }
 
+    bool Plugin::warmUp(const std::atomic<bool> &cancelled) {
+        for (unsigned i = 0; i < 4096 && !cancelled; ++i) {
+            squares[i] = i * i;
+        }
+        std::cout << "plugin2 warms up" << std::endl;
+        return squares[4095] == 4095u * 4095u;
+    }
+
 }
 
 #include LOADSO_PLUGIN_SOURCE_FILE
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include <loadso/pluginregistry.h>
+
+using namespace LoadSO;
+
+struct Slot {
+    PluginLoader plugin;
+    std::atomic<bool> retired{true};
+};
+
+int main(int argc, char *argv[]) {
+    PluginRegistry registry;
+
+    PluginLoader stable[4];
+    const char *stableKeys[] = {"a", "b", "c", "d"};
+    for (int i = 0; i < 4; ++i) {
+        if (!registry.add(stableKeys[i], &stable[i])) {
+            printf("add failed\n");
+            return -1;
+        }
+    }
+    if (registry.add("a", &stable[1])) {
+        printf("duplicate key accepted\n");
+        return -1;
+    }
+
+    printf("[Test Start]\n");
+
+    // Readers must always find the stable plugins and never see a retired one
+    Slot slots[8];
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::atomic<long long> hits(0);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                PluginRegistry::ReadLock lock(registry);
+                for (int i = 0; i < 4; ++i) {
+                    if (lock.find(stableKeys[i]) != &stable[i]) {
+                        failures++;
+                    }
+                }
+                if (auto plugin = lock.find("churn")) {
+                    for (auto &slot : slots) {
+                        if (&slot.plugin == plugin && slot.retired) {
+                            failures++;
+                        }
+                    }
+                    hits++;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        auto &slot = slots[i % 8];
+        slot.retired = false;
+        registry.add("churn", &slot.plugin);
+
+        // Keep the key published until a reader has seen it, or for a while at most
+        const auto seen = hits.load();
+        for (int spin = 0; spin < 100000 && hits == seen; ++spin) {
+            std::this_thread::yield();
+        }
+
+        if (registry.remove("churn") != &slot.plugin) {
+            failures++;
+        }
+        slot.retired = true;
+    }
+    stop = true;
+    for (auto &thread : readers) {
+        thread.join();
+    }
+
+    if (registry.keys().size() != 4 || registry.remove("churn")) {
+        failures++;
+    }
+
+    printf("churn hits: %lld\n", hits.load());
+    if (hits == 0) {
+        printf("readers never saw the churn key\n");
+        failures++;
+    }
+    if (failures) {
+        printf("%d failures\n", failures.load());
+        return -1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <atomic>
+#include <cstdio>
+
+#include <loadso/startupscheduler.h>
+
+#include "interface.h"
+
+using namespace LoadSO;
+
+int main(int argc, char *argv[]) {
+    PluginLoader critical(LOADSO_STR(PLUGIN1_NAME));
+    PluginLoader normal(LOADSO_STR(PLUGIN2_NAME));
+    PluginLoader background(LOADSO_STR(PLUGIN2_NAME));
+    background.setPriority(PluginLoader::BackgroundPriority);
+
+    // Priorities embedded by loadso_export_plugin(PRIORITY)
+    if (critical.priority() != PluginLoader::CriticalPriority ||
+        normal.priority() != PluginLoader::NormalPriority) {
+        printf("embedded priority mismatch\n");
+        return -1;
+    }
+
+    StartupScheduler scheduler;
+    scheduler.setThreads(2);
+    scheduler.setBudget(PluginLoader::BackgroundPriority, std::chrono::nanoseconds(1));
+    std::atomic<int> reported(0);
+    scheduler.setOverBudgetHandler([&](const StartupScheduler::Result &result) {
+        if (result.plugin == &background) {
+            reported++;
+        }
+    });
+    scheduler.addPlugin(&background);
+    scheduler.addPlugin(&normal);
+    scheduler.addPlugin(&critical);
+
+    // Critical path
+    if (!scheduler.loadCritical() || !critical.isLoaded() || normal.isLoaded() ||
+        background.isLoaded()) {
+        printf("critical tier failed\n");
+        return -1;
+    }
+    printf("critical plugin key: %s\n", static_cast<Interface *>(critical.instance())->key());
+
+    // Background tiers
+    scheduler.ready();
+    if (scheduler.addPlugin(&critical)) {
+        printf("plugin added after ready\n");
+        return -1;
+    }
+    if (!scheduler.wait() || !scheduler.isFinished() || !normal.isLoaded() ||
+        !background.isLoaded()) {
+        printf("background tiers failed\n");
+        return -1;
+    }
+    printf("%s", scheduler.report().data());
+
+    const auto over = scheduler.overBudget();
+    if (over.size() != 1 || over[0].plugin != &background || reported != 1) {
+        printf("over budget plugins mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
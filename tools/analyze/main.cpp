@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <loadso/loadcostanalyzer.h>
+#include <loadso/metadatareader.h>
+
+using namespace LoadSO;
+
+namespace fs = std::filesystem;
+
+static void printUsage() {
+    printf("Usage: loadso-analyze [options] <file or dir>...\n"
+           "\n"
+           "Estimates the load time cost of ELF plugins from their relocations, initializers\n"
+           "and dynamic flags, and ranks the most expensive ones.\n"
+           "\n"
+           "Options:\n"
+           "  --lazy                 Assume lazy binding, PLT lookups are not paid at load\n"
+           "  --top <n>              Only print the n most expensive plugins\n"
+           "  --max-score <n>        Fail if a plugin scores above n\n"
+           "  --max-global <n>       Fail if a plugin has more global scope lookups than n\n"
+           "  --max-constructors <n> Fail if a plugin has more constructors than n\n"
+           "  -h, --help             Show this help\n"
+           "\n"
+           "Exit code is 2 if a limit is exceeded, 3 if an input can't be read.\n");
+}
+
+int main(int argc, char *argv[]) {
+    bool eager = true;
+    size_t top = SIZE_MAX;
+    uint64_t maxScore = UINT64_MAX, maxGlobal = UINT64_MAX, maxConstructors = UINT64_MAX;
+    std::vector<fs::path> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        auto value = [&]() -> uint64_t {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "loadso-analyze: missing value of %s\n", arg);
+                exit(1);
+            }
+            return strtoull(argv[++i], nullptr, 10);
+        };
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            printUsage();
+            return 0;
+        } else if (!strcmp(arg, "--lazy")) {
+            eager = false;
+        } else if (!strcmp(arg, "--top")) {
+            top = size_t(value());
+        } else if (!strcmp(arg, "--max-score")) {
+            maxScore = value();
+        } else if (!strcmp(arg, "--max-global")) {
+            maxGlobal = value();
+        } else if (!strcmp(arg, "--max-constructors")) {
+            maxConstructors = value();
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "loadso-analyze: unknown option %s\n", arg);
+            return 1;
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    // Collect ELF files, an unreadable input fails the run after the ranking is printed
+    bool inputError = false;
+    std::vector<fs::path> files;
+    for (const auto &input : inputs) {
+        std::error_code ec;
+        if (!fs::is_directory(input, ec)) {
+            files.push_back(input);
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(input, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (it->is_regular_file(ec)) {
+                files.push_back(it->path());
+            }
+        }
+        if (ec) {
+            fprintf(stderr, "loadso-analyze: %s: %s\n", input.u8string().data(),
+                    ec.message().data());
+            inputError = true;
+        }
+    }
+
+    std::vector<fs::path> paths;
+    std::vector<LoadCostAnalyzer::Report> reports;
+    for (const auto &file : files) {
+        LoadCostAnalyzer::Report report;
+        if (LoadCostAnalyzer::AnalyzeFile2(file, &report)) {
+            paths.push_back(file);
+            reports.push_back(report);
+        } else if (std::find(inputs.begin(), inputs.end(), file) != inputs.end()) {
+            std::error_code ec;
+            fprintf(stderr, "loadso-analyze: %s: %s\n", file.u8string().data(),
+                    fs::exists(file, ec) ? "not a readable ELF file" : "no such file");
+            inputError = true;
+        }
+    }
+
+    // Print ranking
+    int ret = 0;
+    printf("%12s %8s %8s %8s %6s %6s %8s %s\n", "score", "relocs", "global", "plt", "ctors",
+           "dtors", "exports", "path");
+    auto ranking = LoadCostAnalyzer::Rank(reports, eager);
+    for (size_t i = 0; i < ranking.size(); ++i) {
+        const auto &r = reports[ranking[i]];
+        const auto score = r.score(eager);
+        std::string flags;
+        bool limited = false;
+        if (score > maxScore || r.globalScopeRelocations > maxGlobal ||
+            r.constructors > maxConstructors) {
+            flags += " [LIMIT]";
+            limited = true;
+            ret = 2;
+        }
+        if (r.textRelocations) {
+            flags += " [TEXTREL]";
+        }
+        // Past the top rows, only the libraries over a limit are listed
+        if (i < top || limited) {
+            printf("%12llu %8llu %8llu %8llu %6llu %6llu %8llu %s%s\n",
+                   (unsigned long long) score, (unsigned long long) r.relocations,
+                   (unsigned long long) r.globalScopeRelocations,
+                   (unsigned long long) r.pltRelocations, (unsigned long long) r.constructors,
+                   (unsigned long long) r.destructors, (unsigned long long) r.exportedSymbols,
+                   paths[ranking[i]].u8string().data(), flags.data());
+        }
+    }
+    return inputError ? 3 : ret;
+}
@@ -0,0 +1,208 @@
+// rtld-audit module attributing dynamic linking cost to the loaded objects.
+//
+//     LD_AUDIT=/path/to/loadso-audit.so LOADSO_AUDIT_OUTPUT=audit.tsv ./app
+//
+// For every object the report lists the symbol bindings it caused, how many of them were
+// resolved outside the object itself, the bindings done through dlsym(), the time spent
+// locating and mapping it, and the object whose dlopen() (or the program startup) brought
+// it in. The startup relocation time, measured up to la_preinit, is reported for the
+// executable. The report is written when the process exits, to stderr by default.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <link.h>
+
+#define AUDIT_EXPORT extern "C" __attribute__((visibility("default")))
+
+namespace {
+
+    struct ObjectStats {
+        std::string name;
+        Lmid_t lmid = 0;
+        ObjectStats *root = nullptr;
+        bool closed = false;
+
+        std::atomic<uint64_t> bindings{0};         // Bindings from this object
+        std::atomic<uint64_t> externalBindings{0}; // ...resolved in another object
+        std::atomic<uint64_t> dlsymBindings{0};    // ...through dlsym()
+        std::atomic<uint64_t> boundTo{0};          // Bindings resolved in this object
+        uint64_t mapNs = 0;
+        uint64_t startupNs = 0;
+    };
+
+    struct AuditState {
+        std::mutex mutex;
+        std::vector<ObjectStats *> objects;
+        ObjectStats *activityRoot = nullptr;
+        uint64_t lastEvent = 0;
+        uint64_t startupStart = 0;
+        bool started = false;
+        bool preinitDone = false;
+
+        ~AuditState();
+    };
+
+    uint64_t now() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+    }
+
+    AuditState &state() {
+        static AuditState instance;
+        return instance;
+    }
+
+    void dump(AuditState &s) {
+        FILE *out = stderr;
+        auto path = getenv("LOADSO_AUDIT_OUTPUT");
+        if (path && *path) {
+            out = fopen(path, "w");
+            if (!out) {
+                return;
+            }
+        }
+
+        std::vector<ObjectStats *> objects = s.objects;
+        std::stable_sort(objects.begin(), objects.end(), [](ObjectStats *a, ObjectStats *b) {
+            return a->externalBindings > b->externalBindings;
+        });
+
+        fprintf(out, "# loadso-audit 1\n");
+        fprintf(out, "object\tlmid\tbindings\texternal_bindings\tdlsym_bindings\tbound_to\t"
+                     "map_ns\tstartup_ns\troot\n");
+        for (auto obj : objects) {
+            fprintf(out, "%s\t%ld\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%s\n", obj->name.data(),
+                    long(obj->lmid), (unsigned long long) obj->bindings.load(),
+                    (unsigned long long) obj->externalBindings.load(),
+                    (unsigned long long) obj->dlsymBindings.load(),
+                    (unsigned long long) obj->boundTo.load(), (unsigned long long) obj->mapNs,
+                    (unsigned long long) obj->startupNs,
+                    obj->root ? obj->root->name.data() : "");
+        }
+        if (out != stderr) {
+            fclose(out);
+        }
+    }
+
+    AuditState::~AuditState() {
+        dump(*this);
+    }
+
+    uintptr_t symbind(uintptr_t value, uintptr_t *refcook, uintptr_t *defcook,
+                      unsigned int *flags) {
+        auto ref = reinterpret_cast<ObjectStats *>(*refcook);
+        auto def = reinterpret_cast<ObjectStats *>(*defcook);
+        if (ref) {
+            ref->bindings.fetch_add(1, std::memory_order_relaxed);
+            if (ref != def) {
+                ref->externalBindings.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (*flags & LA_SYMB_DLSYM) {
+                ref->dlsymBindings.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (def) {
+            def->boundTo.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // No la_pltenter/la_pltexit, they would slow down every call
+        *flags |= LA_SYMB_NOPLTENTER | LA_SYMB_NOPLTEXIT;
+        return value;
+    }
+
+}
+
+AUDIT_EXPORT unsigned int la_version(unsigned int version) {
+    return version < LAV_CURRENT ? version : LAV_CURRENT;
+}
+
+AUDIT_EXPORT void la_activity(uintptr_t *cookie, unsigned int flag) {
+    (void) cookie;
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto t = now();
+    if (!s.started) {
+        s.started = true;
+        s.startupStart = t;
+    }
+    // Everything mapped before la_preinit belongs to the program startup
+    if (flag == LA_ACT_ADD && s.preinitDone) {
+        s.activityRoot = nullptr;
+        s.lastEvent = t;
+    }
+}
+
+AUDIT_EXPORT unsigned int la_objopen(struct link_map *map, Lmid_t lmid, uintptr_t *cookie) {
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto t = now();
+    if (!s.started) {
+        s.started = true;
+        s.startupStart = t;
+        s.lastEvent = t;
+    }
+
+    auto obj = new ObjectStats();
+    obj->name = (map->l_name && *map->l_name) ? map->l_name : "[main]";
+    obj->lmid = lmid;
+    obj->mapNs = t - s.lastEvent;
+    s.lastEvent = t;
+
+    // The first object of an activity is the one being loaded, the rest are its dependencies
+    if (!s.activityRoot) {
+        s.activityRoot = obj;
+    }
+    obj->root = s.activityRoot;
+    s.objects.push_back(obj);
+
+    *cookie = reinterpret_cast<uintptr_t>(obj);
+    return LA_FLG_BINDTO | LA_FLG_BINDFROM;
+}
+
+AUDIT_EXPORT unsigned int la_objclose(uintptr_t *cookie) {
+    auto obj = reinterpret_cast<ObjectStats *>(*cookie);
+    if (obj) {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        obj->closed = true;
+    }
+    return 0;
+}
+
+AUDIT_EXPORT void la_preinit(uintptr_t *cookie) {
+    auto &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    // Startup mapping and relocation are done, initializers are about to run
+    auto obj = reinterpret_cast<ObjectStats *>(*cookie);
+    if (obj) {
+        obj->startupNs = now() - s.startupStart;
+    }
+    s.preinitDone = true;
+}
+
+#if __ELF_NATIVE_CLASS == 64
+AUDIT_EXPORT uintptr_t la_symbind64(Elf64_Sym *sym, unsigned int ndx, uintptr_t *refcook,
+                                    uintptr_t *defcook, unsigned int *flags,
+                                    const char *symname) {
+    (void) ndx;
+    (void) symname;
+    return symbind(sym->st_value, refcook, defcook, flags);
+}
+#else
+AUDIT_EXPORT uintptr_t la_symbind32(Elf32_Sym *sym, unsigned int ndx, uintptr_t *refcook,
+                                    uintptr_t *defcook, unsigned int *flags,
+                                    const char *symname) {
+    (void) ndx;
+    (void) symname;
+    return symbind(sym->st_value, refcook, defcook, flags);
+}
+#endif
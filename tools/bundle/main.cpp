@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include <loadso/pluginbundle.h>
+
+using namespace LoadSO;
+
+namespace fs = std::filesystem;
+
+static void printUsage() {
+    printf("Usage: loadso-bundle [options] <file|dir>...\n"
+           "       loadso-bundle --list <bundle>\n"
+           "       loadso-bundle --extract <bundle> [-d <dir>] [<member>...]\n"
+           "\n"
+           "Packs plugins into a single bundle file with a prebuilt index, or lists and\n"
+           "extracts the members of a bundle.\n"
+           "\n"
+           "Options:\n"
+           "  -o <file>     Bundle file, default: loadso-bundle.bin\n"
+           "  -n <name>     Metadata resource name, default: %s\n"
+           "  -d <dir>      Extraction directory, default: current directory\n"
+           "  -h, --help    Show this help\n"
+           "\n"
+           "Directories are packed recursively, members are named by their path relative to the\n"
+           "directory; files are named by their file name.\n",
+           MetadataReader::DefaultName);
+}
+
+static int list(const std::string &path) {
+    PluginBundle bundle;
+    if (!bundle.open2(path)) {
+        fprintf(stderr, "loadso-bundle: failed to open %s\n", path.data());
+        return 1;
+    }
+    for (const auto &entry : bundle.index().entries()) {
+        const void *data;
+        size_t size = 0;
+        bundle.data(entry.path, &data, &size);
+        printf("%12zu  %s  %s\n", size, entry.digest.data(), entry.path.data());
+    }
+    return 0;
+}
+
+// Member names come from the bundle, they must stay inside the extraction directory
+static bool isSafeName(const fs::path &name) {
+    if (name.empty() || name.has_root_name() || name.has_root_directory()) {
+        return false;
+    }
+    for (const auto &part : name) {
+        if (part == "..") {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int extract(const std::string &path, const fs::path &dir,
+                   std::vector<std::string> names) {
+    PluginBundle bundle;
+    if (!bundle.open2(path)) {
+        fprintf(stderr, "loadso-bundle: failed to open %s\n", path.data());
+        return 1;
+    }
+    if (names.empty()) {
+        for (const auto &entry : bundle.index().entries()) {
+            names.push_back(entry.path);
+        }
+    }
+    for (const auto &name : names) {
+        const auto relative = fs::u8path(name);
+        if (!isSafeName(relative)) {
+            fprintf(stderr, "loadso-bundle: refusing to extract %s outside of the directory\n",
+                    name.data());
+            return 1;
+        }
+        const auto target = dir / relative;
+        std::error_code ec;
+        fs::create_directories(target.parent_path(), ec);
+        if (!bundle.extract(name, target.native())) {
+            fprintf(stderr, "loadso-bundle: failed to extract %s\n", name.data());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    std::string bundlePath = "loadso-bundle.bin";
+    std::string name = MetadataReader::DefaultName;
+    std::string listPath;
+    std::string extractPath;
+    fs::path extractDir = ".";
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        auto value = [&]() -> const char * {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "loadso-bundle: missing value of %s\n", arg);
+                exit(1);
+            }
+            return argv[++i];
+        };
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            printUsage();
+            return 0;
+        } else if (!strcmp(arg, "-o")) {
+            bundlePath = value();
+        } else if (!strcmp(arg, "-n")) {
+            name = value();
+        } else if (!strcmp(arg, "-d")) {
+            extractDir = value();
+        } else if (!strcmp(arg, "--list")) {
+            listPath = value();
+        } else if (!strcmp(arg, "--extract")) {
+            extractPath = value();
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "loadso-bundle: unknown option %s\n", arg);
+            return 1;
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (!listPath.empty()) {
+        return list(listPath);
+    }
+    if (!extractPath.empty()) {
+        return extract(extractPath, extractDir, inputs);
+    }
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<PluginBundle::Member> members;
+    for (const auto &input : inputs) {
+        std::error_code ec;
+        if (!fs::is_directory(input, ec)) {
+            members.push_back({fs::path(input).filename().u8string(), fs::path(input).native()});
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(input, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (!it->is_regular_file(ec)) {
+                continue;
+            }
+            members.push_back(
+                {it->path().lexically_relative(input).generic_u8string(), it->path().native()});
+        }
+        if (ec) {
+            fprintf(stderr, "loadso-bundle: %s: %s\n", input.data(), ec.message().data());
+            return 1;
+        }
+    }
+    std::sort(members.begin(), members.end(),
+              [](const PluginBundle::Member &a, const PluginBundle::Member &b) {
+                  return a.name < b.name;
+              });
+
+    if (!PluginBundle::Pack(fs::path(bundlePath).native(), members, name.data())) {
+        fprintf(stderr, "loadso-bundle: failed to write %s\n", bundlePath.data());
+        return 1;
+    }
+    fprintf(stderr, "loadso-bundle: %zu members\n", members.size());
+    return 0;
+}
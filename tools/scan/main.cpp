@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include <loadso/filedigest.h>
+#include <loadso/pluginindex.h>
+
+using namespace LoadSO;
+
+namespace fs = std::filesystem;
+
+using Clock = std::chrono::steady_clock;
+
+static void printUsage() {
+    printf("Usage: loadso-scan [options] <dir>...\n"
+           "\n"
+           "Scans plugin directories and writes an index of their metadata, exported symbols\n"
+           "and dependencies.\n"
+           "\n"
+           "Options:\n"
+           "  -o <file>     Index file, default: loadso-index.bin\n"
+           "  -j <n>        Number of worker threads, default: hardware concurrency\n"
+           "  -n <name>     Metadata resource name, default: %s\n"
+           "  --json <file> Also dump the index as JSON, \"-\" for stdout\n"
+           "  --relative    Store paths relative to the scanned directory\n"
+           "  --digest      Record the FileDigest of each binary, to check when loading\n"
+           "  --io <mode>   File reads: auto, uring, pread (batched) or sync, default: auto\n"
+           "  -h, --help    Show this help\n",
+           MetadataReader::DefaultName);
+}
+
+static const char *formatName(MetadataReader::Format format) {
+    switch (format) {
+        case MetadataReader::ElfFormat:
+            return "elf";
+        case MetadataReader::MachOFormat:
+            return "macho";
+        case MetadataReader::PeFormat:
+            return "pe";
+        default:
+            break;
+    }
+    return "unknown";
+}
+
+static void writeJsonString(std::ostream &out, const std::string &s) {
+    out << '"';
+    for (unsigned char ch : s) {
+        switch (ch) {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\r':
+                out << "\\r";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if (ch < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                    out << buf;
+                } else {
+                    out << ch;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+static void writeJsonList(std::ostream &out, const std::vector<std::string> &list) {
+    out << '[';
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (i > 0)
+            out << ", ";
+        writeJsonString(out, list[i]);
+    }
+    out << ']';
+}
+
+static void writeJson(std::ostream &out, const PluginIndex &index) {
+    out << "{\n  \"plugins\": [";
+    const auto &entries = index.entries();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto &entry = entries[i];
+        out << (i > 0 ? ",\n" : "\n") << "    {\n      \"path\": ";
+        writeJsonString(out, entry.path);
+        out << ",\n      \"format\": \"" << formatName(entry.info.format) << "\"";
+        out << ",\n      \"metadata\": ";
+        writeJsonString(out, entry.info.metadata);
+        out << ",\n      \"exports\": ";
+        writeJsonList(out, entry.info.exports);
+        out << ",\n      \"dependencies\": ";
+        writeJsonList(out, entry.info.dependencies);
+        if (!entry.digest.empty()) {
+            out << ",\n      \"digest\": ";
+            writeJsonString(out, entry.digest);
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+static double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    std::string indexPath = "loadso-index.bin";
+    std::string jsonPath;
+    std::string name = MetadataReader::DefaultName;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    bool relative = false;
+    bool digest = false;
+    bool batched = true;
+    auto backend = MetadataReader::AutoBackend;
+    std::vector<std::string> dirs;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        auto value = [&]() -> const char * {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "loadso-scan: missing value of %s\n", arg);
+                exit(1);
+            }
+            return argv[++i];
+        };
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            printUsage();
+            return 0;
+        } else if (!strcmp(arg, "-o")) {
+            indexPath = value();
+        } else if (!strcmp(arg, "-j")) {
+            jobs = std::max(1, atoi(value()));
+        } else if (!strcmp(arg, "-n")) {
+            name = value();
+        } else if (!strcmp(arg, "--json")) {
+            jsonPath = value();
+        } else if (!strcmp(arg, "--relative")) {
+            relative = true;
+        } else if (!strcmp(arg, "--digest")) {
+            digest = true;
+        } else if (!strcmp(arg, "--io")) {
+            const char *mode = value();
+            if (!strcmp(mode, "auto")) {
+                backend = MetadataReader::AutoBackend;
+            } else if (!strcmp(mode, "uring")) {
+                backend = MetadataReader::IoUringBackend;
+            } else if (!strcmp(mode, "pread")) {
+                backend = MetadataReader::PreadBackend;
+            } else if (!strcmp(mode, "sync")) {
+                batched = false;
+            } else {
+                fprintf(stderr, "loadso-scan: unknown I/O mode %s\n", mode);
+                return 1;
+            }
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "loadso-scan: unknown option %s\n", arg);
+            return 1;
+        } else {
+            dirs.emplace_back(arg);
+        }
+    }
+    if (dirs.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    // Phase 1: discover regular files
+    auto start = Clock::now();
+    struct Task {
+        fs::path path;
+        std::string key;
+        PluginIndex::Entry entry;
+        bool ok = false;
+    };
+    std::vector<Task> tasks;
+    for (const auto &dir : dirs) {
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (!it->is_regular_file(ec)) {
+                continue;
+            }
+            Task task;
+            task.path = it->path();
+            task.key = (relative ? it->path().lexically_relative(dir) : it->path()).u8string();
+            tasks.push_back(std::move(task));
+        }
+        if (ec) {
+            fprintf(stderr, "loadso-scan: %s: %s\n", dir.data(), ec.message().data());
+            return 1;
+        }
+    }
+    std::sort(tasks.begin(), tasks.end(),
+              [](const Task &a, const Task &b) { return a.key < b.key; });
+    const double discoverMs = msSince(start);
+
+    // Phase 2: parse files in parallel, each worker batching the reads of its share
+    start = Clock::now();
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(jobs, tasks.size()));
+    std::atomic<size_t> next(0);
+    auto hash = [&](size_t begin, size_t end) {
+        for (size_t i = begin; digest && i < end; ++i) {
+            auto &task = tasks[i];
+            if (task.ok && !FileDigest::HashFile2(task.path, &task.entry.digest)) {
+                task.ok = false;
+            }
+        }
+    };
+    auto worker = [&](size_t id) {
+        if (!batched) {
+            for (size_t i = next++; i < tasks.size(); i = next++) {
+                auto &task = tasks[i];
+                task.ok =
+                    MetadataReader::ReadFileInfo(task.path, &task.entry.info, name.data());
+                hash(i, i + 1);
+            }
+            return;
+        }
+        const size_t begin = tasks.size() * id / workers;
+        const size_t end = tasks.size() * (id + 1) / workers;
+        std::vector<PathString> paths;
+        for (size_t i = begin; i < end; ++i) {
+            paths.push_back(tasks[i].path);
+        }
+        std::vector<MetadataReader::FileInfo> infos;
+        std::vector<bool> succeeded;
+        MetadataReader::ReadFilesInfo(paths, &infos, &succeeded, name.data(), backend);
+        for (size_t i = begin; i < end; ++i) {
+            tasks[i].ok = succeeded[i - begin];
+            tasks[i].entry.info = std::move(infos[i - begin]);
+        }
+        hash(begin, end);
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const double parseMs = msSince(start);
+
+    // Phase 3: write index
+    start = Clock::now();
+    PluginIndex index;
+    for (auto &task : tasks) {
+        if (!task.ok) {
+            continue;
+        }
+        task.entry.path = std::move(task.key);
+        index.addEntry(std::move(task.entry));
+    }
+    if (!index.save2(indexPath)) {
+        fprintf(stderr, "loadso-scan: failed to write %s\n", indexPath.data());
+        return 1;
+    }
+    const double indexMs = msSince(start);
+
+    // Phase 4: dump JSON
+    start = Clock::now();
+    if (jsonPath == "-") {
+        writeJson(std::cout, index);
+    } else if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        writeJson(file, index);
+        if (!file.good()) {
+            fprintf(stderr, "loadso-scan: failed to write %s\n", jsonPath.data());
+            return 1;
+        }
+    }
+    const double jsonMs = msSince(start);
+
+    const char *ioMode = "sync";
+    if (batched) {
+        ioMode = backend == MetadataReader::PreadBackend ||
+                         MetadataReader::DefaultIoBackend() != MetadataReader::IoUringBackend
+                     ? "pread"
+                     : "io_uring";
+    }
+    fprintf(stderr,
+            "loadso-scan: %zu files, %zu binaries, %u jobs, %s\n"
+            "  discover : %10.3f ms\n"
+            "  parse    : %10.3f ms\n"
+            "  index    : %10.3f ms\n"
+            "  json     : %10.3f ms\n",
+            tasks.size(), index.entries().size(), jobs, ioMode, discoverMs, parseMs, indexMs, jsonMs);
+    return 0;
+}